@@ -0,0 +1,213 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include "autotune.h"
+#include "measurement.h"
+using namespace std;
+
+
+#define MIN_TUNED_GRAIN 8 // smallest grain of the FastFlow engine tried by the calibration
+
+
+/*!
+ * @param engine [Engine] := engine of a tuned configuration
+ * @return name [string] := name of the engine, as the modes of main.out (seq, thr or ff)
+ */
+string tuned_engine_name(Engine engine){
+
+    switch(engine){
+        case Engine::THREADS:
+            return "thr";
+        case Engine::FASTFLOW:
+            return "ff";
+        default:
+            return "seq";
+    }
+}
+
+
+/*!
+ * @return key [string] := identifier of the machine in the tuning cache, without spaces
+ */
+static string machine_key(){
+
+    MachineInfo machine = machine_info();
+    string key = machine.hostname + "|" + machine.cpu + "|" + to_string(machine.cores);
+    replace(key.begin(), key.end(), ' ', '_');
+    return key;
+}
+
+
+/*!
+ * @param n [int] := dimension of the linear system
+ * @return bucket [int] := largest power of 2 not greater than n
+ */
+static int size_bucket(int n){
+
+    int bucket = 1;
+    while(bucket <= n / 2){
+        bucket *= 2;
+    }
+    return bucket;
+}
+
+
+/*!
+ * The following function looks up a configuration in the tuning cache, each line of the cache is
+ * "[machine] [bucket] [engine] [threads] [grain] [calibrated size] [usec per iteration]".
+ * @param cache_file [string] := file of the tuning cache
+ * @param key [string] := identifier of the machine
+ * @param bucket [int] := size bucket of the system
+ * @param max_threads [int] := largest number of threads that can be used, the configurations with more are ignored
+ * @param config [TunedConfig] := value passed by reference in which it will be stored the configuration found
+ * @return found [bool] := true if the configuration is in the cache
+ */
+static bool lookup(const string &cache_file, const string &key, int bucket, int max_threads, TunedConfig &config){
+
+    ifstream input_file(cache_file);
+    string line;
+    bool found = false;
+    while(getline(input_file, line)){ // the last calibration of the machine and of the bucket wins
+        istringstream fields(line);
+        string machine, engine;
+        int size;
+        TunedConfig entry;
+        if(line.empty() || line[0] == '#' || !(fields >> machine >> size >> engine >> entry.threads >> entry.grain >>
+                                               entry.size >> entry.iteration_time)){
+            continue;
+        }
+        if(machine != key || size != bucket || entry.threads > max_threads || entry.size < 1){
+            continue;
+        }
+        entry.engine = engine == "thr" ? Engine::THREADS : engine == "ff" ? Engine::FASTFLOW : Engine::SEQUENTIAL;
+        config = entry;
+        found = true;
+    }
+    return found;
+}
+
+
+/*!
+ * The following function measures the time of an iteration of a configuration: the best of CALIBRATION_TRIALS runs
+ * of CALIBRATION_ITERATIONS iterations, after a warm-up run that creates the threads and loads the caches.
+ * @param solver [JacobiSolver] := solver of the linear system
+ * @param config [TunedConfig] := configuration to measure, its iteration_time is filled
+ */
+static void calibrate(JacobiSolver &solver, TunedConfig &config){
+
+    FastFlowOptions options;
+    options.grain = config.grain;
+    solver.set_fast_flow(options);
+    long best = -1;
+    for(int run = 0; run <= CALIBRATION_TRIALS; run++){
+        long time;
+        solver.solve(config.engine, CALIBRATION_ITERATIONS, config.threads, -1, time);
+        if(run > 0 && (best < 0 || time < best)){
+            best = time;
+        }
+    }
+    config.iteration_time = (double) best / CALIBRATION_ITERATIONS;
+}
+
+
+/*!
+ * The following function chooses the engine, the number of threads and the grain that solve the system of the solver
+ * in the shortest time. All the engines compute the same iterations, so the predicted time to solution is the time of
+ * an iteration times the number of iterations, and the configuration with the fastest iteration is chosen. The
+ * configurations are looked up in the tuning cache, keyed by the machine and by the size bucket of the system (the
+ * largest power of 2 not greater than the size); if they are missing, they are calibrated with short runs of the
+ * solver and appended to the cache (the time of a cached iteration is scaled to the size of the system). The chosen
+ * grain is set in the solver.
+ * @param solver [JacobiSolver] := solver of the linear system, its Jacobi's Algorithm is calibrated
+ * @param max_threads [int] := largest number of threads that can be used
+ * @param cache_file [string] := file of the tuning cache, created if it does not exist
+ * @param cached [bool] := value passed by reference in which it will be stored true if the configuration was found in
+ * the cache
+ * @return config [TunedConfig] := configuration with the shortest predicted time to solution
+ */
+TunedConfig autotune(JacobiSolver &solver, int max_threads, const string &cache_file, bool &cached){
+
+    int n = solver.size();
+    string key = machine_key();
+    int bucket = size_bucket(n);
+    TunedConfig best;
+    cached = lookup(cache_file, key, bucket, max_threads, best);
+    if(cached){ // an iteration computes n^2 elements, so its time is scaled to the size of the system
+        best.iteration_time *= ((double) n / best.size) * ((double) n / best.size);
+        best.size = n;
+        FastFlowOptions options;
+        options.grain = best.grain;
+        solver.set_fast_flow(options);
+        return best;
+    }
+
+    // the powers of 2 up to max_threads and max_threads itself, a single thread is the sequential engine
+    vector<int> threads;
+    for(int t = 2; t < max_threads; t *= 2){
+        threads.push_back(t);
+    }
+    if(max_threads > 1){
+        threads.push_back(max_threads);
+    }
+    vector<TunedConfig> candidates(1); // the sequential engine first
+    candidates[0].size = n;
+    for(int t : threads){
+        for(Engine engine : {Engine::THREADS, Engine::FASTFLOW}){
+            TunedConfig candidate;
+            candidate.engine = engine;
+            candidate.threads = t;
+            candidate.size = n;
+            candidates.push_back(candidate);
+        }
+    }
+
+    // the timers of the runs are not printed, only the time of an iteration of each configuration
+    streambuf *console = cout.rdbuf();
+    ostringstream discarded;
+    auto measure = [&](TunedConfig &candidate){
+        cout.rdbuf(discarded.rdbuf());
+        calibrate(solver, candidate);
+        cout.rdbuf(console);
+        discarded.str("");
+        cout << "CALIBRATION " << tuned_engine_name(candidate.engine) << " " << candidate.threads << " threads" <<
+             (candidate.grain > 0 ? " grain " + to_string(candidate.grain) : "") << ": " << candidate.iteration_time
+             << " usec per iteration" << endl;
+        if(best.iteration_time <= 0 || candidate.iteration_time < best.iteration_time){
+            best = candidate;
+        }
+    };
+    for(TunedConfig &candidate : candidates){
+        measure(candidate);
+    }
+    // the grain is refined only for the best number of threads of FastFlow, so the calibration stays short
+    TunedConfig fast_flow;
+    for(const TunedConfig &candidate : candidates){
+        if(candidate.engine == Engine::FASTFLOW &&
+           (fast_flow.iteration_time <= 0 || candidate.iteration_time < fast_flow.iteration_time)){
+            fast_flow = candidate;
+        }
+    }
+    for(int blocks : {4, 16}){ // chunks of each thread, instead of the single static one
+        int grain = n / (fast_flow.threads * blocks);
+        if(fast_flow.engine == Engine::FASTFLOW && grain >= MIN_TUNED_GRAIN){
+            TunedConfig candidate = fast_flow;
+            candidate.grain = grain;
+            measure(candidate);
+        }
+    }
+
+    FastFlowOptions options;
+    options.grain = best.grain;
+    solver.set_fast_flow(options);
+    ofstream output_file(cache_file, ios::app);
+    if(output_file.is_open()){
+        output_file << key << " " << bucket << " " << tuned_engine_name(best.engine) << " " << best.threads << " " <<
+                    best.grain << " " << best.size << " " << best.iteration_time << endl;
+    }
+    else{
+        cerr << "Could not open the tuning cache '" << cache_file << "', the calibration is not saved" << endl;
+    }
+    return best;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include "jacobi_solver.h"
+using namespace std;
+
+
+#define CALIBRATION_ITERATIONS 3 // iterations of each calibration run
+#define CALIBRATION_TRIALS 2 // calibration runs measured for each configuration, after one warm-up run
+#define TUNING_CACHE "tuning.cache" // default file of the tuning cache, in the working directory
+
+
+/*!
+ * The following structure describes the configuration chosen by the autotuner for a size of the linear system.
+ */
+struct TunedConfig {
+    Engine engine = Engine::SEQUENTIAL; // SEQUENTIAL, THREADS or FASTFLOW
+    int threads = 1;
+    int grain = 0; // grain of the FastFlow engine, 0 for its static chunks
+    int size = 0; // dimension of the system of iteration_time
+    double iteration_time = 0; // usec of an iteration measured by the calibration
+};
+
+
+/*!
+ * @param engine [Engine] := engine of a tuned configuration
+ * @return name [string] := name of the engine, as the modes of main.out (seq, thr or ff)
+ */
+string tuned_engine_name(Engine engine);
+
+
+/*!
+ * The following function chooses the engine, the number of threads and the grain that solve the system of the solver
+ * in the shortest time. All the engines compute the same iterations, so the predicted time to solution is the time of
+ * an iteration times the number of iterations, and the configuration with the fastest iteration is chosen. The
+ * configurations are looked up in the tuning cache, keyed by the machine and by the size bucket of the system (the
+ * largest power of 2 not greater than the size); if they are missing, they are calibrated with short runs of the
+ * solver and appended to the cache (the time of a cached iteration is scaled to the size of the system). The chosen
+ * grain is set in the solver.
+ * @param solver [JacobiSolver] := solver of the linear system, its Jacobi's Algorithm is calibrated
+ * @param max_threads [int] := largest number of threads that can be used
+ * @param cache_file [string] := file of the tuning cache, created if it does not exist
+ * @param cached [bool] := value passed by reference in which it will be stored true if the configuration was found in
+ * the cache
+ * @return config [TunedConfig] := configuration with the shortest predicted time to solution
+ */
+TunedConfig autotune(JacobiSolver &solver, int max_threads, const string &cache_file, bool &cached);
@@ -3,21 +3,12 @@ tolerance=-1
 output_filename="results"
 max_num_threads=32
 
-for size in 1000 5000 15000; do
-
-  for mode in "seq" "thr" "ff"; do
-    if [ "$mode" = "seq" ]; then
-      ./main.out ${mode} ${size} ${iterations} ${tolerance} ${output_filename}
-    fi
-
-    if [ "$mode" = "thr" ] || [ "$mode" = "ff" ]; then
-      ./main.out ${mode} ${size} ${iterations} ${tolerance} ${output_filename} 1
-      for((i = 2; i <= max_num_threads; i+=2)); do
-        ./main.out ${mode} ${size} ${iterations} ${tolerance} ${output_filename} ${i}
-      done
-
-    fi
-
-  done
-
-done
\ No newline at end of file
+# all the sweeps run in a single process: each size is generated once and each configuration is warmed up before the
+# measured trials (see benchmark.cpp)
+threads="1"
+for((i = 2; i <= max_num_threads; i+=2)); do
+  threads="${threads},${i}"
+done
+
+./benchmark.out engines=seq,thr,ff sizes=1000,5000,15000 threads=${threads} tolerances=${tolerance} \
+                iterations=${iterations} warmup=1 trials=5 output=${output_filename}
@@ -0,0 +1,243 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include "utility.h"
+#include "jacobi_solver.h"
+#include "generator.h"
+#include "measurement.h"
+
+using namespace std;
+
+#define MIN_MATRIX 0
+#define MAX_MATRIX 20
+#define MIN_VECTOR 0
+#define MAX_VECTOR 20
+#define SEED 14
+
+
+/*!
+ * The following function parses a comma separated list of numbers given on the command line.
+ * @param text [string] := list of numbers (e.g. 1000,5000)
+ * @return numbers [vector<T>] := parsed numbers, integers if T is an integral type
+ * @throw invalid_argument if an element of the list is not a number of type T
+ */
+template <typename T>
+static vector<T> parse_list(const string &text){
+
+    vector<T> numbers;
+    size_t first = 0;
+    while(first <= text.size()){
+        size_t last = text.find(',', first);
+        if(last == string::npos){
+            last = text.size();
+        }
+        string element = text.substr(first, last - first);
+        size_t end = 0;
+        try{
+            if constexpr(is_integral_v<T>){
+                numbers.push_back(stoi(element, &end));
+            }
+            else{
+                numbers.push_back(stod(element, &end));
+            }
+        }
+        catch(const exception &){
+            end = string::npos;
+        }
+        if(end != element.size()){
+            throw invalid_argument("The list '" + text + "' is not valid: '" + element + "' is not " + (is_integral_v<T> ? "an integer" : "a number"));
+        }
+        first = last + 1;
+    }
+    return numbers;
+}
+
+
+/*!
+ * The following function parses a comma separated list of engines given on the command line.
+ * @param text [string] := list of engines among seq, thr and ff (e.g. seq,thr)
+ * @return engines [vector<string>] := parsed engines
+ * @throw invalid_argument if an element of the list is not an engine
+ */
+static vector<string> parse_engines(const string &text){
+
+    vector<string> engines;
+    size_t first = 0;
+    while(first <= text.size()){
+        size_t last = text.find(',', first);
+        if(last == string::npos){
+            last = text.size();
+        }
+        string engine = text.substr(first, last - first);
+        if(engine != "seq" && engine != "thr" && engine != "ff"){
+            throw invalid_argument("The engine '" + engine + "' is not valid: the engines are seq, thr and ff");
+        }
+        engines.push_back(engine);
+        first = last + 1;
+    }
+    return engines;
+}
+
+
+/*!
+ * The following program runs the sweeps of main.out and bash.sh in a single process: for each size the system is
+ * generated once, and each configuration (engine, number of threads, tolerance) is run warmup times without
+ * measuring it and then trials times. The statistics of the trials are written in [output].json and [output].csv
+ * with the description of the machine, and the median times are also written in the files read by spm_plots.ipynb
+ * ([output][size][engine].csv, one "threads\tmedian" line per number of threads, only "median" for seq).
+ *     ./benchmark.out [key=value ...]
+ * The keys are engines, sizes, threads, tolerances (comma separated lists), iterations, warmup, trials, output and
+ * counters (on by default: the mean hardware events of the trials are added to the results if the kernel allows them).
+ */
+int main(int argc, char *argv[]){
+
+    map<string, string> options = {{"engines", "seq,thr,ff"}, {"sizes", "1000,5000"}, {"tolerances", "-1"},
+                                   {"iterations", "100"}, {"warmup", "1"}, {"trials", "5"},
+                                   {"output", "benchmark"}, {"counters", "on"}};
+    string threads_list = "1";
+    for(int cores = 2; cores <= (int) thread::hardware_concurrency(); cores *= 2){
+        threads_list += "," + to_string(cores);
+    }
+    options["threads"] = threads_list;
+    for(int a = 1; a < argc; a++){
+        string argument = argv[a];
+        size_t separator = argument.find('=');
+        if(separator == string::npos || !options.count(argument.substr(0, separator))){
+            cerr << "The parameter '" << argument << "' is not valid. The parameters are: engines=[seq,thr,ff], "
+                    "sizes=[N,...], threads=[T,...], tolerances=[E,...], iterations=[K], warmup=[W], trials=[R], "
+                    "output=[PREFIX], counters=[on|off]" << endl;
+            exit(-1);
+        }
+        options[argument.substr(0, separator)] = argument.substr(separator + 1);
+    }
+
+    vector<string> engines;
+    vector<int> sizes, threads;
+    vector<double> tolerances;
+    try{
+        engines = parse_engines(options["engines"]);
+        sizes = parse_list<int>(options["sizes"]);
+        threads = parse_list<int>(options["threads"]);
+        tolerances = parse_list<double>(options["tolerances"]);
+    }
+    catch(const invalid_argument &e){
+        cerr << e.what() << endl;
+        exit(-2);
+    }
+    int iterations = atoi(options["iterations"].c_str());
+    int warmup = atoi(options["warmup"].c_str());
+    int trials = atoi(options["trials"].c_str());
+    string output = options["output"];
+    if(options["counters"] != "on" && options["counters"] != "off"){
+        cerr << "The counters must be on or off!" << endl;
+        exit(-3);
+    }
+    bool counting = options["counters"] == "on";
+    if(iterations < 1 || warmup < 0 || trials < 1){
+        cerr << "The iterations and the trials must be >= 1 and the warmup >= 0!" << endl;
+        exit(-3);
+    }
+    for(int size : sizes){
+        if(size < 1){
+            cerr << "The sizes must be >= 1!" << endl;
+            exit(-3);
+        }
+    }
+    for(int num_threads : threads){
+        if(num_threads < 1){
+            cerr << "The number of threads must be >= 1!" << endl;
+            exit(-3);
+        }
+    }
+
+    MachineInfo machine = machine_info();
+    cout << "\t \t ---JACOBI BENCHMARK--- \t \t" << endl;
+    cout << "MACHINE: " << machine.cpu << " (" << machine.cores << " cores) on " << machine.hostname << endl;
+    cout << "ROW KERNEL: " << machine.row_kernel << endl;
+    cout << "ITERATIONS: " << iterations << ", WARMUP: " << warmup << ", TRIALS: " << trials << endl;
+
+    MatrixGenerator generator;
+    generator.min_value = MIN_MATRIX;
+    generator.max_value = MAX_MATRIX;
+    generator.seed = SEED;
+    vector<Measurement> measurements;
+    for(int size : sizes){
+        JacobiSolver solver(Matrix(), generate_vector(size, MIN_VECTOR, MAX_VECTOR, SEED));
+        solver.generate_rows(generator, max(1, (int) thread::hardware_concurrency()));
+        solver.release_threads();
+        solver.set_counters(counting);
+
+        for(double tolerance : tolerances){
+            for(const string &engine_name : engines){
+                Engine engine = engine_name == "seq" ? Engine::SEQUENTIAL :
+                                engine_name == "thr" ? Engine::THREADS : Engine::FASTFLOW;
+                vector<int> engine_threads = engine == Engine::SEQUENTIAL ? vector<int>{1} : threads;
+                // the files read by spm_plots.ipynb are rewritten, so that they contain only the last sweep
+                ostringstream plot_filename;
+                plot_filename << output << size << engine_name;
+                if(tolerances.size() > 1){
+                    plot_filename << "_tol" << tolerance;
+                }
+                plot_filename << ".csv";
+                ofstream plot_file(plot_filename.str(), ios::trunc);
+                if(!plot_file.is_open()){
+                    cerr << "Could not open the file '" << plot_filename.str() << "'" << endl;
+                    exit(-8);
+                }
+                for(int num_threads : engine_threads){
+                    Measurement measurement;
+                    measurement.engine = engine_name;
+                    measurement.size = size;
+                    measurement.threads = num_threads;
+                    measurement.tolerance = tolerance;
+                    measurement.warmup = warmup;
+                    vector<long> times;
+                    vector<PerfSample> events;
+                    for(int run = 0; run < warmup + trials; run++){
+                        long time;
+                        solver.solve(engine, iterations, num_threads, tolerance, time);
+                        if(run >= warmup){
+                            times.push_back(time);
+                            if(counting){
+                                events.push_back(solver.counters());
+                            }
+                        }
+                    }
+                    measurement.iterations = solver.iterations();
+                    summarize(measurement, times, events);
+                    measurements.push_back(measurement);
+                    cout << engine_name << " size " << measurement.size << " threads " << measurement.threads <<
+                         " tolerance " << tolerance << ": median " << measurement.median << " usec, min " <<
+                         measurement.min << ", stddev " << measurement.stddev << ", " << measurement.iterations <<
+                         " iterations, " << measurement.gflops << " GFLOP/s, " << measurement.gbps << " GB/s" << endl;
+                    if(measurement.events.available()){
+                        cout << "\t" << measurement.events.describe() << endl;
+                    }
+                    if(engine != Engine::SEQUENTIAL){
+                        plot_file << measurement.threads << "\t" << measurement.median << endl;
+                    }
+                    else{
+                        plot_file << measurement.median << endl;
+                    }
+                }
+            }
+        }
+    }
+
+    try{
+        write_json(output + ".json", machine, measurements);
+        write_csv(output + ".csv", machine, measurements);
+    }
+    catch(const runtime_error &e){
+        cerr << e.what() << endl;
+        exit(-8);
+    }
+    cout << "RESULTS: " << output << ".json, " << output << ".csv" << endl;
+    return 0;
+}
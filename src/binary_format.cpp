@@ -0,0 +1,271 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "binary_format.h"
+using namespace std;
+
+
+#define CHECKSUM_PRIME 0x100000001b3ULL // prime of the 64 bit FNV hash, used to mix the words
+#define CHECKSUM_LANES 4 // independent lanes, so that the multiplications of consecutive words overlap
+
+
+/*!
+ * The following function computes the checksum of a payload, 8 bytes at a time (the payloads are multiples of 4 bytes,
+ * the last 4 bytes are padded with zeros).
+ * @param data [const void *] := first byte of the payload
+ * @param bytes [size_t] := length of the payload
+ * @return checksum [uint64_t] := checksum of the payload
+ */
+uint64_t binary_checksum(const void *data, size_t bytes){
+
+    const auto *bytes_data = static_cast<const unsigned char *>(data);
+    uint64_t lanes[CHECKSUM_LANES] = {0xcbf29ce484222325ULL, 0x84222325cbf29ce4ULL, 0x9e3779b97f4a7c15ULL,
+                                      0x7f4a7c159e3779b9ULL};
+    size_t words = bytes / sizeof(uint64_t);
+    size_t w = 0;
+    for(; w + CHECKSUM_LANES <= words; w += CHECKSUM_LANES){
+        for(int l = 0; l < CHECKSUM_LANES; l++){
+            uint64_t word;
+            memcpy(&word, bytes_data + (w + l) * sizeof(uint64_t), sizeof(word));
+            lanes[l] = (lanes[l] ^ word) * CHECKSUM_PRIME;
+        }
+    }
+    for(; w < words; w++){
+        uint64_t word;
+        memcpy(&word, bytes_data + w * sizeof(uint64_t), sizeof(word));
+        lanes[0] = (lanes[0] ^ word) * CHECKSUM_PRIME;
+    }
+    if(bytes % sizeof(uint64_t) != 0){
+        uint64_t word = 0;
+        memcpy(&word, bytes_data + words * sizeof(uint64_t), bytes % sizeof(uint64_t));
+        lanes[1] = (lanes[1] ^ word) * CHECKSUM_PRIME;
+    }
+    uint64_t checksum = bytes;
+    for(uint64_t lane : lanes){
+        checksum = (checksum ^ lane) * CHECKSUM_PRIME;
+        checksum ^= checksum >> 29;
+    }
+    return checksum;
+}
+
+
+/*!
+ * The following function writes the header, the padding up to the payload and the payload of a binary file.
+ * @param header [BinaryHeader] := header of the file, its checksum is computed here
+ * @param payload [const void *] := first byte of the payload
+ * @param filename [string] := file to write
+ * @throw runtime_error if the file cannot be written
+ */
+static void write_binary(BinaryHeader header, const void *payload, const string &filename){
+
+    header.checksum = binary_checksum(payload, header.payload_bytes);
+    ofstream output_file(filename, ios::binary | ios::trunc);
+    if(!output_file.is_open()){
+        throw runtime_error("Could not open the file '" + filename + "'");
+    }
+    vector<char> padding(header.payload_offset - sizeof(header), 0);
+    output_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    output_file.write(padding.data(), padding.size());
+    output_file.write(static_cast<const char *>(payload), header.payload_bytes);
+    if(!output_file){
+        throw runtime_error("Could not write the file '" + filename + "'");
+    }
+}
+
+
+/*!
+ * @param kind [BinaryKind] := content of the file
+ * @param layout [BinaryLayout] := order of the elements in the payload
+ * @param n [int] := dimension of the matrix or of the vector
+ * @param stride [int] := elements between the beginnings of two rows
+ * @param rows [int] := number of rows of the payload
+ * @return header [BinaryHeader] := header of the file without the checksum
+ */
+static BinaryHeader make_header(BinaryKind kind, BinaryLayout layout, int n, int stride, int rows){
+
+    BinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    header.version = BINARY_VERSION;
+    header.kind = kind;
+    header.type = BinaryType::FP32;
+    header.layout = layout;
+    header.n = n;
+    header.stride = stride;
+    header.payload_offset = BINARY_PAYLOAD_OFFSET;
+    header.payload_bytes = (uint64_t) rows * stride * sizeof(float);
+    return header;
+}
+
+
+/*!
+ * The following function checks that the header describes a file written by this code with the expected content.
+ * @param header [BinaryHeader] := header read from the file
+ * @param kind [BinaryKind] := expected content
+ * @param layout [BinaryLayout] := expected layout
+ * @param file_bytes [size_t] := length of the file
+ * @param filename [string] := name of the file, used in the messages
+ * @throw runtime_error if the header is not valid
+ */
+static void check_header(const BinaryHeader &header, BinaryKind kind, BinaryLayout layout, size_t file_bytes,
+                         const string &filename){
+
+    if(memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) != 0){
+        throw runtime_error("The file '" + filename + "' is not a binary matrix or vector");
+    }
+    if(header.version != BINARY_VERSION){
+        throw runtime_error("The file '" + filename + "' has version " + to_string(header.version) +
+                            ", but only version " + to_string(BINARY_VERSION) + " is supported");
+    }
+    if(header.kind != kind){
+        throw runtime_error("The file '" + filename + "' does not contain a " +
+                            (kind == BinaryKind::MATRIX ? "matrix" : "vector"));
+    }
+    if(header.type != BinaryType::FP32 || header.layout != layout){
+        throw runtime_error("The file '" + filename + "' has an unsupported type or layout");
+    }
+    int floats_per_line = CACHE_LINE / sizeof(float);
+    int64_t stride = kind == BinaryKind::MATRIX ? (header.n + floats_per_line - 1) / floats_per_line * floats_per_line
+                                                : header.n;
+    int64_t rows = kind == BinaryKind::MATRIX ? header.n : 1;
+    if(header.n < 1 || header.n > INT32_MAX || header.stride != stride ||
+       header.payload_bytes != (uint64_t) (rows * stride * sizeof(float)) ||
+       header.payload_offset % CACHE_LINE != 0 || header.payload_offset < sizeof(header) ||
+       header.payload_offset + header.payload_bytes > file_bytes){
+        throw runtime_error("The file '" + filename + "' is truncated or its header is corrupted");
+    }
+}
+
+
+/*!
+ * The following function writes a matrix in the binary format, with its rows padded as in memory so that it can be
+ * mapped without copying it.
+ * @param matrix [Matrix] := matrix to write
+ * @param filename [string] := file where the matrix is written
+ * @throw runtime_error if the file cannot be written
+ */
+void write_binary_matrix(const Matrix &matrix, const string &filename){
+
+    BinaryHeader header = make_header(BinaryKind::MATRIX, BinaryLayout::ROW_MAJOR_PADDED, matrix.size(),
+                                      matrix.row_stride(), matrix.size());
+    write_binary(header, matrix.data(), filename);
+}
+
+
+/*!
+ * The following function writes a vector in the binary format.
+ * @param vector [vector<float>] := vector to write
+ * @param filename [string] := file where the vector is written
+ * @throw runtime_error if the file cannot be written
+ */
+void write_binary_vector(const vector<float> &vector, const string &filename){
+
+    BinaryHeader header = make_header(BinaryKind::VECTOR, BinaryLayout::CONTIGUOUS, vector.size(), vector.size(), 1);
+    write_binary(header, vector.data(), filename);
+}
+
+
+/*!
+ * The following function reads and checks the header of a binary file, without reading its payload.
+ * @param filename [string] := file to read
+ * @param kind [BinaryKind] := expected content of the file
+ * @return header [BinaryHeader] := header of the file
+ * @throw runtime_error if the file cannot be opened or its header is not valid
+ */
+BinaryHeader read_binary_header(const string &filename, BinaryKind kind){
+
+    ifstream input_file(filename, ios::binary | ios::ate);
+    if(!input_file.is_open()){
+        throw runtime_error("Could not open the file '" + filename + "'");
+    }
+    size_t file_bytes = input_file.tellg();
+    BinaryHeader header;
+    input_file.seekg(0);
+    if(!input_file.read(reinterpret_cast<char *>(&header), sizeof(header))){
+        throw runtime_error("The file '" + filename + "' is truncated or its header is corrupted");
+    }
+    check_header(header, kind, kind == BinaryKind::MATRIX ? BinaryLayout::ROW_MAJOR_PADDED : BinaryLayout::CONTIGUOUS,
+                 file_bytes, filename);
+    return header;
+}
+
+
+/*!
+ * @param filename [string] := file to check
+ * @return binary [bool] := true if the file begins with BINARY_MAGIC, false if it does not or it cannot be read
+ */
+bool is_binary_file(const string &filename){
+
+    ifstream input_file(filename, ios::binary);
+    char magic[4];
+    return input_file.read(magic, sizeof(magic)) && memcmp(magic, BINARY_MAGIC, sizeof(magic)) == 0;
+}
+
+
+/*!
+ * The following function maps a matrix written by write_binary_matrix. The elements are not copied: the engines read
+ * the mapped pages, which are loaded by the kernel when they are touched the first time.
+ * @param filename [string] := file where the matrix is stored
+ * @param verify [bool] := true if the checksum of the payload must be verified (it reads all the pages once)
+ * @return matrix [Matrix] := matrix that reads its elements from the mapped file
+ * @throw runtime_error if the file cannot be opened or it is not a valid binary matrix
+ */
+Matrix map_binary_matrix(const string &filename, bool verify){
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0){
+        throw runtime_error("Could not open the file '" + filename + "'");
+    }
+    struct stat status;
+    BinaryHeader header;
+    if(fstat(fd, &status) != 0 || pread(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header)){
+        close(fd);
+        throw runtime_error("The file '" + filename + "' is truncated or its header is corrupted");
+    }
+    try{
+        check_header(header, BinaryKind::MATRIX, BinaryLayout::ROW_MAJOR_PADDED, status.st_size, filename);
+    }
+    catch(const runtime_error &){
+        close(fd);
+        throw;
+    }
+    // the pages are private: they are shared with the page cache until someone writes them, which the engines never do
+    size_t bytes = status.st_size;
+    void *mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED){
+        throw runtime_error("Could not map the file '" + filename + "'");
+    }
+    Matrix matrix = Matrix::adopt_mapping(mapping, bytes, header.payload_offset, header.n);
+    if(verify && binary_checksum(matrix.data(), header.payload_bytes) != header.checksum){
+        throw runtime_error("The checksum of the file '" + filename + "' does not match its content");
+    }
+    return matrix;
+}
+
+
+/*!
+ * The following function reads a vector written by write_binary_vector.
+ * @param filename [string] := file where the vector is stored
+ * @param verify [bool] := true if the checksum of the payload must be verified
+ * @return vector [vector<float>] := vector read from the file
+ * @throw runtime_error if the file cannot be opened or it is not a valid binary vector
+ */
+vector<float> read_binary_vector(const string &filename, bool verify){
+
+    BinaryHeader header = read_binary_header(filename, BinaryKind::VECTOR);
+    ifstream input_file(filename, ios::binary);
+    vector<float> vector(header.n);
+    input_file.seekg(header.payload_offset);
+    if(!input_file.read(reinterpret_cast<char *>(vector.data()), header.payload_bytes)){
+        throw runtime_error("The file '" + filename + "' is truncated");
+    }
+    if(verify && binary_checksum(vector.data(), header.payload_bytes) != header.checksum){
+        throw runtime_error("The checksum of the file '" + filename + "' does not match its content");
+    }
+    return vector;
+}
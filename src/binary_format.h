@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string>
+#include "matrix.h"
+using namespace std;
+
+
+#define BINARY_MAGIC "JACB" // first bytes of every binary file
+#define BINARY_VERSION 1 // version of the layout written by this code
+#define BINARY_PAYLOAD_OFFSET 4096 // offset of the payload, a page so that the mapped rows keep their alignment
+
+
+/*!
+ * The following enumerations describe the content of a binary file.
+ */
+enum class BinaryKind : uint32_t { MATRIX = 0, VECTOR = 1 };
+enum class BinaryType : uint32_t { FP32 = 0 }; // type of the stored elements
+enum class BinaryLayout : uint32_t {
+    ROW_MAJOR_PADDED = 0, // rows of n elements padded with zeros to a multiple of CACHE_LINE bytes, as in Matrix
+    CONTIGUOUS = 1 // n elements one after the other, used by the vectors
+};
+
+
+/*!
+ * The following structure is the header of a binary file: it fills one cache line at the beginning of the file and is
+ * followed by the payload at BINARY_PAYLOAD_OFFSET. The checksum is computed on the payload with binary_checksum.
+ */
+struct alignas(CACHE_LINE) BinaryHeader {
+    char magic[4]; // BINARY_MAGIC without the terminator
+    uint32_t version; // BINARY_VERSION
+    BinaryKind kind; // matrix or vector
+    BinaryType type; // type of the elements
+    BinaryLayout layout; // order of the elements in the payload
+    uint32_t reserved;
+    int64_t n; // dimension of the matrix or of the vector
+    int64_t stride; // elements between the beginnings of two rows (n for the vectors)
+    uint64_t payload_offset; // offset of the payload from the beginning of the file
+    uint64_t payload_bytes; // length of the payload
+    uint64_t checksum; // checksum of the payload
+};
+
+
+/*!
+ * The following function computes the checksum of a payload, 8 bytes at a time (the payloads are multiples of 4 bytes,
+ * the last 4 bytes are padded with zeros).
+ * @param data [const void *] := first byte of the payload
+ * @param bytes [size_t] := length of the payload
+ * @return checksum [uint64_t] := checksum of the payload
+ */
+uint64_t binary_checksum(const void *data, size_t bytes);
+
+
+/*!
+ * The following function writes a matrix in the binary format, with its rows padded as in memory so that it can be
+ * mapped without copying it.
+ * @param matrix [Matrix] := matrix to write
+ * @param filename [string] := file where the matrix is written
+ * @throw runtime_error if the file cannot be written
+ */
+void write_binary_matrix(const Matrix &matrix, const string &filename);
+
+
+/*!
+ * The following function writes a vector in the binary format.
+ * @param vector [vector<float>] := vector to write
+ * @param filename [string] := file where the vector is written
+ * @throw runtime_error if the file cannot be written
+ */
+void write_binary_vector(const vector<float> &vector, const string &filename);
+
+
+/*!
+ * The following function reads and checks the header of a binary file, without reading its payload.
+ * @param filename [string] := file to read
+ * @param kind [BinaryKind] := expected content of the file
+ * @return header [BinaryHeader] := header of the file
+ * @throw runtime_error if the file cannot be opened or its header is not valid
+ */
+BinaryHeader read_binary_header(const string &filename, BinaryKind kind);
+
+
+/*!
+ * @param filename [string] := file to check
+ * @return binary [bool] := true if the file begins with BINARY_MAGIC, false if it does not or it cannot be read
+ */
+bool is_binary_file(const string &filename);
+
+
+/*!
+ * The following function maps a matrix written by write_binary_matrix. The elements are not copied: the engines read
+ * the mapped pages, which are loaded by the kernel when they are touched the first time.
+ * @param filename [string] := file where the matrix is stored
+ * @param verify [bool] := true if the checksum of the payload must be verified (it reads all the pages once)
+ * @return matrix [Matrix] := matrix that reads its elements from the mapped file
+ * @throw runtime_error if the file cannot be opened or it is not a valid binary matrix
+ */
+Matrix map_binary_matrix(const string &filename, bool verify = true);
+
+
+/*!
+ * The following function reads a vector written by write_binary_vector.
+ * @param filename [string] := file where the vector is stored
+ * @param verify [bool] := true if the checksum of the payload must be verified
+ * @return vector [vector<float>] := vector read from the file
+ * @throw runtime_error if the file cannot be opened or it is not a valid binary vector
+ */
+vector<float> read_binary_vector(const string &filename, bool verify = true);
@@ -0,0 +1,207 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "utility.h"
+#include "row_kernel.h"
+#include "tiling.h"
+#include "utimer.cpp"
+
+using namespace std;
+
+#define TRIALS 5
+#define MIN_MATRIX 0
+#define MAX_MATRIX 20
+#define MIN_VECTOR 0
+#define MAX_VECTOR 20
+#define SEED 14
+
+
+/*!
+ * The following class counts a hardware cache event of the calling thread with perf_event_open. If the kernel does
+ * not allow the counter (e.g. perf_event_paranoid, containers or virtual machines) the counter is not available and
+ * read() returns -1, so that the benchmark still reports the times.
+ */
+class CacheCounter {
+
+private:
+    int fd = -1;
+
+public:
+
+    /*!
+     * @param cache [unsigned] := cache to count (PERF_COUNT_HW_CACHE_L1D or PERF_COUNT_HW_CACHE_LL)
+     */
+    explicit CacheCounter(unsigned cache){
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    ~CacheCounter(){
+        if(fd >= 0){
+            close(fd);
+        }
+    }
+
+    CacheCounter(const CacheCounter &) = delete;
+    CacheCounter &operator=(const CacheCounter &) = delete;
+
+    void start(){
+        if(fd >= 0){
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    void stop(){
+        if(fd >= 0){
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    /*!
+     * @return misses [long long] := misses counted between start() and stop(), -1 if the counter is not available
+     */
+    long long read() const {
+        long long value;
+        if(fd < 0 || ::read(fd, &value, sizeof(value)) != sizeof(value)){
+            return -1;
+        }
+        return value;
+    }
+};
+
+
+/*!
+ * The following function computes one sweep of the Jacobi's Algorithm row by row, as the plain engines do.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param inverse_diagonal [vector<float>] := reciprocals of the elements on the diagonal
+ * @param prev_variables [vector<float>] := solution computed at the previous iteration
+ * @param curr_variables [vector<float>] := vector where the new solution is stored
+ */
+void row_sweep(const Matrix &matrix, const vector<float> &knownTerm, const vector<float> &inverse_diagonal,
+               const vector<float> &prev_variables, vector<float> &curr_variables){
+
+    int n = knownTerm.size();
+    for(int i = 0; i < n; i++){
+        curr_variables[i] = jacobi_row(matrix, i, prev_variables.data(), knownTerm[i], inverse_diagonal[i]);
+    }
+}
+
+
+/*!
+ * The following function runs the sweeps of a variant and prints its time, its IPC and its cache misses and stall
+ * cycles per sweep.
+ * @param name [string] := name of the variant
+ * @param sweep [function] := function that computes one sweep
+ * @param iterations [int] := number of sweeps of each trial
+ * @param flops [double] := floating point operations of all the sweeps of a trial
+ */
+template <typename Sweep>
+void measure(const string &name, Sweep sweep, int iterations, double flops){
+
+    long time;
+    long double avg_time = 0;
+    long long l1_misses = 0;
+    long long llc_misses = 0;
+    CacheCounter l1(PERF_COUNT_HW_CACHE_L1D);
+    CacheCounter llc(PERF_COUNT_HW_CACHE_LL);
+    PerfSample events; // cycles, instructions and stall cycles of all the trials
+    for(int trial = 0; trial < TRIALS; trial++){
+        PerfSample trial_events;
+        l1.start();
+        llc.start();
+        {
+            utimer t = utimer(name, &time, &trial_events);
+            for(int k = 0; k < iterations; k++){
+                sweep();
+            }
+        }
+        l1.stop();
+        llc.stop();
+        avg_time += time;
+        events += trial_events;
+        l1_misses = l1.read() < 0 || l1_misses < 0 ? -1 : l1_misses + l1.read();
+        llc_misses = llc.read() < 0 || llc_misses < 0 ? -1 : llc_misses + llc.read();
+    }
+    avg_time /= TRIALS;
+    double sweeps = (double) TRIALS * iterations;
+    cout << name << "\tAVG_TIME: " << avg_time << " usec\tGFLOP/s: " << flops / (avg_time * 1e3);
+    cout << "\tL1D MISSES/SWEEP: " << (l1_misses < 0 ? string("n/a") : to_string((long long) (l1_misses / sweeps)));
+    cout << "\tLLC MISSES/SWEEP: " << (llc_misses < 0 ? string("n/a") : to_string((long long) (llc_misses / sweeps)));
+    cout << "\tIPC: " << (events.ipc() < 0 ? string("n/a") : to_string(events.ipc()));
+    cout << "\tSTALL CYCLES/SWEEP: " <<
+         (events.stall_cycles < 0 ? string("n/a") : to_string((long long) (events.stall_cycles / sweeps)));
+    cout << endl;
+}
+
+
+int main(int argc, char *argv[]){
+
+    int iterations = argc > 1 ? atoi(argv[1]) : 20;
+    vector<int> sizes;
+    for(int a = 2; a < argc; a++){
+        sizes.push_back(atoi(argv[a]));
+    }
+    if(sizes.empty()){
+        sizes = {2048, 8192, 16384, 32768};
+    }
+
+    CacheSizes caches = detect_caches();
+    cout << "L1D: " << caches.l1 / 1024 << "KB L2: " << caches.l2 / 1024 << "KB L3: " << caches.l3 / 1024 << "KB" <<
+         " ITERATIONS: " << iterations << " SELECTED KERNEL: " << row_kernel_name() << endl;
+
+    for(int size : sizes){
+        Matrix matrix = generate_matrix(size, MIN_MATRIX, MAX_MATRIX, SEED);
+        vector<float> knownTerm = generate_vector(size, MIN_VECTOR, MAX_VECTOR, SEED);
+        vector<float> inverse_diagonal(size);
+        for(int i = 0; i < size; i++){
+            inverse_diagonal[i] = 1.0f / matrix[i][i];
+        }
+        // the sweeps are applied always to the same vector, so that every variant computes the same values
+        vector<float> prev_variables = generate_vector(size, MIN_VECTOR, MAX_VECTOR, SEED + 1);
+        vector<float> reference(size);
+        vector<float> curr_variables(size);
+        double flops = 2.0 * size * size * iterations;
+
+        cout << endl << "SIZE: " << size << endl;
+        measure("rows", [&]() { row_sweep(matrix, knownTerm, inverse_diagonal, prev_variables, reference); },
+                iterations, flops);
+
+        Tiling automatic = auto_tiling(size, caches);
+        vector<Tiling> tilings = {automatic, {8, 1024}, {16, 2048}, {32, 4096}};
+        for(const Tiling &tiling : tilings){
+            if(tiling.columns == 0){
+                cout << "auto\tnot tiled: the variables fit in half of the L1 cache" << endl;
+                continue;
+            }
+            string name = to_string(tiling.rows) + "x" + to_string(tiling.columns) +
+                          (&tiling == &tilings[0] ? " (auto)" : "");
+            measure(name, [&]() {
+                ConvergencePartial partial;
+                tiled_sweep(matrix, 0, size, prev_variables.data(), curr_variables.data(), knownTerm.data(),
+                            inverse_diagonal.data(), tiling, partial);
+            }, iterations, flops);
+            float max_error = 0;
+            for(int i = 0; i < size; i++){
+                max_error = max(max_error, fabs(curr_variables[i] - reference[i]) / fabs(reference[i]));
+            }
+            cout << "\tMAX RELATIVE DIFFERENCE FROM rows: " << max_error << endl;
+        }
+    }
+
+    return 0;
+}
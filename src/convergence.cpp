@@ -0,0 +1,111 @@
+#include <string>
+#include <cmath>
+#include <stdexcept>
+#include "convergence.h"
+using namespace std;
+
+
+/*!
+ * The following function parses a stopping criteria given on the command line.
+ * @param text [string] := "increment", "residual" or "max"
+ * @return criterion [StoppingCriterion] := parsed criterion
+ * @throw invalid_argument if the text is not a valid criterion
+ */
+StoppingCriterion parse_criterion(const string &text){
+
+    if(text == "increment"){
+        return StoppingCriterion::INCREMENT;
+    }
+    if(text == "residual"){
+        return StoppingCriterion::RESIDUAL;
+    }
+    if(text == "max"){
+        return StoppingCriterion::MAX_NORM;
+    }
+    throw invalid_argument("The criterion '" + text + "' is not valid: it must be increment, residual or max");
+}
+
+
+/*!
+ * @param criterion [StoppingCriterion] := stopping criteria
+ * @return name [string] := name of the criterion, as accepted by parse_criterion
+ */
+string criterion_name(StoppingCriterion criterion){
+
+    switch(criterion){
+        case StoppingCriterion::RESIDUAL:
+            return "residual";
+        case StoppingCriterion::MAX_NORM:
+            return "max";
+        default:
+            return "increment";
+    }
+}
+
+
+/*!
+ * The following function parses the cadence of the checks given on the command line.
+ * @param text [string] := "auto" or the number of iterations between two checks (e.g. 10)
+ * @return cadence [int] := parsed cadence, CHECK_PREDICTED for auto
+ * @throw invalid_argument if the text is not a valid cadence
+ */
+int parse_cadence(const string &text){
+
+    if(text == "auto"){
+        return CHECK_PREDICTED;
+    }
+    try{
+        size_t end;
+        int cadence = stoi(text, &end);
+        if(end != text.size() || cadence < 1){
+            throw invalid_argument(text);
+        }
+        return cadence;
+    }
+    catch(const exception &){
+        throw invalid_argument("The check '" + text + "' is not valid: it must be auto or the number of iterations "
+                               "between two checks (>= 1)");
+    }
+}
+
+
+/*!
+ * @param cadence [int] := cadence of the checks
+ * @return name [string] := name of the cadence, as accepted by parse_cadence
+ */
+string cadence_name(int cadence){
+    return cadence == CHECK_PREDICTED ? "auto" : to_string(cadence);
+}
+
+
+/*!
+ * The following function checks the stopping criteria computed at an iteration and chooses the next check.
+ * @param iteration [int] := iteration of the Jacobi's Algorithm, from 0
+ * @param epsilon [long double] := value of the stopping criteria
+ * @return converged [bool] := true if the stopping criteria is not greater than the tolerance
+ */
+bool ConvergenceMonitor::converged(int iteration, long double epsilon){
+
+    if(epsilon <= tolerance){
+        return true;
+    }
+    if(cadence != CHECK_PREDICTED){
+        next_check = iteration + cadence;
+    }
+    else{
+        // the first two checks are consecutive, then epsilon_k = epsilon_j * rate^(k - j) predicts the iterations
+        // still needed; if the criterion did not shrink the interval is doubled, so a stalled solve is rarely checked
+        long double interval = 1;
+        if(last_check >= 0 && last_epsilon > 0 && epsilon > 0){
+            long double rate = pow(epsilon / last_epsilon, 1.0L / (iteration - last_check));
+            interval = rate < 1 ? ceil(log(tolerance / epsilon) / log(rate)) : 2.0L * (iteration - last_check);
+        }
+        if(!(interval >= 1)){ // a tolerance of 0 gives an infinite interval, which is capped below
+            interval = 1;
+        }
+        next_check = iteration + (int) min(interval, (long double) MAX_CHECK_INTERVAL);
+    }
+    last_check = iteration;
+    last_epsilon = epsilon;
+    return false;
+}
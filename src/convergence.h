@@ -0,0 +1,190 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include "jacobi_workspace.h"
+using namespace std;
+
+
+#define CHECK_PREDICTED 0 // cadence of Convergence that predicts the next check from the contraction rate
+#define MAX_CHECK_INTERVAL 64 // largest number of iterations between two predicted checks
+
+
+/*!
+ * The following enumeration lists the stopping criteria of the dense Jacobi engines (seq, thr and ff).
+ */
+enum class StoppingCriterion {
+    INCREMENT, // ||(current - previous)|| / ||current||
+    RESIDUAL, // ||b - A previous|| / ||b||, the residual of the previous iterate, computed for free by the sweep
+    MAX_NORM // max|current - previous| / max|current|
+};
+
+
+/*!
+ * The following structure describes how the dense Jacobi engines decide that the solution has converged.
+ */
+struct Convergence {
+    StoppingCriterion criterion = StoppingCriterion::INCREMENT;
+    int cadence = 1; // iterations between two checks, CHECK_PREDICTED to predict them from the contraction rate
+};
+
+
+/*!
+ * The following function parses a stopping criteria given on the command line.
+ * @param text [string] := "increment", "residual" or "max"
+ * @return criterion [StoppingCriterion] := parsed criterion
+ * @throw invalid_argument if the text is not a valid criterion
+ */
+StoppingCriterion parse_criterion(const string &text);
+
+
+/*!
+ * @param criterion [StoppingCriterion] := stopping criteria
+ * @return name [string] := name of the criterion, as accepted by parse_criterion
+ */
+string criterion_name(StoppingCriterion criterion);
+
+
+/*!
+ * The following function parses the cadence of the checks given on the command line.
+ * @param text [string] := "auto" or the number of iterations between two checks (e.g. 10)
+ * @return cadence [int] := parsed cadence, CHECK_PREDICTED for auto
+ * @throw invalid_argument if the text is not a valid cadence
+ */
+int parse_cadence(const string &text);
+
+
+/*!
+ * @param cadence [int] := cadence of the checks
+ * @return name [string] := name of the cadence, as accepted by parse_cadence
+ */
+string cadence_name(int cadence);
+
+
+/*!
+ * The following function accumulates the contribution of a row to the partial sums of the stopping criteria. With the
+ * residual, the i-th element of b - A previous is (b[i] - sum_{j != i} a[i][j] previous[j]) - a[i][i] previous[i],
+ * that is a[i][i] (current[i] - previous[i]): the sweep gives it without reading the row again.
+ * @param partial [ConvergencePartial] := partial sums of the stopping criteria, updated
+ * @param criterion [StoppingCriterion] := stopping criteria
+ * @param variable [float] := new value of the variable
+ * @param previous [float] := value of the variable at the previous iteration
+ * @param known [float] := element of the vector b of the row
+ * @param inverse [float] := reciprocal of the element on the diagonal of the row
+ */
+inline void accumulate_row(ConvergencePartial &partial, StoppingCriterion criterion, float variable, float previous,
+                           float known, float inverse){
+
+    float delta = variable - previous;
+    switch(criterion){
+        case StoppingCriterion::INCREMENT:
+            partial.difference += delta * delta;
+            partial.norm += variable * variable;
+            break;
+        case StoppingCriterion::RESIDUAL: {
+            float residual = delta / inverse;
+            partial.difference += residual * residual;
+            partial.norm += known * known;
+            break;
+        }
+        case StoppingCriterion::MAX_NORM:
+            partial.difference = max(partial.difference, (double) fabs(delta));
+            partial.norm = max(partial.norm, (double) fabs(variable));
+            break;
+    }
+}
+
+
+/*!
+ * The following function adds the partial sums of a worker to the total ones.
+ * @param total [ConvergencePartial] := partial sums of the stopping criteria, updated
+ * @param partial [ConvergencePartial] := partial sums of a worker
+ * @param criterion [StoppingCriterion] := stopping criteria
+ */
+inline void merge_partial(ConvergencePartial &total, const ConvergencePartial &partial, StoppingCriterion criterion){
+
+    if(criterion == StoppingCriterion::MAX_NORM){
+        total.difference = max(total.difference, partial.difference);
+        total.norm = max(total.norm, partial.norm);
+    }
+    else{
+        total.difference += partial.difference;
+        total.norm += partial.norm;
+    }
+}
+
+
+/*!
+ * @param total [ConvergencePartial] := partial sums of the stopping criteria of all the rows
+ * @param criterion [StoppingCriterion] := stopping criteria
+ * @return epsilon [long double] := value of the stopping criteria
+ */
+inline long double criterion_value(const ConvergencePartial &total, StoppingCriterion criterion){
+
+    if(criterion == StoppingCriterion::MAX_NORM){
+        return (long double) total.difference / total.norm;
+    }
+    return sqrt((long double) total.difference) / sqrt((long double) total.norm);
+}
+
+
+/*!
+ * The following function combines the partial sums of the workers into the stopping criteria.
+ * @param partials [vector<ConvergencePartial>] := partial sums computed by the workers
+ * @param count [int] := number of workers whose partial sums must be combined
+ * @param criterion [StoppingCriterion] := stopping criteria, ||(current - previous)|| / ||current|| by default
+ * @return epsilon [long double] := value of the stopping criteria
+ */
+inline long double combine_partials(const vector<ConvergencePartial> &partials, int count,
+                                    StoppingCriterion criterion = StoppingCriterion::INCREMENT){
+
+    ConvergencePartial total;
+    for(int t = 0; t < count; t++){
+        merge_partial(total, partials[t], criterion);
+    }
+    return criterion_value(total, criterion);
+}
+
+
+/*!
+ * The following class decides at which iterations the stopping criteria is checked. With a fixed cadence m it is
+ * checked every m iterations; with CHECK_PREDICTED the contraction rate r of the last two checks (the criterion
+ * shrinks by r at each iteration) predicts how many iterations are still needed to reach the tolerance, and the next
+ * check is done then, so a converging solve is checked only a few times. The rows of the iterations that are not
+ * checked are computed without accumulating the stopping criteria.
+ */
+class ConvergenceMonitor {
+
+private:
+    int cadence;
+    double tolerance;
+    int next_check; // iteration of the next check
+    int last_check = -1; // iteration of the last check, -1 if there was none
+    long double last_epsilon = 0; // value of the stopping criteria at the last check
+
+public:
+
+    /*!
+     * @param convergence [Convergence] := stopping criteria and cadence of the checks
+     * @param tolerance [double] := tolerance of the stopping criteria, the checks are disabled if smaller than 0
+     */
+    ConvergenceMonitor(const Convergence &convergence, double tolerance) : cadence(convergence.cadence),
+                                                                           tolerance(tolerance) {
+        next_check = cadence > 1 ? cadence - 1 : 0;
+    }
+
+    /*!
+     * @param iteration [int] := iteration of the Jacobi's Algorithm, from 0
+     * @return due [bool] := true if the stopping criteria must be accumulated and checked at the iteration
+     */
+    bool due(int iteration) const { return tolerance >= 0 && iteration >= next_check; }
+
+    /*!
+     * The following function checks the stopping criteria computed at an iteration and chooses the next check.
+     * @param iteration [int] := iteration of the Jacobi's Algorithm, from 0
+     * @param epsilon [long double] := value of the stopping criteria
+     * @return converged [bool] := true if the stopping criteria is not greater than the tolerance
+     */
+    bool converged(int iteration, long double epsilon);
+};
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <mpi.h>
+#include "utility.h"
+#include "generator.h"
+#include "jacobi_mpi.h"
+
+using namespace std;
+
+#define TRIALS 5
+#define MIN_MATRIX 0
+#define MAX_MATRIX 20
+#define MIN_VECTOR 0
+#define MAX_VECTOR 20
+#define SEED 14
+
+
+/*!
+ * The following program solves the linear system of main.out with the distributed engine, on as many processes as
+ * started by mpirun (on a single machine the ranks exchange the slices through shared memory):
+ *     mpirun -np [RANKS] ./distributed.out [SIZE] [ITERATIONS] [TOLERANCE] [OUTPUT_FILENAME] [overlap|blocking]
+ * The rank 0 appends the number of ranks and the average time to [OUTPUT_FILENAME][SIZE]dist_[overlap|blocking].csv,
+ * as main.out does for the threads.
+ */
+int main(int argc, char *argv[]){
+
+    MPI_Init(&argc, &argv);
+    int rank, ranks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+
+    if(argc != 5 && argc != 6){
+        if(rank == 0){
+            cerr << "Parameters: [SIZE] [ITERATIONS] [TOLERANCE] [OUTPUT_FILENAME] [overlap|blocking]" << endl;
+        }
+        MPI_Finalize();
+        exit(-1);
+    }
+    int size = atoi(argv[1]);
+    int iterations = atoi(argv[2]);
+    double tolerance = atof(argv[3]);
+    string output_filename = argv[4];
+    string exchange = argc == 6 ? argv[5] : "overlap";
+    if(size < 1 || (exchange != "overlap" && exchange != "blocking")){
+        if(rank == 0){
+            cerr << "The size must be >= 1 and the exchange must be overlap or blocking!" << endl;
+        }
+        MPI_Finalize();
+        exit(-2);
+    }
+
+    MatrixGenerator generator;
+    generator.min_value = MIN_MATRIX;
+    generator.max_value = MAX_MATRIX;
+    generator.seed = SEED;
+    DistributedSystem system = distribute_system(size, generator,
+                                                 generate_vector(size, MIN_VECTOR, MAX_VECTOR, SEED), MPI_COMM_WORLD);
+
+    if(rank == 0){
+        cout << "\t \t ---JACOBI METHOD--- \t \t" << endl;
+        cout << "MODE: distributed (" << exchange << ")" << endl;
+        cout << "SIZE: " << size << endl;
+        cout << "ITERATIONS: " << iterations << endl;
+        if(tolerance < 0){
+            cout << "TOLERANCE: DISABLED" << endl;
+        }
+        else{
+            cout << "TOLERANCE: " << tolerance << endl;
+        }
+        cout << "RANKS: " << ranks << endl;
+    }
+
+    JacobiWorkspace workspace;
+    long time;
+    long double avg_time = 0;
+    for(int i = 0; i < TRIALS; i++){
+        distributed_jacobi(system, iterations, tolerance, time, workspace, MPI_COMM_WORLD, exchange == "overlap");
+        avg_time += time;
+    }
+    avg_time /= TRIALS;
+
+    if(rank == 0){
+        cout << "DISTRIBUTED AVG_TIME: " << avg_time << " with " << TRIALS << " trials" << endl;
+        ofstream output_file;
+        string filename = output_filename + to_string(size) + "dist_" + exchange + ".csv";
+        output_file.open(filename, std::ios::app);
+        if(!output_file.is_open()){
+            cerr << "Could not open the file '" << filename << "'" << endl;
+            MPI_Abort(MPI_COMM_WORLD, 8);
+        }
+        output_file << ranks << "\t" << avg_time << endl;
+        output_file.close();
+    }
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,16 @@
+iterations=100
+tolerance=-1
+output_filename="results"
+max_ranks=32
+mpirun=${MPIRUN:-mpirun} # e.g. MPIRUN="mpirun --oversubscribe" to start more ranks than cores
+
+for size in 1000 5000 15000; do
+
+  for exchange in "overlap" "blocking"; do
+    ${mpirun} -np 1 ./distributed.out ${size} ${iterations} ${tolerance} ${output_filename} ${exchange}
+    for((i = 2; i <= max_ranks; i+=2)); do
+      ${mpirun} -np ${i} ./distributed.out ${size} ${iterations} ${tolerance} ${output_filename} ${exchange}
+    done
+  done
+
+done
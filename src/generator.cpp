@@ -0,0 +1,58 @@
+#include <stdexcept>
+#include "generator.h"
+using namespace std;
+
+
+/*!
+ * The following function parses a family given on the command line.
+ * @param text [string] := "dense" or "banded"
+ * @return family [MatrixFamily] := parsed family
+ * @throw invalid_argument if the text is not a valid family
+ */
+MatrixFamily parse_family(const string &text){
+
+    if(text == "dense"){
+        return MatrixFamily::DENSE;
+    }
+    if(text == "banded"){
+        return MatrixFamily::BANDED;
+    }
+    throw invalid_argument("The family '" + text + "' is not valid: it must be dense or banded");
+}
+
+
+/*!
+ * @param family [MatrixFamily] := family of matrices
+ * @return name [string] := name of the family, as accepted by parse_family
+ */
+string family_name(MatrixFamily family){
+    return family == MatrixFamily::BANDED ? "banded" : "dense";
+}
+
+
+/*!
+ * The following function generates a matrix in parallel: each worker generates the rows that it will compute in the
+ * native threads engine (same partitioning), so their pages are first touched, and placed, by that worker. The
+ * matrix has the same bits whatever the number of workers.
+ * @param n [int] := dimension of the matrix
+ * @param generator [MatrixGenerator] := description of the matrix
+ * @param pool [ThreadPool] := pool of at least num_threads workers
+ * @param num_threads [int] := number of workers that generate the rows
+ * @return matrix [Matrix] := generated matrix
+ */
+Matrix generate_matrix(int n, const MatrixGenerator &generator, ThreadPool &pool, int num_threads){
+
+    Matrix matrix = Matrix::uninitialized(n);
+    int stride = matrix.row_stride();
+    int chunk = n / num_threads;
+
+    auto body = [&](int tid) { // each worker writes (and so places) the rows it will compute
+        int start = tid * chunk;
+        int end = tid != num_threads - 1 ? start + chunk : n;
+        for(int i = start; i < end; i++){
+            generator.generate_row(n, i, matrix[i], stride);
+        }
+    };
+    pool.run(num_threads, body);
+    return matrix;
+}
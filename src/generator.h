@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <algorithm>
+#include "matrix.h"
+#include "thread_pool.h"
+using namespace std;
+
+
+#define MATRIX_STREAM 0 // stream of the counter-based generator used by the elements of the matrices
+#define VECTOR_STREAM 1 // stream used by the elements of the vectors, so that b is independent from the rows of A
+#define SPARSE_STREAM 2 // stream used by the lengths, the columns and the values of the rows of the sparse matrices
+
+
+/*!
+ * The following function is the SplitMix64 finalizer: a bijection on 64 bits whose output bits depend on all the
+ * input bits.
+ * @param x [uint64_t] := value to mix
+ * @return mixed [uint64_t] := mixed value
+ */
+inline uint64_t splitmix64(uint64_t x){
+
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+
+/*!
+ * The following function is a counter-based random generator: the number is a pure function of the seed, of the
+ * stream and of the counter, so any element can be generated independently of the others, by any thread and in any
+ * order, always with the same bits.
+ * @param seed [uint64_t] := seed of the generator
+ * @param stream [uint64_t] := independent sequence of the seed (MATRIX_STREAM, VECTOR_STREAM or SPARSE_STREAM)
+ * @param counter [uint64_t] := position in the sequence
+ * @return number [float] := uniform number in [0, 1) with 24 random bits
+ */
+inline float counter_uniform(uint64_t seed, uint64_t stream, uint64_t counter){
+
+    uint64_t key = splitmix64(splitmix64(seed) + stream);
+    return (float) (splitmix64(key ^ counter) >> 40) * 0x1.0p-24f;
+}
+
+
+/*!
+ * The following enumeration lists the families of diagonally dominant matrices that can be generated.
+ */
+enum class MatrixFamily {
+    DENSE, // every off-diagonal element is random
+    BANDED // only the elements with |i - j| <= bandwidth are random, the others are 0
+};
+
+
+/*!
+ * The following structure describes a generated matrix. Each off-diagonal element (i, j) is uniform in
+ * [min_value, max_value] and depends only on the seed, i and j; the diagonal element is dominance times the sum of the
+ * off-diagonal elements of its row (the elements are not negative), so the Jacobi's Algorithm converges when
+ * dominance > 1 and converges more slowly as it gets closer to 1.
+ */
+struct MatrixGenerator {
+    MatrixFamily family = MatrixFamily::DENSE;
+    float min_value = 0; // minimum value of the off-diagonal elements
+    float max_value = 20; // maximum value of the off-diagonal elements
+    float dominance = 2; // ratio between the diagonal element and the sum of the other elements of the row
+    int bandwidth = 0; // elements on each side of the diagonal of the banded family
+    uint64_t seed = 14; // seed of the counter-based generator
+
+    /*!
+     * The following function generates the i-th row of the matrix, padding included.
+     * @param n [int] := dimension of the matrix
+     * @param i [int] := index of the row
+     * @param row [float *] := first element of the row
+     * @param stride [int] := number of floats of the padded row
+     */
+    void generate_row(int n, int i, float *row, int stride) const {
+
+        int first = family == MatrixFamily::BANDED ? max(0, i - bandwidth) : 0;
+        int last = family == MatrixFamily::BANDED ? min(n, i + bandwidth + 1) : n;
+        // the settings are copied, otherwise the stores in the row could alias them and they would be reloaded
+        float low = min_value;
+        float range = max_value - min_value;
+        uint64_t key = seed;
+        float sum = 0;
+        fill(row, row + stride, 0.0f);
+        for(int j = first; j < last; j++){
+            if(j != i){ // the counter is (i, j), so the element does not depend on n nor on the family
+                float value = low + range * counter_uniform(key, MATRIX_STREAM, (uint64_t) i << 32 | (uint32_t) j);
+                row[j] = value;
+                sum += value;
+            }
+        }
+        row[i] = sum != 0 ? dominance * sum : 1;
+    }
+};
+
+
+/*!
+ * The following function parses a family given on the command line.
+ * @param text [string] := "dense" or "banded"
+ * @return family [MatrixFamily] := parsed family
+ * @throw invalid_argument if the text is not a valid family
+ */
+MatrixFamily parse_family(const string &text);
+
+
+/*!
+ * @param family [MatrixFamily] := family of matrices
+ * @return name [string] := name of the family, as accepted by parse_family
+ */
+string family_name(MatrixFamily family);
+
+
+/*!
+ * The following function generates a matrix in parallel: each worker generates the rows that it will compute in the
+ * native threads engine (same partitioning), so their pages are first touched, and placed, by that worker. The
+ * matrix has the same bits whatever the number of workers.
+ * @param n [int] := dimension of the matrix
+ * @param generator [MatrixGenerator] := description of the matrix
+ * @param pool [ThreadPool] := pool of at least num_threads workers
+ * @param num_threads [int] := number of workers that generate the rows
+ * @return matrix [Matrix] := generated matrix
+ */
+Matrix generate_matrix(int n, const MatrixGenerator &generator, ThreadPool &pool, int num_threads);
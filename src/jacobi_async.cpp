@@ -0,0 +1,288 @@
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <climits>
+#include "utimer.cpp"
+#include "row_kernel.h"
+#include "jacobi_async.h"
+#include "convergence.h"
+using namespace std;
+
+
+#define ASYNC_IDLE_YIELDS 1000 // yields of a settled thread waiting for new values before it sweeps anyway
+
+
+/*!
+ * The following function combines the last partial sums published by the threads into the stopping criteria
+ * ||(current - previous)|| / ||current||.
+ * @param progress [vector<AsyncProgress>] := progress published by the threads
+ * @return epsilon [long double] := the result of ||(current - previous)|| / ||current||, infinity if a thread has not
+ * completed a sweep yet
+ */
+static long double combine_progress(const vector<AsyncProgress> &progress){
+
+    long double difference = 0;
+    long double norm = 0;
+    for(const AsyncProgress &p : progress){
+        if(p.sweeps.load(memory_order_acquire) == 0){
+            return INFINITY;
+        }
+        difference += p.difference.load(memory_order_relaxed);
+        norm += p.norm.load(memory_order_relaxed);
+    }
+    return sqrt(difference) / sqrt(norm);
+}
+
+
+/*!
+ * The following function computes the relative residual ||b - Ax|| / ||b|| of a snapshot of the shared variables.
+ * The row kernel gives (b[i] - sum_{j != i} a[i][j] x[j]) / a[i][i], so the i-th element of b - Ax is
+ * a[i][i] (jacobi_row - x[i]).
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param inverse_diagonal [vector<float>] := reciprocals of the elements on the diagonal
+ * @param snapshot [vector<float>] := snapshot x of the shared variables
+ * @param norm [long double] := squared norm of b
+ * @return residual [long double] := relative residual of the snapshot
+ */
+template <typename DenseMatrix>
+static long double snapshot_residual(const DenseMatrix &matrix, const vector<float> &knownTerm,
+                                     const vector<float> &inverse_diagonal, const vector<float> &snapshot,
+                                     long double norm){
+
+    int n = knownTerm.size();
+    long double residual = 0;
+    for(int i = 0; i < n; i++){
+        double element = (jacobi_row(matrix, i, snapshot.data(), knownTerm[i], inverse_diagonal[i]) - snapshot[i]) /
+                         inverse_diagonal[i];
+        residual += element * element;
+    }
+    return sqrt(residual) / sqrt(norm);
+}
+
+
+/*!
+ * @param progress [vector<AsyncProgress>] := progress published by the threads
+ * @return sweeps [long] := number of sweeps completed by the slowest thread
+ */
+static long slowest_sweeps(const vector<AsyncProgress> &progress){
+
+    long sweeps = LONG_MAX;
+    for(const AsyncProgress &p : progress){
+        sweeps = min(sweeps, p.sweeps.load(memory_order_acquire));
+    }
+    return sweeps;
+}
+
+
+/*!
+ * @param progress [vector<AsyncProgress>] := progress published by the threads
+ * @param tid [int] := index of the thread whose sweeps are not counted
+ * @return sweeps [long] := total number of sweeps published by the other threads
+ */
+static long other_sweeps(const vector<AsyncProgress> &progress, int tid){
+
+    long sweeps = 0;
+    for(size_t t = 0; t < progress.size(); t++){
+        if((int) t != tid){
+            sweeps += progress[t].sweeps.load(memory_order_acquire);
+        }
+    }
+    return sweeps;
+}
+
+
+/*!
+ * The following function waits until the slowest of the other threads is at most staleness sweeps behind the given
+ * sweep, or until the solve is stopped.
+ * @param progress [vector<AsyncProgress>] := progress published by the threads
+ * @param tid [int] := index of the thread that waits
+ * @param sweep [long] := sweep that the thread is going to compute
+ * @param staleness [int] := maximum number of sweeps that a thread can be ahead of the slowest one
+ * @param stop [atomic<bool>] := flag set when the solve is stopped
+ */
+static void bound_staleness(const vector<AsyncProgress> &progress, int tid, long sweep, int staleness,
+                            const atomic<bool> &stop){
+
+    for(size_t t = 0; t < progress.size(); t++){
+        if((int) t == tid){
+            continue;
+        }
+        while(progress[t].sweeps.load(memory_order_acquire) < sweep - staleness &&
+              !stop.load(memory_order_relaxed)){
+            this_thread::yield();
+        }
+    }
+}
+
+
+/*!
+ * The following function computes the asynchronous (chaotic) version of the Jacobi's Algorithm using the native
+ * threads implementation.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := number of sweeps of the slowest thread after which the solve ends
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm, both by ||(current - previous)|| /
+ * ||current|| and by ||b - Ax|| / ||b|| (disabled if smaller than 0)
+ * @param staleness [int] := maximum number of sweeps that a thread can be ahead of the slowest one (unbounded if < 0)
+ * @param thr_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+template <typename DenseMatrix>
+static const vector<float> &async_solve(const DenseMatrix &matrix, const vector<float> &knownTerm, int K,
+                                        int num_threads, double tolerance, int staleness, long &thr_time,
+                                        JacobiWorkspace &workspace, ThreadPool &pool){
+
+    int n = knownTerm.size();
+    workspace.reset(matrix);
+    float *variables = workspace.curr_variables.data(); // the only copy of the variables shared by the threads
+    const vector<float> &inverse_diagonal = workspace.inverse_diagonal;
+    vector<vector<float>> &snapshots = workspace.snapshots;
+    int chunk = n / num_threads;
+    vector<AsyncProgress> progress(num_threads);
+    atomic<bool> stop{false};
+    atomic<long> interrupted{-1}; // sweep of the thread that stopped the solve
+    long double similarity = 0; // written only by the thread that stops the solve
+    long double residual = 0; // written only by the thread that stops the solve
+    // a vote of the partial sums is confirmed by one thread at a time; after a rejected vote the next one is confirmed
+    // only when every thread has published a sweep that started after it
+    atomic<bool> confirming{false};
+    vector<long> rejected(num_threads, 0); // sweeps of the threads at the last rejected vote, read under confirming
+    long double known_norm = 0;
+    for (float known : knownTerm) {
+        known_norm += (long double) known * known;
+    }
+
+    snapshots.resize(num_threads);
+
+    auto body = [&](int tid) { // function executed by a single thread
+
+        int start = tid * chunk;
+        int end = tid != num_threads - 1 ? start + chunk : n;
+        vector<float> &snapshot = snapshots[tid];
+        snapshot.resize(n); // allocated by the thread, so it is placed on its NUMA node
+        // a thread that has done K sweeps goes on until the slowest one has done them too, otherwise its rows would
+        // stay stale while a preempted thread catches up and the residual could not meet the tolerance
+        long others = 0; // sweeps published by the other threads when the snapshot was taken
+        bool settled = false; // true if the rows met the tolerance on the last snapshot
+        for (long sweep = 0; !stop.load(memory_order_relaxed); sweep++) {
+            if (sweep >= K) {
+                if (slowest_sweeps(progress) >= K) {
+                    break;
+                }
+                this_thread::yield(); // the extra sweeps only keep the rows fresh, the slowest thread runs first
+            }
+            // settled rows change only when the others publish new values: the thread yields the core, so on an
+            // oversubscribed machine the preempted threads run instead of sweeps on the same stale values
+            for (int idle = 0; settled && idle < ASYNC_IDLE_YIELDS && other_sweeps(progress, tid) == others &&
+                               !stop.load(memory_order_relaxed); idle++) {
+                this_thread::yield();
+            }
+            if (staleness >= 0) {
+                bound_staleness(progress, tid, sweep, staleness, stop);
+            }
+            // the latest values published by the other threads are copied once, then the rows are computed on the
+            // private snapshot with the row kernel
+            others = other_sweeps(progress, tid);
+            for (int j = 0; j < n; j++) {
+                snapshot[j] = atomic_ref<float>(variables[j]).load(memory_order_relaxed);
+            }
+            double difference = 0;
+            double norm = 0;
+            for (int i = start; i < end; i++) {
+                float variable = jacobi_row(matrix, i, snapshot.data(), knownTerm[i], inverse_diagonal[i]);
+                float delta = variable - snapshot[i];
+                difference += delta * delta;
+                norm += variable * variable;
+                atomic_ref<float>(variables[i]).store(variable, memory_order_relaxed);
+            }
+            progress[tid].difference.store(difference, memory_order_relaxed);
+            progress[tid].norm.store(norm, memory_order_relaxed);
+            progress[tid].sweeps.store(sweep + 1, memory_order_release);
+            settled = tolerance >= 0 && difference <= tolerance * tolerance * norm;
+            long double epsilon = tolerance >= 0 ? combine_progress(progress) : INFINITY;
+            // the partial sums come from sweeps on different stale snapshots, so they can meet the tolerance while a
+            // preempted thread is far behind: the vote is confirmed by the residual of a fresh snapshot. The threads
+            // that have done K sweeps may not publish again before the end, so their rows count as fresh
+            if (epsilon <= tolerance && !confirming.exchange(true, memory_order_acquire)) {
+                bool fresh = true;
+                for (int t = 0; t < num_threads; t++) {
+                    long sweeps = progress[t].sweeps.load(memory_order_acquire);
+                    fresh = fresh && (sweeps >= K || sweeps > rejected[t]);
+                }
+                if (fresh) {
+                    for (int j = 0; j < n; j++) {
+                        snapshot[j] = atomic_ref<float>(variables[j]).load(memory_order_relaxed);
+                    }
+                    long double confirmed = snapshot_residual(matrix, knownTerm, inverse_diagonal, snapshot,
+                                                              known_norm);
+                    long expected = -1;
+                    if (confirmed <= tolerance && interrupted.compare_exchange_strong(expected, sweep)) {
+                        similarity = epsilon;
+                        residual = confirmed;
+                        stop.store(true, memory_order_relaxed);
+                    }
+                    for (int t = 0; t < num_threads; t++) {
+                        rejected[t] = progress[t].sweeps.load(memory_order_acquire);
+                    }
+                }
+                confirming.store(false, memory_order_release);
+            }
+        }
+    };
+
+    string timer = "ASYNCHRONOUS " + to_string(num_threads) + " threads ";
+    {
+        utimer thr = utimer(timer, &thr_time);
+        pool.run(num_threads, body);
+    }
+
+    long fastest = 0;
+    long slowest = slowest_sweeps(progress);
+    for (const AsyncProgress &p : progress) {
+        fastest = max(fastest, p.sweeps.load());
+    }
+    workspace.iterations = slowest;
+    if (interrupted >= 0) {
+        cout << interrupted << ")Asynchronous Jacobi interrupted because " << similarity <<
+             " (" << criterion_name(StoppingCriterion::INCREMENT) << ") and " << residual << " (" <<
+             criterion_name(StoppingCriterion::RESIDUAL) << ") <= " << tolerance << " (tolerance)" << endl;
+    }
+    cout << "Sweeps of the threads: from " << slowest << " to " << fastest << endl;
+    return workspace.curr_variables;
+}
+
+
+/*!
+ * The following function computes the asynchronous (chaotic) version of the Jacobi's Algorithm using the native
+ * threads implementation.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := number of sweeps of the slowest thread after which the solve ends
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||, confirmed by ||b - Ax|| / ||b||
+ * @param staleness [int] := maximum number of sweeps that a thread can be ahead of the slowest one, if smaller than 0
+ * the threads are never bounded
+ * @param thr_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &async_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, int num_threads,
+                                  double tolerance, int staleness, long &thr_time, JacobiWorkspace &workspace,
+                                  ThreadPool &pool){
+    return async_solve(matrix, knownTerm, K, num_threads, tolerance, staleness, thr_time, workspace, pool);
+}
+
+
+const vector<float> &async_jacobi(const PrecisionMatrix &matrix, const vector<float> &knownTerm, int K,
+                                  int num_threads, double tolerance, int staleness, long &thr_time,
+                                  JacobiWorkspace &workspace, ThreadPool &pool){
+    return async_solve(matrix, knownTerm, K, num_threads, tolerance, staleness, thr_time, workspace, pool);
+}
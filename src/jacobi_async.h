@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include "matrix.h"
+#include "precision.h"
+#include "jacobi_workspace.h"
+#include "thread_pool.h"
+using namespace std;
+
+
+/*!
+ * The following structure stores the progress published by a worker of the asynchronous engine: the number of sweeps
+ * it has completed and the partial sums of the stopping criteria of its last sweep. It is aligned to the cache line,
+ * so that two workers never write on the same line.
+ */
+struct alignas(CACHE_LINE) AsyncProgress {
+    atomic<long> sweeps{0}; // number of sweeps completed by the worker
+    atomic<double> difference{0}; // sum of (current[i] - previous[i])^2 over the rows of the worker in its last sweep
+    atomic<double> norm{0}; // sum of current[i]^2 over the rows of the worker in its last sweep
+};
+
+
+/*!
+ * The following function computes the asynchronous (chaotic) version of the Jacobi's Algorithm using the native
+ * threads implementation. There is no barrier: each thread sweeps its block of rows again and again, reading the
+ * latest values of the variables published by the other threads. Before each sweep a thread takes a private snapshot
+ * of the shared variables with relaxed atomic loads, computes its rows on the snapshot with the row kernel and
+ * publishes them with relaxed atomic stores, so a slow thread does not stall the others. When a thread sees that the
+ * last partial sums published by all the threads meet the tolerance, it confirms the vote with the residual of a fresh
+ * snapshot, since the partial sums come from different stale snapshots; the solve stops as soon as a vote is confirmed
+ * (or when every thread has done K sweeps: the faster threads go on until the slowest one has done them). After a
+ * rejected vote, the next one is confirmed only when every thread has published a new sweep or has done K sweeps. A
+ * thread whose rows meet the tolerance on its snapshot yields the core before the next sweep, so that the preempted
+ * threads catch up on an oversubscribed machine. The sweeps of the slowest thread are stored in the workspace.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := number of sweeps of the slowest thread after which the solve ends
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||, confirmed by ||b - Ax|| / ||b||
+ * @param staleness [int] := maximum number of sweeps that a thread can be ahead of the slowest one, if smaller than 0
+ * the threads are never bounded
+ * @param thr_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &async_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, int num_threads,
+                                  double tolerance, int staleness, long &thr_time, JacobiWorkspace &workspace,
+                                  ThreadPool &pool);
+const vector<float> &async_jacobi(const PrecisionMatrix &matrix, const vector<float> &knownTerm, int K,
+                                  int num_threads, double tolerance, int staleness, long &thr_time,
+                                  JacobiWorkspace &workspace, ThreadPool &pool);
@@ -0,0 +1,344 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <barrier>
+#include "utimer.cpp"
+#include "jacobi_batch.h"
+#include "convergence.h"
+using namespace std;
+
+
+/*!
+ * The following function accumulates the products of the elements of a row in [first, last) with W consecutive active
+ * columns. The sums are kept in registers, in U independent groups so that the additions of consecutive elements of
+ * the row do not wait for each other.
+ * @param row [const float *] := pointer to the first element of the row of the matrix
+ * @param variables [const float *] := n x m iterates of the previous iteration, shifted to the first column of the group
+ * @param m [int] := number of active columns (distance between the variables of two consecutive rows)
+ * @param first [int] := first element of the row to multiply
+ * @param last [int] := element after the last one to multiply
+ * @param acc [float[U][W]] := partial sums, updated
+ */
+template <int W, int U>
+static inline __attribute__((always_inline)) void batch_accumulate(const float *__restrict row,
+                                                                   const float *__restrict variables, int m,
+                                                                   int first, int last, float (&acc)[U][W]){
+
+    int j = first;
+    for(; j + U <= last; j += U){
+        for(int u = 0; u < U; u++){
+            const float a = row[j + u];
+            const float *x = variables + (size_t) (j + u) * m;
+            for(int w = 0; w < W; w++){
+                acc[u][w] += a * x[w];
+            }
+        }
+    }
+    for(; j < last; j++){
+        const float a = row[j];
+        const float *x = variables + (size_t) j * m;
+        for(int w = 0; w < W; w++){
+            acc[0][w] += a * x[w];
+        }
+    }
+}
+
+
+/*!
+ * The following function computes the dot products of the i-th row with W consecutive active columns, so each element
+ * of the row is loaded once and multiplied by a contiguous group of W variables.
+ * @param row [const float *] := pointer to the first element of the i-th row of the matrix
+ * @param variables [const float *] := n x m iterates of the previous iteration, shifted to the first column of the group
+ * @param m [int] := number of active columns (distance between the variables of two consecutive rows)
+ * @param i [int] := index of the row, whose diagonal element is skipped
+ * @param n [int] := dimension of the linear system
+ * @param sums [float *] := the W dot products
+ */
+template <int W>
+static inline __attribute__((always_inline)) void batch_dot(const float *row, const float *variables, int m, int i,
+                                                            int n, float *sums){
+
+    constexpr int U = W >= 16 ? 2 : 4; // the large groups of columns already have many independent vector sums
+    float acc[U][W] = {};
+    // the diagonal is skipped by splitting the row, as in jacobi_row
+    batch_accumulate<W, U>(row, variables, m, 0, i, acc);
+    batch_accumulate<W, U>(row, variables, m, i + 1, n, acc);
+    for(int w = 0; w < W; w++){
+        float sum = 0;
+        for(int u = 0; u < U; u++){
+            sum += acc[u][w];
+        }
+        sums[w] = sum;
+    }
+}
+
+
+/*!
+ * The following function computes the dot products of the i-th row with all the m active columns, processed in groups
+ * of 32, 16, 8, 4 and 1 columns. It is compiled once for each instruction set, so the compiler vectorizes the groups with
+ * the widest registers available.
+ */
+static inline __attribute__((always_inline)) void batch_dot_columns(const float *row, const float *variables, int m,
+                                                                    int i, int n, float *sums){
+
+    int c = 0;
+    for(; c + 32 <= m; c += 32){
+        batch_dot<32>(row, variables + c, m, i, n, sums + c);
+    }
+    for(; c + 16 <= m; c += 16){
+        batch_dot<16>(row, variables + c, m, i, n, sums + c);
+    }
+    for(; c + 8 <= m; c += 8){
+        batch_dot<8>(row, variables + c, m, i, n, sums + c);
+    }
+    for(; c + 4 <= m; c += 4){
+        batch_dot<4>(row, variables + c, m, i, n, sums + c);
+    }
+    for(; c < m; c++){
+        batch_dot<1>(row, variables + c, m, i, n, sums + c);
+    }
+}
+
+
+static void batch_dot_portable(const float *row, const float *variables, int m, int i, int n, float *sums){
+    batch_dot_columns(row, variables, m, i, n, sums);
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2,fma")))
+static void batch_dot_avx2(const float *row, const float *variables, int m, int i, int n, float *sums){
+    batch_dot_columns(row, variables, m, i, n, sums);
+}
+#endif
+
+
+/*!
+ * The following function returns the best variant of the batched row kernel supported by the CPU.
+ * @return kernel [batch_dot_function] := pointer to the variant
+ */
+batch_dot_function batch_kernel(){
+
+#if defined(__x86_64__) || defined(__i386__)
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+        return batch_dot_avx2;
+    }
+#endif
+    return batch_dot_portable;
+}
+
+
+/*!
+ * The following function prepares the buffers for a new solve.
+ * @param matrix [Matrix] := matrix A of the linear system (AX=B)
+ * @param rhs [vector<vector<float>>] := the m right-hand sides (columns of B)
+ * @param workers [int] := number of workers that compute the rows
+ */
+void BatchWorkspace::reset(const Matrix &matrix, const vector<vector<float>> &rhs, int workers){
+
+    n = matrix.size();
+    active = rhs.size();
+    columns.resize(active);
+    for(int c = 0; c < active; c++){
+        columns[c] = c;
+    }
+    curr_variables.assign((size_t) n * active, 0.0);
+    prev_variables.assign((size_t) n * active, 0.0);
+    knownTerms.resize((size_t) n * active);
+    for(int i = 0; i < n; i++){
+        for(int c = 0; c < active; c++){
+            knownTerms[(size_t) i * active + c] = rhs[c][i];
+        }
+    }
+    inverse_diagonal.resize(n);
+    for(int i = 0; i < n; i++){
+        inverse_diagonal[i] = 1.0f / matrix[i][i];
+    }
+    partials.resize(workers);
+    for(BatchPartial &partial : partials){
+        partial.difference.assign(active, 0.0);
+        partial.norm.assign(active, 0.0);
+        partial.sums.resize(active);
+    }
+    solutions.resize(active);
+    iterations.assign(active, 0);
+    similarities.assign(active, -1);
+    if(kernel == nullptr){
+        kernel = batch_kernel();
+    }
+}
+
+
+/*!
+ * The following function combines the partial sums of the workers and retires the columns whose stopping criteria
+ * ||(current - previous)|| / ||current|| is not larger than the tolerance (or all the columns if it is the last
+ * iteration). The partial sums are cleared for the next iteration.
+ * @param workers [int] := number of workers whose partial sums must be combined
+ * @param iteration [int] := number of iterations computed so far
+ * @param tolerance [double] := tolerance of the stopping criteria (disabled if smaller than 0)
+ * @param last [bool] := true if it is the last iteration allowed
+ * @return finished [bool] := true if all the columns have retired
+ */
+bool BatchWorkspace::retire_columns(int workers, int iteration, double tolerance, bool last){
+
+    int kept = 0;
+    vector<bool> retired(active, false);
+    for(int c = 0; c < active; c++){
+        if(!last){
+            if(tolerance < 0){
+                kept++;
+                continue;
+            }
+            long double difference = 0;
+            long double norm = 0;
+            for(int t = 0; t < workers; t++){
+                difference += partials[t].difference[c];
+                norm += partials[t].norm[c];
+            }
+            long double similarity = sqrt(difference) / sqrt(norm);
+            if(similarity > tolerance){
+                kept++;
+                continue;
+            }
+            similarities[columns[c]] = similarity; // the message is printed after the timed region
+        }
+        retired[c] = true;
+        vector<float> &solution = solutions[columns[c]];
+        solution.resize(n);
+        for(int i = 0; i < n; i++){
+            solution[i] = curr_variables[(size_t) i * active + c];
+        }
+        iterations[columns[c]] = iteration;
+    }
+
+    if(kept < active){
+        // the active columns are compacted in place: the destination of each element is never after its source
+        for(int i = 0; i < n; i++){
+            int d = 0;
+            for(int c = 0; c < active; c++){
+                if(!retired[c]){
+                    curr_variables[(size_t) i * kept + d] = curr_variables[(size_t) i * active + c];
+                    knownTerms[(size_t) i * kept + d] = knownTerms[(size_t) i * active + c];
+                    d++;
+                }
+            }
+        }
+        int d = 0;
+        for(int c = 0; c < active; c++){
+            if(!retired[c]){
+                columns[d++] = columns[c];
+            }
+        }
+        columns.resize(kept);
+        active = kept;
+    }
+
+    for(int t = 0; t < workers; t++){
+        partials[t].difference.assign(active, 0.0);
+        partials[t].norm.assign(active, 0.0);
+    }
+    if(active > 0){ // the last solution becomes the previous one without copying it
+        swap(prev_variables, curr_variables);
+    }
+    return active == 0;
+}
+
+
+/*!
+ * The following function prints the iteration at which each column met the tolerance, after the timed solve.
+ * @param tolerance [double] := tolerance of the stopping criteria
+ */
+void BatchWorkspace::print_retired(double tolerance) const {
+
+    for(size_t c = 0; c < similarities.size(); c++){
+        if(similarities[c] >= 0){
+            cout << (iterations[c] - 1) << ")Batched Jacobi interrupted column " << c << " because " <<
+                 similarities[c] << " (" << criterion_name(StoppingCriterion::INCREMENT) << ") <= " << tolerance <<
+                 " (tolerance)" << endl;
+        }
+    }
+}
+
+
+/*!
+ * The following function computes the sequential version of the Jacobi's Algorithm for many right-hand sides at the
+ * same time: the columns are iterated together and each of them stops independently when it meets the tolerance.
+ * @param matrix [Matrix] := matrix A of the linear system (AX=B)
+ * @param rhs [vector<vector<float>>] := the m right-hand sides (columns of B)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm
+ * @param tolerance [double] := tolerance used to stop earlier each column and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param seq_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [BatchWorkspace] := buffers used during the computation
+ * @return solutions [const vector<vector<float>> &] := reference to the solutions stored in the workspace
+ */
+const vector<vector<float>> &sequential_jacobi_batch(const Matrix &matrix, const vector<vector<float>> &rhs, int K,
+                                                     double tolerance, long &seq_time, BatchWorkspace &workspace){
+
+    workspace.reset(matrix, rhs, 1);
+    int n = matrix.size();
+
+    {
+        utimer seq = utimer("Sequential batched Jacobi", &seq_time);
+        for(int k = 0; k < K && workspace.active > 0; k++){
+            batch_sweep(matrix, 0, n, workspace, 0);
+            workspace.retire_columns(1, k + 1, tolerance, k == K - 1);
+        }
+    }
+    workspace.print_retired(tolerance);
+    return workspace.solutions;
+}
+
+
+/*!
+ * The following function computes the parallel version of the Jacobi's Algorithm for many right-hand sides at the
+ * same time using the native threads implementation: each thread computes a block of rows for all the active
+ * columns and the columns retire at the barrier.
+ * @param matrix [Matrix] := matrix A of the linear system (AX=B)
+ * @param rhs [vector<vector<float>>] := the m right-hand sides (columns of B)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier each column and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param thr_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [BatchWorkspace] := buffers used during the computation
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
+ * @return solutions [const vector<vector<float>> &] := reference to the solutions stored in the workspace
+ */
+const vector<vector<float>> &threads_jacobi_batch(const Matrix &matrix, const vector<vector<float>> &rhs, int K,
+                                                  int num_threads, double tolerance, long &thr_time,
+                                                  BatchWorkspace &workspace, ThreadPool &pool){
+
+    workspace.reset(matrix, rhs, num_threads);
+    int n = matrix.size();
+    int chunk = n / num_threads;
+    int iteration = 0;
+    bool finished = workspace.active == 0 || K <= 0;
+
+    // function called by the barrier each time the threads synchronize: the columns retire here, while no thread is
+    // reading the variables
+    auto on_completion = [&]() noexcept {
+        iteration++;
+        finished = workspace.retire_columns(num_threads, iteration, tolerance, iteration == K);
+    };
+
+    std::barrier ba(num_threads, on_completion);
+
+    auto body = [&](int tid) { // function executed by a single thread
+
+        int start = tid * chunk;
+        int end = tid != num_threads - 1 ? start + chunk : n;
+        while (!finished) {
+            batch_sweep(matrix, start, end, workspace, tid);
+            ba.arrive_and_wait();
+        }
+    };
+
+    string timer = "PARALLEL BATCHED " + to_string(num_threads) + " threads ";
+    {
+        utimer thr = utimer(timer, &thr_time);
+        pool.run(num_threads, body);
+    }
+    workspace.print_retired(tolerance);
+    return workspace.solutions;
+}
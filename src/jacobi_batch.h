@@ -0,0 +1,155 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include "matrix.h"
+#include "thread_pool.h"
+using namespace std;
+
+
+/*!
+ * Signature of the row kernel of the batched engines: it computes the dot products of the i-th row of the matrix
+ * (diagonal excluded) with the m interleaved iterates of the active columns.
+ */
+typedef void (*batch_dot_function)(const float *row, const float *variables, int m, int i, int n, float *sums);
+
+
+/*!
+ * The following function returns the best variant of the batched row kernel supported by the CPU.
+ * @return kernel [batch_dot_function] := pointer to the variant
+ */
+batch_dot_function batch_kernel();
+
+
+/*!
+ * The following structure stores the partial sums of the stopping criteria computed by a single worker, one for each
+ * active column of the batch. It is aligned to the cache line, so that two workers never write on the same line.
+ */
+struct alignas(CACHE_LINE) BatchPartial {
+    vector<double> difference; // sum of (current[i] - previous[i])^2 over the rows of the worker, for each column
+    vector<double> norm; // sum of current[i]^2 over the rows of the worker, for each column
+    vector<float> sums; // dot products of the row being computed, for each column (scratch of the worker)
+};
+
+
+/*!
+ * The following structure stores the buffers used to solve a linear system with many right-hand sides at the same
+ * time. The iterates of the columns still active are interleaved (the element (i, c) is at i * active + c), so that
+ * each element of the matrix is loaded once and multiplied by the i-th variable of every column. When a column meets
+ * the tolerance its solution is copied out and the remaining columns are compacted, so the converged columns are not
+ * computed anymore.
+ */
+struct BatchWorkspace {
+    int n = 0; // dimension of the linear system
+    int active = 0; // number of columns still iterating
+    vector<int> columns; // original index of each active column
+    vector<float> curr_variables; // n x active solution computed at the current iteration
+    vector<float> prev_variables; // n x active solution computed at the previous iteration
+    vector<float> knownTerms; // n x active right-hand sides of the active columns
+    vector<float> inverse_diagonal; // reciprocals of the elements on the diagonal of the matrix
+    vector<BatchPartial> partials; // partial sums of the stopping criteria, one for each worker
+    vector<vector<float>> solutions; // solution of each column, filled when the column retires
+    vector<int> iterations; // number of iterations computed by each column
+    vector<double> similarities; // stopping criteria of each column when it met the tolerance, -1 if it did not
+    batch_dot_function kernel = nullptr; // row kernel, selected by reset
+
+    /*!
+     * The following function prepares the buffers for a new solve.
+     * @param matrix [Matrix] := matrix A of the linear system (AX=B)
+     * @param rhs [vector<vector<float>>] := the m right-hand sides (columns of B)
+     * @param workers [int] := number of workers that compute the rows
+     */
+    void reset(const Matrix &matrix, const vector<vector<float>> &rhs, int workers);
+
+    /*!
+     * The following function combines the partial sums of the workers and retires the columns whose stopping criteria
+     * ||(current - previous)|| / ||current|| is not larger than the tolerance (or all the columns if it is the last
+     * iteration). The partial sums are cleared for the next iteration.
+     * @param workers [int] := number of workers whose partial sums must be combined
+     * @param iteration [int] := number of iterations computed so far
+     * @param tolerance [double] := tolerance of the stopping criteria (disabled if smaller than 0)
+     * @param last [bool] := true if it is the last iteration allowed
+     * @return finished [bool] := true if all the columns have retired
+     */
+    bool retire_columns(int workers, int iteration, double tolerance, bool last);
+
+    /*!
+     * The following function prints the iteration at which each column met the tolerance, after the timed solve.
+     * @param tolerance [double] := tolerance of the stopping criteria
+     */
+    void print_retired(double tolerance) const;
+};
+
+
+/*!
+ * The following function computes one sweep of the Jacobi's Algorithm on the rows in [first, last) for all the active
+ * columns of the batch. The element A[i][j] is loaded once for every group of columns computed by the kernel instead of
+ * once for every column.
+ * @param matrix [Matrix] := matrix A of the linear system (AX=B)
+ * @param first [int] := first row to compute
+ * @param last [int] := row after the last one to compute
+ * @param workspace [BatchWorkspace] := buffers of the batch
+ * @param worker [int] := index of the worker, whose partial sums are updated
+ */
+inline void batch_sweep(const Matrix &matrix, int first, int last, BatchWorkspace &workspace, int worker){
+
+    int n = workspace.n;
+    int m = workspace.active;
+    const float *prev_variables = workspace.prev_variables.data();
+    float *curr_variables = workspace.curr_variables.data();
+    BatchPartial &partial = workspace.partials[worker];
+    float *sums = partial.sums.data();
+    double *difference = partial.difference.data();
+    double *norm = partial.norm.data();
+
+    batch_dot_function kernel = workspace.kernel;
+
+    for(int i = first; i < last; i++){
+        kernel(matrix[i], prev_variables, m, i, n, sums);
+        const float *knownTerms = workspace.knownTerms.data() + (size_t) i * m;
+        const float *previous = prev_variables + (size_t) i * m;
+        float *current = curr_variables + (size_t) i * m;
+        float inverse_diagonal = workspace.inverse_diagonal[i];
+        for(int c = 0; c < m; c++){
+            float variable = (knownTerms[c] - sums[c]) * inverse_diagonal;
+            float delta = variable - previous[c];
+            difference[c] += delta * delta;
+            norm[c] += variable * variable;
+            current[c] = variable;
+        }
+    }
+}
+
+/*!
+ * The following function computes the sequential version of the Jacobi's Algorithm for many right-hand sides at the
+ * same time: the columns are iterated together and each of them stops independently when it meets the tolerance.
+ * @param matrix [Matrix] := matrix A of the linear system (AX=B)
+ * @param rhs [vector<vector<float>>] := the m right-hand sides (columns of B)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm
+ * @param tolerance [double] := tolerance used to stop earlier each column and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param seq_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [BatchWorkspace] := buffers used during the computation
+ * @return solutions [const vector<vector<float>> &] := reference to the solutions stored in the workspace
+ */
+const vector<vector<float>> &sequential_jacobi_batch(const Matrix &matrix, const vector<vector<float>> &rhs, int K,
+                                                     double tolerance, long &seq_time, BatchWorkspace &workspace);
+
+
+/*!
+ * The following function computes the parallel version of the Jacobi's Algorithm for many right-hand sides at the
+ * same time using the native threads implementation: each thread computes a block of rows for all the active
+ * columns and the columns retire at the barrier.
+ * @param matrix [Matrix] := matrix A of the linear system (AX=B)
+ * @param rhs [vector<vector<float>>] := the m right-hand sides (columns of B)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier each column and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param thr_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [BatchWorkspace] := buffers used during the computation
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
+ * @return solutions [const vector<vector<float>> &] := reference to the solutions stored in the workspace
+ */
+const vector<vector<float>> &threads_jacobi_batch(const Matrix &matrix, const vector<vector<float>> &rhs, int K,
+                                                  int num_threads, double tolerance, long &thr_time,
+                                                  BatchWorkspace &workspace, ThreadPool &pool);
@@ -1,29 +1,121 @@
 #include <vector>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <memory>
 #include <ff/ff.hpp>
 #include <ff/parallel_for.hpp>
 #include "utimer.cpp"
 #include "utility.h"
+#include "row_kernel.h"
 #include "jacobi_ff.h"
+#include "trace.h"
+#include "convergence.h"
 
 
+#define SPARSE_BLOCKS_PER_THREAD 4 // blocks of the sparse matrix for each worker, scheduled dynamically
+#define GRAIN_SAMPLES 3 // iterations measured for each grain tried by the tuner
+#define MIN_GRAIN 8 // smallest grain tried by the tuner
+
+
+/*!
+ * The following class tunes the grain of the ParallelFor while the Jacobi's Algorithm runs: it starts from the static
+ * grain n / num_threads and halves it as long as the measured iterations get faster, then it keeps the fastest grain.
+ * The iterations used to measure the grains are the ones of the solve, so the tuning costs no extra sweep.
+ */
+class GrainTuner {
+
+private:
+    long grain; // grain of the next iteration
+    long best_grain; // fastest grain measured so far
+    double best_time = INFINITY; // average nanoseconds of an iteration with best_grain
+    double accumulated = 0; // nanoseconds of the iterations measured with grain
+    int samples = -1; // iterations measured with grain, the first one is not measured since it wakes up the workers
+    bool settled; // true when the grain does not change anymore
+    int measured = 0; // iterations used for the tuning
+
+public:
+
+    /*!
+     * @param n [int] := dimension of the linear system
+     * @param num_threads [int] := number of workers of the ParallelFor
+     * @param requested [int] := grain of FastFlowOptions: FF_GRAIN_AUTO to tune it, 0 for n / num_threads
+     */
+    GrainTuner(int n, int num_threads, int requested){
+        grain = requested > 0 ? requested : max(1, n / num_threads);
+        best_grain = grain;
+        settled = requested != FF_GRAIN_AUTO;
+    }
+
+    /*!
+     * @return grain [long] := grain of the next iteration
+     */
+    long current() const { return grain; }
+
+    /*!
+     * @return settled [bool] := true if the grain does not change anymore
+     */
+    bool is_settled() const { return settled; }
+
+    /*!
+     * @return measured [int] := iterations used for the tuning
+     */
+    int iterations() const { return measured; }
+
+    /*!
+     * The following function records the time of an iteration computed with the current grain, and chooses the grain
+     * of the next iteration.
+     * @param nanoseconds [double] := time of the iteration
+     */
+    void record(double nanoseconds){
+
+        if(settled){
+            return;
+        }
+        measured++;
+        if(samples++ < 0){
+            return;
+        }
+        accumulated += nanoseconds;
+        if(samples < GRAIN_SAMPLES){
+            return;
+        }
+        double average = accumulated / samples;
+        if(average < best_time){
+            best_time = average;
+            best_grain = grain;
+        }
+        if(average > best_time || grain / 2 < MIN_GRAIN){ // the smaller grains only add scheduling overhead
+            grain = best_grain;
+            settled = true;
+            return;
+        }
+        grain /= 2;
+        samples = 0;
+        accumulated = 0;
+    }
+};
+
 /*!
  * The following function is called from fast_flow_jacobi and it is called only if the tolerance input in
  * fast_flow_jacobi is disabled (smaller than 0). Even if it is redundant I adopted this choice in order to avoid
  * at each step the comparison
- * @param matrix [vector<vector<float>>] := matrix A of the linear system (Ax=b)
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
  * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
  * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
  * @param num_threads [int] := number of threads used to parallelize
  * @param ff_time [long] := value passed by reference in which it will be stored the computation time of the FastFlow
  * implementation
- * @return solution [vector<float>] := solution vector that best approximates the linear system Ax=b.
+ * @param workspace [JacobiWorkspace] := buffers used during the computation, the solution is stored in curr_variables
  */
-vector<float> ff_jacobi(vector<vector<float>> matrix, const vector<float> knownTerm, int K, int num_threads,
-                        long &ff_time){
+template <typename DenseMatrix>
+static void ff_jacobi(const DenseMatrix &matrix, const vector<float> &knownTerm, int K, int num_threads,
+                      long &ff_time, JacobiWorkspace &workspace){
 
     int n = knownTerm.size();
-    vector<float> curr_variables(n, 0.0);
-    vector<float> prev_variables(n, 0.0);
+    vector<float> &curr_variables = workspace.curr_variables;
+    vector<float> &prev_variables = workspace.prev_variables;
+    const vector<float> &inverse_diagonal = workspace.inverse_diagonal;
     ff::ParallelFor pf(num_threads);
     int chunk = n/num_threads;
 
@@ -31,28 +123,165 @@ vector<float> ff_jacobi(vector<vector<float>> matrix, const vector<float> knownT
     {
         utimer ff = utimer(timer, &ff_time);
         for (int k = 0; k < K; k++) {
+            swap(prev_variables, curr_variables); // the last solution becomes the previous one without copying it
+            workspace.iterations++;
             pf.parallel_for(0, n, 1, chunk, [&](ulong i){
-                float sum = 0;
-                for(int j = 0; j < n; j++){
-                    if(i != j){
-                        sum += matrix[i][j] * prev_variables[j];
-                    }
-                }
-                curr_variables[i] = (knownTerm[i] - sum) / matrix[i][i];
+                curr_variables[i] = jacobi_row(matrix, i, prev_variables.data(), knownTerm[i], inverse_diagonal[i]);
             }, num_threads);
-            {
-                utimer copy = utimer("Copy time");
-                prev_variables = curr_variables;
+        }
+    }
+}
+
+/*!
+ * The following function compute the Jacobi's Algorithm using the FastFlow implementation which uses the ParallelFor
+ * class in order to parallelize in the best way the code. The inputs are:
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param ff_time [long] := value passed by reference in which it will be stored the computation time of the FastFlow
+ * implementation
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param tiling [Tiling] := tiles of the cache-blocked sweep, the sweep is not tiled if tiling.columns is 0
+ * @param options [FastFlowOptions] := grain of the chunks and waiting policy of the workers
+ * @param tracer [Tracer *] := timeline of the chunks computed by the workers, nullptr if it is not recorded
+ * @param convergence [Convergence] := stopping criteria and cadence of its checks
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+template <typename DenseMatrix>
+static const vector<float> &fast_flow_solve(const DenseMatrix &matrix, const vector<float> &knownTerm, int K,
+                                            int num_threads, double tolerance, long &ff_time,
+                                            JacobiWorkspace &workspace, const Tiling &tiling,
+                                            const FastFlowOptions &options, Tracer *tracer,
+                                            const Convergence &convergence){
+
+    int n = knownTerm.size();
+    workspace.reset(matrix);
+
+    // it avoids to check the if statement when the tolerance is not used
+    if(tolerance < 0 && tiling.columns == 0 && options.grain == 0 && !options.spin && tracer == nullptr){
+        ff_jacobi(matrix, knownTerm, K, num_threads, ff_time, workspace);
+        return workspace.curr_variables;
+    }
+
+    vector<float> &curr_variables = workspace.curr_variables;
+    vector<float> &prev_variables = workspace.prev_variables;
+    const vector<float> &inverse_diagonal = workspace.inverse_diagonal;
+    vector<ConvergencePartial> &partials = workspace.partials;
+    // only one of the two is used: with spin the workers are kept hot between the iterations and the partial sums are
+    // combined by the reduction of FastFlow instead of the serial loop
+    unique_ptr<ff::ParallelFor> pf = options.spin ? nullptr : make_unique<ff::ParallelFor>(num_threads);
+    unique_ptr<ff::ParallelForReduce<ConvergencePartial>> pfr =
+            options.spin ? make_unique<ff::ParallelForReduce<ConvergencePartial>>(num_threads, true) : nullptr;
+    GrainTuner tuner(n, num_threads, options.grain);
+    StoppingCriterion criterion = convergence.criterion;
+    ConvergenceMonitor monitor(convergence, tolerance);
+    long double similarity;
+    int stopped = -1;
+
+    partials.resize(num_threads);
+
+    int k;
+    bool check; // true if the stopping criteria of the iteration k is checked
+    // function that computes the rows in [start, end) and accumulates their stopping criteria in the partial sums
+    auto sweep = [&](long start, long end, ConvergencePartial &partial, int thid) {
+        long chunk_start = tracer != nullptr ? tracer->now() : 0;
+        if (tiling.columns > 0) { // the rows are computed in blocks that reuse each tile of the variables
+            tiled_sweep(matrix, start, end, prev_variables.data(), curr_variables.data(), knownTerm.data(),
+                        inverse_diagonal.data(), tiling, partial, criterion);
+        }
+        else if (check) {
+            ConvergencePartial rows;
+            for (long i = start; i < end; i++) {
+                float variable = jacobi_row(matrix, i, prev_variables.data(), knownTerm[i], inverse_diagonal[i]);
+                accumulate_row(rows, criterion, variable, prev_variables[i], knownTerm[i], inverse_diagonal[i]);
+                curr_variables[i] = variable;
+            }
+            merge_partial(partial, rows, criterion);
+        }
+        else {
+            for (long i = start; i < end; i++) {
+                curr_variables[i] = jacobi_row(matrix, i, prev_variables.data(), knownTerm[i], inverse_diagonal[i]);
+            }
+        }
+        if (tracer != nullptr) { // each worker of FastFlow writes the track of its index
+            tracer->record(thid, TracePhase::COMPUTE, k, chunk_start, tracer->now());
+        }
+    };
+
+    string timer = "FASTFLOW " + to_string(num_threads) + " threads ";
+    if (tracer != nullptr) {
+        tracer->start(timer, num_threads);
+    }
+    {
+        utimer seq = utimer(timer, &ff_time);
+        for (k = 0; k < K; k++) {
+            swap(prev_variables, curr_variables); // the last solution becomes the previous one without copying it
+            workspace.iterations++;
+            auto iteration_start = chrono::steady_clock::now();
+            long grain = tuner.current();
+            check = monitor.due(k);
+            ConvergencePartial total;
+            long serial_start = 0; // the serial part of the iteration starts when the workers are done
+            if (options.spin) {
+                pfr->parallel_reduce_idx(total, ConvergencePartial(), 0, n, 1, grain,
+                                         [&](const long start, const long end, const int thid,
+                                             ConvergencePartial &partial){
+                    sweep(start, end, partial, thid);
+                }, [&](ConvergencePartial &sum, const ConvergencePartial &partial){
+                    merge_partial(sum, partial, criterion);
+                }, num_threads);
+                serial_start = tracer != nullptr ? tracer->now() : 0;
+            }
+            else {
+                for (int t = 0; t < num_threads; t++) {
+                    partials[t] = ConvergencePartial();
+                }
+                // each worker accumulates the stopping criteria of its rows, so only the partial sums are combined
+                pf->parallel_for_idx(0, n, 1, grain, [&](const long start, const long end, const int thid){
+                    sweep(start, end, partials[thid], thid);
+                }, num_threads);
+                serial_start = tracer != nullptr ? tracer->now() : 0;
+                for (int t = 0; t < num_threads; t++) {
+                    merge_partial(total, partials[t], criterion);
+                }
+            }
+            if (!tuner.is_settled()) {
+                tuner.record(chrono::duration<double, nano>(chrono::steady_clock::now() - iteration_start).count());
+            }
+            bool converged = false;
+            if (check) {
+                workspace.checks++;
+                similarity = criterion_value(total, criterion);
+                converged = monitor.converged(k, similarity);
+            }
+            if (tracer != nullptr) {
+                tracer->record(num_threads, TracePhase::COMPLETION, k, serial_start, tracer->now());
+            }
+            if (converged){
+                stopped = k; // the message is printed after the timed region
+                break;
             }
         }
     }
+    if (stopped >= 0) {
+        cout << stopped << ")FastFlow Jacobi interrupted because " << similarity << " (" << criterion_name(criterion) <<
+             ") <= " << tolerance << " (tolerance)" << endl;
+    }
+    if (options.grain == FF_GRAIN_AUTO) {
+        cout << "GRAIN: " << tuner.current() << " rows (" << (tuner.is_settled() ? "tuned in " : "still tuning after ")
+             << tuner.iterations() << " iterations)" << endl;
+    }
     return curr_variables;
 }
 
+
 /*!
  * The following function compute the Jacobi's Algorithm using the FastFlow implementation which uses the ParallelFor
  * class in order to parallelize in the best way the code. The inputs are:
- * @param matrix [vector<vector<float>>] := matrix A of the linear system (Ax=b)
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
  * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
  * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
  * @param num_threads [int] := number of threads used to parallelize
@@ -60,44 +289,279 @@ vector<float> ff_jacobi(vector<vector<float>> matrix, const vector<float> knownT
  * stopping criteria ||(current - previous)|| / ||current||
  * @param ff_time [long] := value passed by reference in which it will be stored the computation time of the FastFlow
  * implementation
- * @return solution [vector<float>] := solution vector that best approximates the linear system Ax=b.
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param tiling [Tiling] := tiles of the cache-blocked sweep, the sweep is not tiled if tiling.columns is 0
+ * @param options [FastFlowOptions] := grain of the chunks and waiting policy of the workers
+ * @param tracer [Tracer *] := timeline of the chunks computed by the workers, nullptr (default) if it is not recorded
+ * @param convergence [Convergence] := stopping criteria and cadence of its checks, the increment at every iteration
+ * by default
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
  */
-vector<float> fast_flow_jacobi(vector<vector<float>> matrix, const vector<float> knownTerm, int K, int num_threads,
-                             double tolerance, long &ff_time){
+const vector<float> &fast_flow_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, int num_threads,
+                                      double tolerance, long &ff_time, JacobiWorkspace &workspace,
+                                      const Tiling &tiling, const FastFlowOptions &options, Tracer *tracer,
+                                      const Convergence &convergence){
+    return fast_flow_solve(matrix, knownTerm, K, num_threads, tolerance, ff_time, workspace, tiling, options, tracer,
+                           convergence);
+}
+
+
+const vector<float> &fast_flow_jacobi(const PrecisionMatrix &matrix, const vector<float> &knownTerm, int K,
+                                      int num_threads, double tolerance, long &ff_time, JacobiWorkspace &workspace,
+                                      const Tiling &tiling, const FastFlowOptions &options, Tracer *tracer,
+                                      const Convergence &convergence){
+    return fast_flow_solve(matrix, knownTerm, K, num_threads, tolerance, ff_time, workspace, tiling, options, tracer,
+                           convergence);
+}
 
-    if(tolerance < 0){ // it avoids to check the if statement when the tolerance is not used
-        return ff_jacobi(matrix, knownTerm, K, num_threads, ff_time);
+
+/*!
+ * The following function parses a grain given on the command line.
+ * @param text [string] := "auto" or the number of rows of each chunk
+ * @return grain [int] := FF_GRAIN_AUTO or the number of rows (>= 1)
+ * @throw invalid_argument if the text is not a valid grain
+ */
+int parse_grain(const string &text){
+
+    if(text == "auto"){
+        return FF_GRAIN_AUTO;
+    }
+    int grain;
+    size_t end = 0;
+    try{
+        grain = stoi(text, &end);
     }
+    catch(const exception &){
+        grain = 0;
+    }
+    if(grain < 1 || end != text.size()){
+        throw invalid_argument("The grain '" + text + "' is not valid: it must be auto or a number of rows >= 1");
+    }
+    return grain;
+}
 
 
-    int n = knownTerm.size();
-    vector<float> curr_variables(n, 0.0);
-    vector<float> prev_variables(n, 0.0);
+/*!
+ * The following function compute the Jacobi's Algorithm using the FastFlow implementation which uses the ParallelFor
+ * class in order to parallelize in the best way the code. The inputs are:
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param ff_time [long] := value passed by reference in which it will be stored the computation time of the FastFlow
+ * implementation
+ * @return solution [vector<float>] := solution vector that best approximates the linear system Ax=b.
+ */
+vector<float> fast_flow_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, int num_threads,
+                               double tolerance, long &ff_time){
+
+    JacobiWorkspace workspace;
+    fast_flow_jacobi(matrix, knownTerm, K, num_threads, tolerance, ff_time, workspace);
+    return std::move(workspace.curr_variables);
+}
+
+
+/*!
+ * The following function compute the Jacobi's Algorithm on a sparse matrix using the FastFlow implementation.
+ * @param matrix [SparseMatrix] := sparse matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm (disabled if smaller than 0)
+ * @param ff_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+template <typename SparseMatrix>
+static const vector<float> &ff_sparse_jacobi(const SparseMatrix &matrix, const vector<float> &knownTerm, int K,
+                                             int num_threads, double tolerance, long &ff_time,
+                                             JacobiWorkspace &workspace){
+
+    workspace.reset(matrix.diagonal);
+    vector<float> &curr_variables = workspace.curr_variables;
+    vector<float> &prev_variables = workspace.prev_variables;
+    const vector<float> &inverse_diagonal = workspace.inverse_diagonal;
+    vector<ConvergencePartial> &partials = workspace.partials;
+    int blocks = num_threads * SPARSE_BLOCKS_PER_THREAD;
+    vector<int> bounds = sparse_split(matrix, blocks);
     ff::ParallelFor pf(num_threads);
     long double similarity;
-    int chunk = n / num_threads;
+    int stopped = -1;
+
+    partials.resize(num_threads);
 
     string timer = "FASTFLOW " + to_string(num_threads) + " threads ";
     {
-        utimer seq = utimer(timer, &ff_time);
+        utimer ff = utimer(timer, &ff_time);
         for (int k = 0; k < K; k++) {
-            pf.parallel_for(0, n, 1, chunk, [&](ulong i){
-                float sum = 0;
-                for(int j = 0; j < n; j++){
-                    if(i != j){
-                        sum += matrix[i][j] * prev_variables[j];
-                    }
+            swap(prev_variables, curr_variables); // the last solution becomes the previous one without copying it
+            for (int t = 0; t < num_threads; t++) {
+                partials[t] = ConvergencePartial();
+            }
+            pf.parallel_for_idx(0, blocks, 1, 1, [&](const long start, const long end, const int thid){
+                for (long block = start; block < end; block++) {
+                    sparse_sweep(matrix, bounds[block], bounds[block + 1], prev_variables.data(),
+                                 curr_variables.data(), knownTerm.data(), inverse_diagonal.data(), &partials[thid]);
                 }
-                curr_variables[i] = (knownTerm[i] - sum) / matrix[i][i];
             }, num_threads);
-            similarity = stopping_criteria(curr_variables, prev_variables);
-            if (similarity <= tolerance){
-                cout << k <<")FastFlow Jacobi interrupted because " << similarity << " (similarity) <= " <<
-                tolerance << " (tolerance)" << endl;
-                break;
+            if (tolerance >= 0) {
+                similarity = combine_partials(partials, num_threads);
+                if (similarity <= tolerance){
+                    stopped = k; // the message is printed after the timed region
+                    break;
+                }
             }
-            prev_variables = curr_variables;
         }
     }
+    if (stopped >= 0) {
+        cout << stopped << ")FastFlow Jacobi interrupted because " << similarity << " (" <<
+             criterion_name(StoppingCriterion::INCREMENT) << ") <= " << tolerance << " (tolerance)" << endl;
+    }
     return curr_variables;
 }
+
+
+/*!
+ * The following function compute the Jacobi's Algorithm on a sparse matrix using the FastFlow implementation. The work
+ * units are grouped in blocks with about the same number of non-zero elements, which are scheduled dynamically on the
+ * workers of the ParallelFor.
+ * @param matrix [CSRMatrix or SellMatrix] := sparse matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param ff_time [long] := value passed by reference in which it will be stored the computation time of the FastFlow
+ * implementation
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &fast_flow_sparse_jacobi(const CSRMatrix &matrix, const vector<float> &knownTerm, int K,
+                                             int num_threads, double tolerance, long &ff_time,
+                                             JacobiWorkspace &workspace){
+    return ff_sparse_jacobi(matrix, knownTerm, K, num_threads, tolerance, ff_time, workspace);
+}
+
+
+const vector<float> &fast_flow_sparse_jacobi(const SellMatrix &matrix, const vector<float> &knownTerm, int K,
+                                             int num_threads, double tolerance, long &ff_time,
+                                             JacobiWorkspace &workspace){
+    return ff_sparse_jacobi(matrix, knownTerm, K, num_threads, tolerance, ff_time, workspace);
+}
+
+
+/*!
+ * The following function compute the Jacobi's Algorithm for many right-hand sides at the same time using the FastFlow
+ * implementation: each chunk of rows is computed for all the active columns and the columns retire independently when
+ * they meet the tolerance.
+ * @param matrix [Matrix] := matrix A of the linear system (AX=B)
+ * @param rhs [vector<vector<float>>] := the m right-hand sides (columns of B)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier each column and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param ff_time [long] := value passed by reference in which it will be stored the computation time of the FastFlow
+ * implementation
+ * @param workspace [BatchWorkspace] := buffers used during the computation
+ * @return solutions [const vector<vector<float>> &] := reference to the solutions stored in the workspace
+ */
+const vector<vector<float>> &fast_flow_jacobi_batch(const Matrix &matrix, const vector<vector<float>> &rhs, int K,
+                                                    int num_threads, double tolerance, long &ff_time,
+                                                    BatchWorkspace &workspace){
+
+    workspace.reset(matrix, rhs, num_threads);
+    int n = matrix.size();
+    int chunk = n / num_threads;
+    ff::ParallelFor pf(num_threads);
+
+    string timer = "FASTFLOW BATCHED " + to_string(num_threads) + " threads ";
+    {
+        utimer ff = utimer(timer, &ff_time);
+        for (int k = 0; k < K && workspace.active > 0; k++) {
+            pf.parallel_for_idx(0, n, 1, chunk, [&](const long start, const long end, const int thid){
+                batch_sweep(matrix, start, end, workspace, thid);
+            }, num_threads);
+            workspace.retire_columns(num_threads, k + 1, tolerance, k == K - 1);
+        }
+    }
+    workspace.print_retired(tolerance);
+    return workspace.solutions;
+}
+
+
+/*!
+ * The following function compute a relaxation method with the multicolor ordering using the FastFlow implementation.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm (disabled if smaller than 0)
+ * @param ff_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param relaxation [Relaxation] := method and its parameters
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+template <typename DenseMatrix>
+static const vector<float> &ff_relaxation(const DenseMatrix &matrix, const vector<float> &knownTerm, int K,
+                                          int num_threads, double tolerance, long &ff_time,
+                                          JacobiWorkspace &workspace, const Relaxation &relaxation){
+
+    int n = knownTerm.size();
+    workspace.reset(matrix);
+    int colors = relaxation.colors;
+    float omega = relaxation.method == RelaxationMethod::GAUSS_SEIDEL ? 1.0f : (float) relaxation.omega;
+    vector<ConvergencePartial> &partials = workspace.partials;
+    ff::ParallelFor pf(num_threads);
+    long double similarity;
+    int stopped = -1;
+
+    partials.resize(num_threads);
+
+    string timer = "FASTFLOW " + relaxation_name(relaxation.method) + " " + to_string(num_threads) + " threads ";
+    {
+        utimer ff = utimer(timer, &ff_time);
+        for (int k = 0; k < K; k++) {
+            swap(workspace.prev_variables, workspace.curr_variables);
+            for (int t = 0; t < num_threads; t++) {
+                partials[t] = ConvergencePartial();
+            }
+            for (int color = 0; color < colors; color++) {
+                int first = color_start(color, colors, n);
+                int last = color_start(color + 1, colors, n);
+                int chunk = max((last - first) / num_threads, 1);
+                pf.parallel_for_idx(first, last, 1, chunk, [&](const long start, const long end, const int thid){
+                    relaxation_sweep(matrix, start, end, first, knownTerm, workspace, omega, partials[thid]);
+                }, num_threads);
+            }
+            if (tolerance >= 0) {
+                similarity = combine_partials(partials, num_threads);
+                if (similarity <= tolerance){
+                    stopped = k; // the message is printed after the timed region
+                    break;
+                }
+            }
+        }
+    }
+    if (stopped >= 0) {
+        cout << stopped << ")FastFlow " << relaxation_name(relaxation.method) << " interrupted because " <<
+             similarity << " (" << criterion_name(StoppingCriterion::INCREMENT) << ") <= " << tolerance <<
+             " (tolerance)" << endl;
+    }
+    return workspace.curr_variables;
+}
+
+
+const vector<float> &fast_flow_relaxation(const Matrix &matrix, const vector<float> &knownTerm, int K,
+                                          int num_threads, double tolerance, long &ff_time,
+                                          JacobiWorkspace &workspace, const Relaxation &relaxation){
+    return ff_relaxation(matrix, knownTerm, K, num_threads, tolerance, ff_time, workspace, relaxation);
+}
+
+
+const vector<float> &fast_flow_relaxation(const PrecisionMatrix &matrix, const vector<float> &knownTerm, int K,
+                                          int num_threads, double tolerance, long &ff_time,
+                                          JacobiWorkspace &workspace, const Relaxation &relaxation){
+    return ff_relaxation(matrix, knownTerm, K, num_threads, tolerance, ff_time, workspace, relaxation);
+}
@@ -1,10 +1,33 @@
+#pragma once
 #include <vector>
+#include <string>
+#include "matrix.h"
+#include "jacobi_workspace.h"
+#include "tiling.h"
+#include "trace.h"
+#include "convergence.h"
+#include "sparse_matrix.h"
+#include "jacobi_batch.h"
+#include "jacobi_relaxation.h"
 using namespace std;
 
+
+#define FF_GRAIN_AUTO -1 // grain of FastFlowOptions tuned at runtime from the measured iterations
+
+
+/*!
+ * The following structure describes how the FastFlow engine schedules the rows of the dense Jacobi's Algorithm.
+ */
+struct FastFlowOptions {
+    int grain = 0; // rows of each chunk: 0 for n / num_threads, FF_GRAIN_AUTO to tune it from the measured iterations
+    bool spin = false; // the workers spin between iterations, and the stopping criteria is reduced by ParallelForReduce
+};
+
+
 /*!
  * The following function compute the Jacobi's Algorithm using the FastFlow implementation which uses the ParallelFor
  * class in order to parallelize in the best way the code. The inputs are:
- * @param matrix [vector<vector<float>>] := matrix A of the linear system (Ax=b)
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
  * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
  * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
  * @param num_threads [int] := number of threads used to parallelize
@@ -14,5 +37,113 @@ using namespace std;
  * implementation
  * @return solution [vector<float>] := solution vector that best approximates the linear system Ax=b.
  */
-vector<float> fast_flow_jacobi(vector<vector<float>> matrix, vector<float> knownTerm, int K, int num_threads,
-                             double tolerance, long &ff_time);
+vector<float> fast_flow_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, int num_threads,
+                               double tolerance, long &ff_time);
+
+
+/*!
+ * The following function compute the Jacobi's Algorithm using the FastFlow implementation and the buffers of the
+ * workspace given as input, so that no vector is allocated if the workspace has already been used for a system of the
+ * same size.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param ff_time [long] := value passed by reference in which it will be stored the computation time of the FastFlow
+ * implementation
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param tiling [Tiling] := tiles of the cache-blocked sweep, the sweep is not tiled if tiling.columns is 0
+ * @param options [FastFlowOptions] := grain of the chunks and waiting policy of the workers
+ * @param tracer [Tracer *] := timeline of the chunks computed by the workers and of the serial part of the iterations,
+ * nullptr (default) if it is not recorded
+ * @param convergence [Convergence] := stopping criteria and cadence of its checks, the increment at every iteration
+ * by default
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &fast_flow_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, int num_threads,
+                                      double tolerance, long &ff_time, JacobiWorkspace &workspace,
+                                      const Tiling &tiling = Tiling(),
+                                      const FastFlowOptions &options = FastFlowOptions(), Tracer *tracer = nullptr,
+                                      const Convergence &convergence = Convergence());
+const vector<float> &fast_flow_jacobi(const PrecisionMatrix &matrix, const vector<float> &knownTerm, int K,
+                                      int num_threads, double tolerance, long &ff_time, JacobiWorkspace &workspace,
+                                      const Tiling &tiling = Tiling(),
+                                      const FastFlowOptions &options = FastFlowOptions(), Tracer *tracer = nullptr,
+                                      const Convergence &convergence = Convergence());
+
+
+/*!
+ * The following function parses a grain given on the command line.
+ * @param text [string] := "auto" or the number of rows of each chunk
+ * @return grain [int] := FF_GRAIN_AUTO or the number of rows (>= 1)
+ * @throw invalid_argument if the text is not a valid grain
+ */
+int parse_grain(const string &text);
+
+
+/*!
+ * The following function compute the Jacobi's Algorithm on a sparse matrix using the FastFlow implementation. The work
+ * units are grouped in blocks with about the same number of non-zero elements, which are scheduled dynamically on the
+ * workers of the ParallelFor.
+ * @param matrix [CSRMatrix or SellMatrix] := sparse matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param ff_time [long] := value passed by reference in which it will be stored the computation time of the FastFlow
+ * implementation
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &fast_flow_sparse_jacobi(const CSRMatrix &matrix, const vector<float> &knownTerm, int K,
+                                             int num_threads, double tolerance, long &ff_time,
+                                             JacobiWorkspace &workspace);
+const vector<float> &fast_flow_sparse_jacobi(const SellMatrix &matrix, const vector<float> &knownTerm, int K,
+                                             int num_threads, double tolerance, long &ff_time,
+                                             JacobiWorkspace &workspace);
+
+
+/*!
+ * The following function compute the Jacobi's Algorithm for many right-hand sides at the same time using the FastFlow
+ * implementation: each chunk of rows is computed for all the active columns and the columns retire independently when
+ * they meet the tolerance.
+ * @param matrix [Matrix] := matrix A of the linear system (AX=B)
+ * @param rhs [vector<vector<float>>] := the m right-hand sides (columns of B)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier each column and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param ff_time [long] := value passed by reference in which it will be stored the computation time of the FastFlow
+ * implementation
+ * @param workspace [BatchWorkspace] := buffers used during the computation
+ * @return solutions [const vector<vector<float>> &] := reference to the solutions stored in the workspace
+ */
+const vector<vector<float>> &fast_flow_jacobi_batch(const Matrix &matrix, const vector<vector<float>> &rhs, int K,
+                                                    int num_threads, double tolerance, long &ff_time,
+                                                    BatchWorkspace &workspace);
+
+
+/*!
+ * The following function compute a relaxation method with the multicolor ordering using the FastFlow implementation:
+ * the rows of each color are computed by a ParallelFor, so the workers synchronize after each color.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param ff_time [long] := value passed by reference in which it will be stored the computation time of the FastFlow
+ * implementation
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param relaxation [Relaxation] := method and its parameters
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &fast_flow_relaxation(const Matrix &matrix, const vector<float> &knownTerm, int K,
+                                          int num_threads, double tolerance, long &ff_time,
+                                          JacobiWorkspace &workspace, const Relaxation &relaxation);
+const vector<float> &fast_flow_relaxation(const PrecisionMatrix &matrix, const vector<float> &knownTerm, int K,
+                                          int num_threads, double tolerance, long &ff_time,
+                                          JacobiWorkspace &workspace, const Relaxation &relaxation);
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include "utimer.cpp"
+#include "jacobi_generic.h"
+using namespace std;
+
+
+// the unrolled engine is evaluated at compile time: 4x + y = 5, x + 4y = 5 has the solution x = y = 1
+static_assert([]{
+    GenericSystem<double, 2> system{{4, 1, 1, 4}, {5, 5}};
+    GenericWorkspace<double, 2> workspace;
+    array<double, 2> variables{};
+    workspace.reset(system, variables);
+    generic_jacobi(system, workspace, variables, 100, 1e-12);
+    return variables[0] > 0.999999 && variables[0] < 1.000001 && variables[1] > 0.999999 && variables[1] < 1.000001;
+}(), "the Jacobi's Algorithm with a fixed extent must be a constant expression");
+
+
+/*!
+ * @return name [string] := name of the scalar type T in the timers
+ */
+template <typename T>
+static string scalar_name(){
+    return sizeof(T) == sizeof(double) ? "double" : "float";
+}
+
+
+/*!
+ * The following function solves a system of dimension N with the unrolled engine: the system is copied in arrays of
+ * T, so the variables of the sweep can be kept in registers.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b), of dimension N
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param tolerance [double] := tolerance of the stopping criteria, disabled if smaller than 0
+ * @param time [long] := value passed by reference in which it will be stored the computation time
+ * @param solution [vector<T>] := vector where the solution is stored
+ * @return iterations [int] := number of iterations computed
+ */
+template <typename T, size_t N>
+static int fixed_solve(const Matrix &matrix, const vector<float> &knownTerm, int K, double tolerance, long &time,
+                       vector<T> &solution){
+
+    GenericSystem<T, N> system;
+    for(size_t i = 0; i < N; i++){
+        for(size_t j = 0; j < N; j++){
+            system.matrix[i * N + j] = matrix[i][j];
+        }
+        system.knownTerm[i] = knownTerm[i];
+    }
+    GenericWorkspace<T, N> workspace;
+    array<T, N> variables{};
+    workspace.reset(system, variables);
+    int iterations;
+    {
+        utimer seq = utimer("Sequential Jacobi (" + scalar_name<T>() + ", unrolled " + to_string(N) + ")", &time);
+        iterations = generic_jacobi(system, workspace, variables, K, tolerance);
+    }
+    solution.assign(variables.begin(), variables.end());
+    return iterations;
+}
+
+
+/*!
+ * @return solvers [array] := the unrolled engines of the dimensions from 1 to FIXED_MAX_EXTENT, indexed by the
+ * dimension minus 1
+ */
+template <typename T, size_t... N>
+static constexpr auto fixed_solvers(index_sequence<N...>){
+    return array{&fixed_solve<T, N + 1>...};
+}
+
+
+/*!
+ * The following function computes the Jacobi's Algorithm with the scalar type T on a single precision dense matrix:
+ * the system is converted to T and, if its dimension is at most FIXED_MAX_EXTENT, it is solved by the engine with the
+ * fixed extent equal to the dimension (selected at run time among the instantiations), otherwise by the one with the
+ * dynamic extent. The conversion, the allocation of the buffers and the reciprocals of the diagonal are not timed.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param time [long] := value passed by reference in which it will be stored the computation time
+ * @param iterations [int] := value passed by reference in which it will be stored the number of iterations computed
+ * @return solution [vector<T>] := solution vector that best approximates the linear system Ax=b
+ */
+template <typename T>
+vector<T> sequential_jacobi_as(const Matrix &matrix, const vector<float> &knownTerm, int K, double tolerance,
+                               long &time, int &iterations){
+
+    int n = knownTerm.size();
+    vector<T> solution;
+    if(n <= FIXED_MAX_EXTENT){
+        static constexpr auto solvers = fixed_solvers<T>(make_index_sequence<FIXED_MAX_EXTENT>{});
+        iterations = solvers[n - 1](matrix, knownTerm, K, tolerance, time, solution);
+        return solution;
+    }
+    GenericSystem<T> system;
+    system.n = n;
+    system.matrix.resize((size_t) n * n);
+    system.knownTerm.assign(knownTerm.begin(), knownTerm.end());
+    for(int i = 0; i < n; i++){
+        copy(matrix[i], matrix[i] + n, system.matrix.begin() + (size_t) i * n);
+    }
+    GenericWorkspace<T> workspace;
+    workspace.reset(system, solution);
+    {
+        utimer seq = utimer("Sequential Jacobi (" + scalar_name<T>() + ")", &time);
+        iterations = generic_jacobi(system, workspace, solution, K, tolerance);
+    }
+    return solution;
+}
+
+
+template vector<float> sequential_jacobi_as<float>(const Matrix &, const vector<float> &, int, double, long &, int &);
+template vector<double> sequential_jacobi_as<double>(const Matrix &, const vector<float> &, int, double, long &,
+                                                     int &);
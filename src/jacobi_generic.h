@@ -0,0 +1,176 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <span>
+#include <utility>
+#include <cstddef>
+#include <type_traits>
+#include "matrix.h"
+using namespace std;
+
+
+// largest dimension of the systems solved by the unrolled engine: beyond it the fully unrolled sweep no longer fits in
+// the registers and the SIMD row kernels of the float engines are faster
+#define FIXED_MAX_EXTENT 32
+
+
+/*!
+ * The following structure stores a linear system Ax=b whose elements have the scalar type T. If the extent is known at
+ * compile time the matrix and the vectors are arrays, so a small system can be kept on the stack (and in registers)
+ * and solved in a constant expression; otherwise they are vectors and the dimension is given at run time.
+ */
+template <typename T, size_t Extent = dynamic_extent>
+struct GenericSystem {
+
+    static constexpr bool fixed = Extent != dynamic_extent;
+    using Vector = conditional_t<fixed, array<T, fixed ? Extent : 1>, vector<T>>;
+    using Storage = conditional_t<fixed, array<T, fixed ? Extent * Extent : 1>, vector<T>>;
+
+    Storage matrix{}; // matrix A in row-major order, without padding
+    Vector knownTerm{}; // vector b
+    int n = fixed ? (int) Extent : 0;
+
+    /*!
+     * @return size [int] := dimension of the linear system
+     */
+    constexpr int size() const { return n; }
+};
+
+
+/*!
+ * The following structure stores the buffers of the Jacobi's Algorithm with the scalar type T, so that they are
+ * allocated and the reciprocals of the diagonal are computed before the timed solve.
+ */
+template <typename T, size_t Extent = dynamic_extent>
+struct GenericWorkspace {
+
+    using Vector = typename GenericSystem<T, Extent>::Vector;
+
+    Vector inverse_diagonal{}; // reciprocals of the elements on the diagonal
+    Vector prev_variables{}; // solution computed at the previous iteration
+
+    /*!
+     * The following function sizes the buffers (and the variables) to the dimension of the system, computes the
+     * reciprocals of the diagonal and sets the variables to zero, the initial solution of the other engines.
+     * @param system [GenericSystem<T, Extent>] := linear system Ax=b
+     * @param variables [GenericSystem<T, Extent>::Vector] := vector where the solution will be stored
+     */
+    constexpr void reset(const GenericSystem<T, Extent> &system, Vector &variables){
+
+        int n = system.size();
+        if constexpr(!GenericSystem<T, Extent>::fixed){
+            inverse_diagonal.resize(n);
+            prev_variables.resize(n);
+            variables.resize(n);
+        }
+        for(int i = 0; i < n; i++){
+            inverse_diagonal[i] = T(1) / system.matrix[(size_t) i * n + i];
+            prev_variables[i] = T(0);
+            variables[i] = T(0);
+        }
+    }
+};
+
+
+/*!
+ * The following function computes the dot product of the i-th row of a system with a fixed extent without its diagonal
+ * element: it is a fold expression, so it is fully unrolled and the diagonal element is skipped at compile time.
+ * @param matrix [array<T, N * N>] := matrix A in row-major order
+ * @param variables [array<T, N>] := solution computed at the previous iteration
+ * @return sum [T] := sum of the off-diagonal elements of the i-th row times the variables
+ */
+template <typename T, size_t N, size_t I, size_t... J>
+constexpr T fixed_row_sum(const array<T, N * N> &matrix, const array<T, N> &variables, index_sequence<J...>){
+    return ((J != I ? matrix[I * N + J] * variables[J] : T(0)) + ...);
+}
+
+
+/*!
+ * The following function computes a sweep of the Jacobi's Algorithm on a system with a fixed extent, unrolled over
+ * the rows and the columns.
+ * @param system [GenericSystem<T, N>] := linear system Ax=b
+ * @param inverse_diagonal [array<T, N>] := reciprocals of the elements on the diagonal
+ * @param prev_variables [array<T, N>] := solution computed at the previous iteration
+ * @param curr_variables [array<T, N>] := vector where the new solution is stored
+ */
+template <typename T, size_t N, size_t... I>
+constexpr void fixed_sweep(const GenericSystem<T, N> &system, const array<T, N> &inverse_diagonal,
+                           const array<T, N> &prev_variables, array<T, N> &curr_variables, index_sequence<I...>){
+    ((curr_variables[I] = (system.knownTerm[I] - fixed_row_sum<T, N, I>(system.matrix, prev_variables,
+                                                                        make_index_sequence<N>{})) *
+                          inverse_diagonal[I]), ...);
+}
+
+
+/*!
+ * The following function computes the Jacobi's Algorithm with the scalar type T. With a fixed extent each sweep is
+ * fully unrolled and, since no memory is allocated and the stopping criteria is compared without square roots, the
+ * whole solve can be evaluated at compile time; with a dynamic extent the rows are computed by plain loops.
+ * @param system [GenericSystem<T, Extent>] := linear system Ax=b
+ * @param workspace [GenericWorkspace<T, Extent>] := buffers prepared by reset(system, variables)
+ * @param variables [GenericSystem<T, Extent>::Vector] := vector where the solution is stored, set to zero by the
+ * reset of the workspace
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||, disabled if smaller than 0
+ * @return iterations [int] := number of iterations computed
+ */
+template <typename T, size_t Extent = dynamic_extent>
+constexpr int generic_jacobi(const GenericSystem<T, Extent> &system, GenericWorkspace<T, Extent> &workspace,
+                             typename GenericSystem<T, Extent>::Vector &variables, int K, double tolerance){
+
+    int n = system.size();
+    const auto &inverse_diagonal = workspace.inverse_diagonal;
+    auto &prev_variables = workspace.prev_variables;
+    for(int k = 0; k < K; k++){
+        swap(prev_variables, variables); // the last solution becomes the previous one
+        if constexpr(GenericSystem<T, Extent>::fixed){
+            fixed_sweep(system, inverse_diagonal, prev_variables, variables, make_index_sequence<Extent>{});
+        }
+        else{
+            for(int i = 0; i < n; i++){
+                const T *row = &system.matrix[(size_t) i * n];
+                T sum = 0;
+                for(int j = 0; j < i; j++){
+                    sum += row[j] * prev_variables[j];
+                }
+                for(int j = i + 1; j < n; j++){
+                    sum += row[j] * prev_variables[j];
+                }
+                variables[i] = (system.knownTerm[i] - sum) * inverse_diagonal[i];
+            }
+        }
+        if(tolerance >= 0){ // ||current - previous||^2 <= tolerance^2 ||current||^2, without square roots
+            T difference = 0;
+            T norm = 0;
+            for(int i = 0; i < n; i++){
+                T delta = variables[i] - prev_variables[i];
+                difference += delta * delta;
+                norm += variables[i] * variables[i];
+            }
+            if(difference <= (T) (tolerance * tolerance) * norm){
+                return k + 1;
+            }
+        }
+    }
+    return K;
+}
+
+
+/*!
+ * The following function computes the Jacobi's Algorithm with the scalar type T on a single precision dense matrix:
+ * the system is converted to T and, if its dimension is at most FIXED_MAX_EXTENT, it is solved by the engine with the
+ * fixed extent equal to the dimension (selected at run time among the instantiations), otherwise by the one with the
+ * dynamic extent. The conversion, the allocation of the buffers and the reciprocals of the diagonal are not timed.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param time [long] := value passed by reference in which it will be stored the computation time
+ * @param iterations [int] := value passed by reference in which it will be stored the number of iterations computed
+ * @return solution [vector<T>] := solution vector that best approximates the linear system Ax=b
+ */
+template <typename T>
+vector<T> sequential_jacobi_as(const Matrix &matrix, const vector<float> &knownTerm, int K, double tolerance,
+                               long &time, int &iterations);
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include "row_kernel.h"
+#include "utimer.cpp"
+#include "jacobi_mpi.h"
+#include "convergence.h"
+using namespace std;
+
+
+/*!
+ * The following function generates the rows of a linear system owned by the calling rank. The system is the same as
+ * the one generated by main.out with the same generator and seed, whatever the number of ranks, and the matrix is
+ * never built as a whole: each rank only stores its rows.
+ * @param n [int] := dimension of the linear system
+ * @param generator [MatrixGenerator] := description of the matrix
+ * @param knownTerm [vector<float>] := whole vector b of the linear system (Ax=b)
+ * @param communicator [MPI_Comm] := ranks that share the system
+ * @return system [DistributedSystem] := rows of the system owned by the calling rank
+ */
+DistributedSystem distribute_system(int n, const MatrixGenerator &generator, const vector<float> &knownTerm,
+                                    MPI_Comm communicator){
+
+    int rank, ranks;
+    MPI_Comm_rank(communicator, &rank);
+    MPI_Comm_size(communicator, &ranks);
+
+    DistributedSystem system;
+    system.n = n;
+    system.counts.resize(ranks);
+    system.displacements.resize(ranks);
+    int chunk = n / ranks;
+    for(int r = 0; r < ranks; r++){ // the same partitioning of the native threads engine
+        system.displacements[r] = r * chunk;
+        system.counts[r] = r != ranks - 1 ? chunk : n - r * chunk;
+    }
+    system.start = system.displacements[rank];
+    system.end = system.start + system.counts[rank];
+    int floats_per_line = CACHE_LINE / sizeof(float);
+    system.stride = (n + floats_per_line - 1) / floats_per_line * floats_per_line;
+
+    int count = system.end - system.start;
+    system.rows.resize((size_t) count * system.stride);
+    system.knownTerm.assign(knownTerm.begin() + system.start, knownTerm.begin() + system.end);
+    system.inverse_diagonal.resize(count);
+    for(int i = system.start; i < system.end; i++){
+        float *row = system.rows.data() + (size_t) (i - system.start) * system.stride;
+        generator.generate_row(n, i, row, system.stride);
+        system.inverse_diagonal[i - system.start] = 1.0f / row[i];
+    }
+    return system;
+}
+
+
+/*!
+ * The following function computes the Jacobi's Algorithm on many processes. At each iteration every rank computes its
+ * rows, the new slices of the solution are exchanged with an allgather and the stopping criteria is combined with an
+ * allreduce, so all the ranks stop at the same iteration. With overlap the collectives are non-blocking: while the
+ * slices travel each rank computes the part of the next dot products that only needs its own slice (the columns
+ * [start, end) of its rows), and only the remaining columns are computed after the allgather.
+ * @param system [DistributedSystem] := rows of the system owned by the calling rank
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param distributed_time [long] := value passed by reference in which it will be stored the computation time of the
+ * slowest rank
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param communicator [MPI_Comm] := ranks that share the system
+ * @param overlap [bool] := true to overlap the collectives with the computation, false to use blocking collectives
+ * @return solution [const vector<float> &] := reference to the whole solution vector stored in the workspace, the same
+ * on every rank.
+ */
+const vector<float> &distributed_jacobi(const DistributedSystem &system, int K, double tolerance,
+                                        long &distributed_time, JacobiWorkspace &workspace, MPI_Comm communicator,
+                                        bool overlap){
+
+    int rank, ranks;
+    MPI_Comm_rank(communicator, &rank);
+    MPI_Comm_size(communicator, &ranks);
+    int n = system.n;
+    int start = system.start;
+    int end = system.end;
+    int count = end - start;
+
+    if(K <= 0){
+        K = n;
+        if(rank == 0){
+            cout << "K set to n because it was <= 0" << endl;
+        }
+    }
+    vector<float> &curr_variables = workspace.curr_variables;
+    vector<float> &prev_variables = workspace.prev_variables;
+    curr_variables.assign(n, 0.0);
+    prev_variables.assign(n, 0.0);
+    vector<float> slice(count); // new values of the rows of the rank, sent by the allgather
+    vector<float> local_sums(count, 0.0); // part of the dot products on the columns [start, end), 0 for x = 0
+
+    MPI_Barrier(communicator); // the ranks start together, so the time is not the one of the generation
+    START(distributed_start);
+    for(int k = 0; k < K; k++){
+        swap(prev_variables, curr_variables); // the last solution becomes the previous one without copying it
+        double partial[2] = {0, 0}; // sum of (current[i] - previous[i])^2 and of current[i]^2 over the rows
+        for(int i = start; i < end; i++){
+            const float *row = system.rows.data() + (size_t) (i - start) * system.stride;
+            float variable;
+            if(overlap){ // only the columns of the other ranks are left
+                float sum = local_sums[i - start] + row_dot(row, prev_variables.data(), start) +
+                            row_dot(row + end, prev_variables.data() + end, n - end);
+                variable = (system.knownTerm[i - start] - sum) * system.inverse_diagonal[i - start];
+            }
+            else{
+                variable = jacobi_row(row, prev_variables.data(), system.knownTerm[i - start],
+                                      system.inverse_diagonal[i - start], i, n);
+            }
+            float delta = variable - prev_variables[i];
+            partial[0] += delta * delta;
+            partial[1] += variable * variable;
+            slice[i - start] = variable;
+        }
+
+        double global[2];
+        if(overlap){
+            MPI_Request requests[2];
+            int pending = 1;
+            MPI_Iallgatherv(slice.data(), count, MPI_FLOAT, curr_variables.data(), system.counts.data(),
+                            system.displacements.data(), MPI_FLOAT, communicator, &requests[0]);
+            if(tolerance >= 0){
+                MPI_Iallreduce(partial, global, 2, MPI_DOUBLE, MPI_SUM, communicator, &requests[pending++]);
+            }
+            // the columns of the rank are already known: their part of the next iteration is computed meanwhile
+            for(int i = start; i < end; i++){
+                const float *row = system.rows.data() + (size_t) (i - start) * system.stride;
+                local_sums[i - start] = row_dot(row + start, slice.data(), i - start) +
+                                        row_dot(row + i + 1, slice.data() + (i + 1 - start), end - i - 1);
+            }
+            MPI_Waitall(pending, requests, MPI_STATUSES_IGNORE);
+        }
+        else{
+            MPI_Allgatherv(slice.data(), count, MPI_FLOAT, curr_variables.data(), system.counts.data(),
+                           system.displacements.data(), MPI_FLOAT, communicator);
+            if(tolerance >= 0){
+                MPI_Allreduce(partial, global, 2, MPI_DOUBLE, MPI_SUM, communicator);
+            }
+        }
+
+        if(tolerance >= 0){ // every rank has the same sums, so all the ranks stop at the same iteration
+            long double similarity = sqrt((long double) global[0]) / sqrt((long double) global[1]);
+            if(similarity <= tolerance){
+                if(rank == 0){
+                    cout << k << ")Distributed Jacobi interrupted because " << similarity << " (" <<
+                         criterion_name(StoppingCriterion::INCREMENT) << ") <= " << tolerance << " (tolerance)" << endl;
+                }
+                break;
+            }
+        }
+    }
+    STOP(distributed_start, elapsed);
+
+    long slowest = elapsed;
+    MPI_Allreduce(&elapsed, &slowest, 1, MPI_LONG, MPI_MAX, communicator);
+    distributed_time = slowest;
+    if(rank == 0){
+        cout << "DISTRIBUTED " << ranks << " ranks computed in " << slowest << " usec " << endl;
+    }
+    return curr_variables;
+}
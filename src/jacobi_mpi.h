@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include <mpi.h>
+#include "generator.h"
+#include "jacobi_workspace.h"
+using namespace std;
+
+
+/*!
+ * The following structure stores the part of a linear system owned by a rank of the distributed engine: the rows
+ * [start, end) of the matrix, padded as in Matrix, and the same rows of the known term. The rows are split as in the
+ * native threads engine: each rank gets n / ranks consecutive rows and the last rank also gets the remainder.
+ */
+struct DistributedSystem {
+    int n = 0; // dimension of the whole linear system
+    int start = 0; // first row owned by the rank
+    int end = 0; // first row after the ones owned by the rank
+    int stride = 0; // number of floats of each padded row
+    vector<float> rows; // rows [start, end) of the matrix A, one after the other
+    vector<float> knownTerm; // elements [start, end) of the vector b
+    vector<float> inverse_diagonal; // reciprocals of the elements on the diagonal of the rows [start, end)
+    vector<int> counts; // number of rows owned by each rank
+    vector<int> displacements; // first row owned by each rank
+};
+
+
+/*!
+ * The following function generates the rows of a linear system owned by the calling rank. The system is the same as
+ * the one generated by main.out with the same generator and seed, whatever the number of ranks, and the matrix is
+ * never built as a whole: each rank only stores its rows.
+ * @param n [int] := dimension of the linear system
+ * @param generator [MatrixGenerator] := description of the matrix
+ * @param knownTerm [vector<float>] := whole vector b of the linear system (Ax=b)
+ * @param communicator [MPI_Comm] := ranks that share the system
+ * @return system [DistributedSystem] := rows of the system owned by the calling rank
+ */
+DistributedSystem distribute_system(int n, const MatrixGenerator &generator, const vector<float> &knownTerm,
+                                    MPI_Comm communicator);
+
+
+/*!
+ * The following function computes the Jacobi's Algorithm on many processes. At each iteration every rank computes its
+ * rows, the new slices of the solution are exchanged with an allgather and the stopping criteria is combined with an
+ * allreduce, so all the ranks stop at the same iteration. With overlap the collectives are non-blocking: while the
+ * slices travel each rank computes the part of the next dot products that only needs its own slice (the columns
+ * [start, end) of its rows), and only the remaining columns are computed after the allgather.
+ * @param system [DistributedSystem] := rows of the system owned by the calling rank
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param distributed_time [long] := value passed by reference in which it will be stored the computation time of the
+ * slowest rank
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param communicator [MPI_Comm] := ranks that share the system
+ * @param overlap [bool] := true to overlap the collectives with the computation, false to use blocking collectives
+ * @return solution [const vector<float> &] := reference to the whole solution vector stored in the workspace, the same
+ * on every rank.
+ */
+const vector<float> &distributed_jacobi(const DistributedSystem &system, int K, double tolerance,
+                                        long &distributed_time, JacobiWorkspace &workspace, MPI_Comm communicator,
+                                        bool overlap = true);
@@ -0,0 +1,206 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <stdexcept>
+#include <barrier>
+#include "utimer.cpp"
+#include "jacobi_relaxation.h"
+#include "convergence.h"
+using namespace std;
+
+
+/*!
+ * The following function parses a method given on the command line.
+ * @param text [string] := "jacobi", "gs", "sor" or "rb"
+ * @return method [RelaxationMethod] := parsed method
+ * @throw invalid_argument if the text is not a valid method
+ */
+RelaxationMethod parse_relaxation(const string &text){
+
+    if(text == "jacobi"){
+        return RelaxationMethod::JACOBI;
+    }
+    if(text == "gs"){
+        return RelaxationMethod::GAUSS_SEIDEL;
+    }
+    if(text == "sor"){
+        return RelaxationMethod::SOR;
+    }
+    if(text == "rb"){
+        return RelaxationMethod::RED_BLACK;
+    }
+    throw invalid_argument("The method '" + text + "' is not valid");
+}
+
+
+/*!
+ * @param method [RelaxationMethod] := relaxation method
+ * @return name [string] := name of the method, as accepted by parse_relaxation
+ */
+string relaxation_name(RelaxationMethod method){
+
+    switch(method){
+        case RelaxationMethod::GAUSS_SEIDEL:
+            return "gs";
+        case RelaxationMethod::SOR:
+            return "sor";
+        case RelaxationMethod::RED_BLACK:
+            return "rb";
+        default:
+            return "jacobi";
+    }
+}
+
+
+/*!
+ * The following function computes the sequential version of a relaxation method (Gauss-Seidel, SOR or red-black).
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations allowed
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm (disabled if smaller than 0)
+ * @param seq_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param relaxation [Relaxation] := method and its parameters
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+template <typename DenseMatrix>
+static const vector<float> &seq_relaxation(const DenseMatrix &matrix, const vector<float> &knownTerm, int K,
+                                           double tolerance, long &seq_time, JacobiWorkspace &workspace,
+                                           const Relaxation &relaxation){
+
+    int n = knownTerm.size();
+    workspace.reset(matrix);
+    bool natural = relaxation.method != RelaxationMethod::RED_BLACK;
+    int colors = natural ? 1 : relaxation.colors;
+    float omega = relaxation.method == RelaxationMethod::GAUSS_SEIDEL ? 1.0f : (float) relaxation.omega;
+    long double similarity;
+
+    {
+        utimer seq = utimer("Sequential " + relaxation_name(relaxation.method), &seq_time);
+        for(int k = 0; k < K; k++){
+            swap(workspace.prev_variables, workspace.curr_variables);
+            ConvergencePartial partial;
+            for(int color = 0; color < colors; color++){
+                int first = natural ? 0 : color_start(color, colors, n);
+                int last = natural ? n : color_start(color + 1, colors, n);
+                relaxation_sweep(matrix, first, last, natural ? -1 : first, knownTerm, workspace, omega, partial);
+            }
+            if(tolerance >= 0){
+                similarity = sqrt(partial.difference) / sqrt(partial.norm);
+                if(similarity <= tolerance){
+                    cout << k << ")Sequential " << relaxation_name(relaxation.method) << " interrupted because " <<
+                         similarity << " (" << criterion_name(StoppingCriterion::INCREMENT) << ") <= " <<
+                         tolerance << " (tolerance)" << endl;
+                    break;
+                }
+            }
+        }
+    }
+    return workspace.curr_variables;
+}
+
+
+/*!
+ * The following function computes the parallel version of a relaxation method with the multicolor ordering using the
+ * native threads implementation.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm (disabled if smaller than 0)
+ * @param thr_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
+ * @param relaxation [Relaxation] := method and its parameters
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+template <typename DenseMatrix>
+static const vector<float> &thr_relaxation(const DenseMatrix &matrix, const vector<float> &knownTerm, int K,
+                                           int num_threads, double tolerance, long &thr_time,
+                                           JacobiWorkspace &workspace, ThreadPool &pool,
+                                           const Relaxation &relaxation){
+
+    int n = knownTerm.size();
+    workspace.reset(matrix);
+    int colors = relaxation.colors;
+    float omega = relaxation.method == RelaxationMethod::GAUSS_SEIDEL ? 1.0f : (float) relaxation.omega;
+    vector<ConvergencePartial> &partials = workspace.partials;
+    int iterations = K;
+    int color = 0;
+    long double similarity;
+
+    partials.assign(num_threads, ConvergencePartial());
+
+    // function called by the barrier after each color: the iteration is over only after the last color
+    auto on_completion = [&]() noexcept {
+        if (++color < colors) {
+            return;
+        }
+        color = 0;
+        iterations--;
+        if (tolerance >= 0) {
+            similarity = combine_partials(partials, num_threads);
+            if (similarity <= tolerance) {
+                cout << (K-iterations-1) << ")Parallel " << relaxation_name(relaxation.method) <<
+                     " interrupted because " << similarity << " (" << criterion_name(StoppingCriterion::INCREMENT) <<
+                     ") <= " << tolerance << " (tolerance)" << endl;
+                iterations = 0;
+            }
+        }
+        for (int t = 0; t < num_threads; t++) {
+            partials[t] = ConvergencePartial();
+        }
+        if (iterations > 0) { // the last solution becomes the previous one without copying it
+            swap(workspace.prev_variables, workspace.curr_variables);
+        }
+    };
+
+    std::barrier ba(num_threads, on_completion);
+
+    auto body = [&](int tid) { // function executed by a single thread
+        while (iterations > 0) {
+            // the rows of the current color are split in contiguous chunks, one for each thread
+            int first = color_start(color, colors, n);
+            int rows = color_start(color + 1, colors, n) - first;
+            int start = first + (int) ((long) tid * rows / num_threads);
+            int end = first + (int) ((long) (tid + 1) * rows / num_threads);
+            relaxation_sweep(matrix, start, end, first, knownTerm, workspace, omega, partials[tid]);
+            ba.arrive_and_wait();
+        }
+    };
+
+    string timer = "PARALLEL " + relaxation_name(relaxation.method) + " " + to_string(num_threads) + " threads ";
+    {
+        utimer thr = utimer(timer, &thr_time);
+        pool.run(num_threads, body);
+    }
+    return workspace.curr_variables;
+}
+
+
+const vector<float> &sequential_relaxation(const Matrix &matrix, const vector<float> &knownTerm, int K,
+                                           double tolerance, long &seq_time, JacobiWorkspace &workspace,
+                                           const Relaxation &relaxation){
+    return seq_relaxation(matrix, knownTerm, K, tolerance, seq_time, workspace, relaxation);
+}
+
+
+const vector<float> &sequential_relaxation(const PrecisionMatrix &matrix, const vector<float> &knownTerm, int K,
+                                           double tolerance, long &seq_time, JacobiWorkspace &workspace,
+                                           const Relaxation &relaxation){
+    return seq_relaxation(matrix, knownTerm, K, tolerance, seq_time, workspace, relaxation);
+}
+
+
+const vector<float> &threads_relaxation(const Matrix &matrix, const vector<float> &knownTerm, int K, int num_threads,
+                                        double tolerance, long &thr_time, JacobiWorkspace &workspace,
+                                        ThreadPool &pool, const Relaxation &relaxation){
+    return thr_relaxation(matrix, knownTerm, K, num_threads, tolerance, thr_time, workspace, pool, relaxation);
+}
+
+
+const vector<float> &threads_relaxation(const PrecisionMatrix &matrix, const vector<float> &knownTerm, int K,
+                                        int num_threads, double tolerance, long &thr_time,
+                                        JacobiWorkspace &workspace, ThreadPool &pool, const Relaxation &relaxation){
+    return thr_relaxation(matrix, knownTerm, K, num_threads, tolerance, thr_time, workspace, pool, relaxation);
+}
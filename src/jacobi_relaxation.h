@@ -0,0 +1,169 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "matrix.h"
+#include "precision.h"
+#include "jacobi_workspace.h"
+#include "thread_pool.h"
+using namespace std;
+
+
+/*!
+ * The following enumeration lists the iterative methods that can be used instead of the Jacobi's Algorithm.
+ */
+enum class RelaxationMethod {
+    JACOBI, // every variable is computed from the solution of the previous iteration
+    GAUSS_SEIDEL, // the rows are computed in their natural order and each one reads the variables already updated
+    SOR, // Gauss-Seidel with over-relaxation: x = (1 - omega) * x_previous + omega * x_gauss_seidel
+    RED_BLACK // multicolor ordering: the rows of each color read the variables already updated by the previous colors
+};
+
+
+/*!
+ * The following structure stores the method used by the engines and its parameters. The natural ordering of
+ * Gauss-Seidel and SOR is inherently sequential, so the parallel engines use the multicolor (red-black) ordering. On a
+ * dense matrix every row depends on every variable, so the colors are blocks of consecutive rows: the rows of a color
+ * are computed in parallel from the variables of the previous colors (already updated) and of the next ones (not yet
+ * updated). With 2 colors it is the red-black ordering, with n colors it is exactly Gauss-Seidel.
+ */
+struct Relaxation {
+    RelaxationMethod method = RelaxationMethod::JACOBI;
+    double omega = 1.0; // relaxation factor, 1 for Gauss-Seidel, in (1, 2) for over-relaxation
+    int colors = 2; // number of colors of the multicolor ordering
+};
+
+
+/*!
+ * The following function parses a method given on the command line.
+ * @param text [string] := "jacobi", "gs", "sor" or "rb"
+ * @return method [RelaxationMethod] := parsed method
+ * @throw invalid_argument if the text is not a valid method
+ */
+RelaxationMethod parse_relaxation(const string &text);
+
+
+/*!
+ * @param method [RelaxationMethod] := relaxation method
+ * @return name [string] := name of the method, as accepted by parse_relaxation
+ */
+string relaxation_name(RelaxationMethod method);
+
+
+/*!
+ * The following function computes the new value of the i-th variable of a relaxation method. The variables before
+ * split are read from the solution being computed, the others from the solution of the previous iteration, and the
+ * diagonal element is skipped by splitting the row as in jacobi_row. With split = i it is a Gauss-Seidel step, with
+ * split equal to the first row of the color of i it is a step of the multicolor ordering.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param i [int] := index of the row
+ * @param split [int] := first variable read from the previous solution, it must be <= i
+ * @param curr_variables [const float *] := solution being computed at the current iteration
+ * @param prev_variables [const float *] := solution computed at the previous iteration
+ * @param knownTerm [float] := i-th element of the vector b
+ * @param inverse_diagonal [float] := reciprocal of the i-th element of the diagonal
+ * @param omega [float] := relaxation factor
+ * @return variable [float] := value of the i-th variable at the current iteration
+ */
+template <typename DenseMatrix>
+inline float relaxed_row(const DenseMatrix &matrix, int i, int split, const float *curr_variables,
+                         const float *prev_variables, float knownTerm, float inverse_diagonal, float omega){
+
+    int n = matrix.size();
+    double sum = range_dot(matrix, i, 0, split, curr_variables) +
+                 range_dot(matrix, i, split, i - split, prev_variables) +
+                 range_dot(matrix, i, i + 1, n - i - 1, prev_variables);
+    float variable = (float) ((knownTerm - sum) * inverse_diagonal);
+    return omega == 1.0f ? variable : (1.0f - omega) * prev_variables[i] + omega * variable;
+}
+
+
+/*!
+ * The following function returns the first row of a color of the multicolor ordering: the colors are blocks of
+ * consecutive rows with about the same size.
+ * @param color [int] := index of the color, colors for the row after the last one
+ * @param colors [int] := number of colors
+ * @param n [int] := dimension of the linear system
+ * @return first [int] := first row of the color
+ */
+inline int color_start(int color, int colors, int n){
+    return (int) ((long) color * n / colors);
+}
+
+
+/*!
+ * The following function computes the rows in [first, last) of a relaxation method and accumulates the stopping
+ * criteria of these rows.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param first [int] := first row to compute
+ * @param last [int] := row after the last one to compute
+ * @param split [int] := first variable read from the previous solution, -1 to use the natural ordering (split = i)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param omega [float] := relaxation factor
+ * @param partial [ConvergencePartial] := partial sums of the stopping criteria, updated
+ */
+template <typename DenseMatrix>
+inline void relaxation_sweep(const DenseMatrix &matrix, int first, int last, int split,
+                             const vector<float> &knownTerm, JacobiWorkspace &workspace, float omega,
+                             ConvergencePartial &partial){
+
+    float *curr_variables = workspace.curr_variables.data();
+    const float *prev_variables = workspace.prev_variables.data();
+    const float *inverse_diagonal = workspace.inverse_diagonal.data();
+    double difference = 0;
+    double norm = 0;
+    for(int i = first; i < last; i++){
+        float variable = relaxed_row(matrix, i, split < 0 ? i : split, curr_variables, prev_variables, knownTerm[i],
+                                     inverse_diagonal[i], omega);
+        float delta = variable - prev_variables[i];
+        difference += delta * delta;
+        norm += variable * variable;
+        curr_variables[i] = variable;
+    }
+    partial.difference += difference;
+    partial.norm += norm;
+}
+
+
+/*!
+ * The following function computes the sequential version of a relaxation method (Gauss-Seidel, SOR or red-black).
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations allowed
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param seq_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param relaxation [Relaxation] := method and its parameters
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &sequential_relaxation(const Matrix &matrix, const vector<float> &knownTerm, int K,
+                                           double tolerance, long &seq_time, JacobiWorkspace &workspace,
+                                           const Relaxation &relaxation);
+const vector<float> &sequential_relaxation(const PrecisionMatrix &matrix, const vector<float> &knownTerm, int K,
+                                           double tolerance, long &seq_time, JacobiWorkspace &workspace,
+                                           const Relaxation &relaxation);
+
+
+/*!
+ * The following function computes the parallel version of a relaxation method with the multicolor ordering using the
+ * native threads implementation: the rows of each color are split among the threads, which synchronize on a barrier
+ * after each color.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param thr_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
+ * @param relaxation [Relaxation] := method and its parameters
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &threads_relaxation(const Matrix &matrix, const vector<float> &knownTerm, int K, int num_threads,
+                                        double tolerance, long &thr_time, JacobiWorkspace &workspace,
+                                        ThreadPool &pool, const Relaxation &relaxation);
+const vector<float> &threads_relaxation(const PrecisionMatrix &matrix, const vector<float> &knownTerm, int K,
+                                        int num_threads, double tolerance, long &thr_time,
+                                        JacobiWorkspace &workspace, ThreadPool &pool, const Relaxation &relaxation);
@@ -1,8 +1,10 @@
 #include <iostream>
 #include <vector>
 #include <tuple>
+#include <cmath>
 #include "utimer.cpp"
 #include "utility.h"
+#include "row_kernel.h"
 #include "jacobi_sequential.h"
 using namespace std;
 
@@ -11,14 +13,16 @@ using namespace std;
  * The following function is called from sequential_jacobi and it is called only if the tolerance input in
  * sequential_jacobi is disabled (smaller than 0). Even if it is redundant I adopted this choice in order to avoid
  * at each step the comparison
- * @param matrix [vector<vector<float>>] := matrix A of the linear system (Ax=b)
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
  * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
  * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
- * @param ff_time [long] := value passed by reference in which it will be stored the computation time of the sequential
+ * @param seq_time [long] := value passed by reference in which it will be stored the computation time of the sequential
  * implementation
- * @return solution [vector<float>] := solution vector that best approximates the linear system Ax=b.
+ * @param workspace [JacobiWorkspace] := buffers used during the computation, the solution is stored in curr_variables
  */
-vector<float> seq_jacobi(vector<vector<float>> matrix, vector<float> knownTerm, int K, long &seq_time){
+template <typename DenseMatrix>
+static void seq_jacobi(const DenseMatrix &matrix, const vector<float> &knownTerm, int K, long &seq_time,
+                       JacobiWorkspace &workspace){
 
     int n = knownTerm.size();
 
@@ -27,79 +31,96 @@ vector<float> seq_jacobi(vector<vector<float>> matrix, vector<float> knownTerm,
         cout << "K set to n because it was <= 0" << endl;
     }
 
-    vector<float> curr_variables(n, 0.0);
-    vector<float> prev_variables(n, 0.0);
-    float sum;
+    vector<float> &curr_variables = workspace.curr_variables;
+    vector<float> &prev_variables = workspace.prev_variables;
+    const vector<float> &inverse_diagonal = workspace.inverse_diagonal;
 
     {
         utimer seq = utimer("Sequential Jacobi", &seq_time);
         for(int k=0; k < K; k++) {
+            swap(prev_variables, curr_variables); // the last solution becomes the previous one without copying it
+            workspace.iterations++;
             for (int i = 0; i < n; i++) {
-                sum = 0;
-                for (int j = 0; j < n; j++) {
-                    if (i != j) {
-                        sum += matrix[i][j] * prev_variables[j];
-                    }
-                }
-                curr_variables[i] = (knownTerm[i] - sum) / matrix[i][i];
+                curr_variables[i] = jacobi_row(matrix, i, prev_variables.data(), knownTerm[i], inverse_diagonal[i]);
             }
-            prev_variables = curr_variables;
         }
     }
-
-    return curr_variables;
 }
 
 
 /*!
- * The following function computes the sequential version of the Jacobi's Algorithm.
- * @param matrix [vector<vector<float>>] := matrix A of the linear system (Ax=b)
+ * The following function computes the sequential version of the Jacobi's Algorithm using the buffers of the workspace
+ * given as input, so that no vector is allocated if the workspace has already been used for a system of the same size.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
  * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
  * @param K [int] := maximum number of iterations of the Jacobi's Algorithm
  * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
  * stopping criteria ||(current - previous)|| / ||current||
  * @param seq_time [long] := value passed by reference in which it will be stored the computation time of the sequential
  * implementation
- * @return solution [vector<float>] := solution vector that best approximates the linear system Ax=b.
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param tiling [Tiling] := tiles of the cache-blocked sweep, the sweep is not tiled if tiling.columns is 0
+ * @param convergence [Convergence] := stopping criteria and cadence of its checks
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
  */
-vector<float> sequential_jacobi(vector<vector<float>> matrix, vector<float> knownTerm, int K,
-                               double tolerance, long &seq_time){
-
-    if (tolerance < 0){ // it avoids to check the if statement when the tolerance is not used
-        return seq_jacobi(matrix, knownTerm, K, seq_time);
-    }
+template <typename DenseMatrix>
+static const vector<float> &sequential_solve(const DenseMatrix &matrix, const vector<float> &knownTerm, int K,
+                                             double tolerance, long &seq_time, JacobiWorkspace &workspace,
+                                             const Tiling &tiling, const Convergence &convergence){
 
     int n = knownTerm.size();
+    workspace.reset(matrix);
+
+    if (tolerance < 0 && tiling.columns == 0){ // it avoids to check the if statement when the tolerance is not used
+        seq_jacobi(matrix, knownTerm, K, seq_time, workspace);
+        return workspace.curr_variables;
+    }
 
     if(K <= 0){
         K = n;
         cout << "K set to n because it was <= 0" << endl;
     }
 
-    vector<float> curr_variables(n, 0.0);
-    vector<float> prev_variables(n, 0.0);
-    float sum;
+    vector<float> &curr_variables = workspace.curr_variables;
+    vector<float> &prev_variables = workspace.prev_variables;
+    const vector<float> &inverse_diagonal = workspace.inverse_diagonal;
+    StoppingCriterion criterion = convergence.criterion;
+    ConvergenceMonitor monitor(convergence, tolerance);
     long double similarity;
 
     {
         utimer seq = utimer("Sequential Jacobi", &seq_time);
         for(int k=0; k < K; k++) {
-            for (int i = 0; i < n; i++) {
-                sum = 0;
-                for (int j = 0; j < n; j++) {
-                    if (i != j) {
-                        sum += matrix[i][j] * prev_variables[j];
-                    }
+            swap(prev_variables, curr_variables); // the last solution becomes the previous one without copying it
+            workspace.iterations++;
+            bool check = monitor.due(k);
+            ConvergencePartial partial;
+            if (tiling.columns > 0) { // the rows are computed in blocks that reuse each tile of the variables in cache
+                tiled_sweep(matrix, 0, n, prev_variables.data(), curr_variables.data(), knownTerm.data(),
+                            inverse_diagonal.data(), tiling, partial, criterion);
+            }
+            else if (check) {
+                for (int i = 0; i < n; i++) { // the stopping criteria is accumulated while the rows are computed
+                    float variable = jacobi_row(matrix, i, prev_variables.data(), knownTerm[i], inverse_diagonal[i]);
+                    accumulate_row(partial, criterion, variable, prev_variables[i], knownTerm[i], inverse_diagonal[i]);
+                    curr_variables[i] = variable;
                 }
-                curr_variables[i] = (knownTerm[i] - sum) / matrix[i][i];
             }
-            similarity = stopping_criteria(curr_variables, prev_variables);
-            if (similarity <= tolerance) {
-                cout << k <<")Sequential Jacobi interrupted because " << similarity << " (similarity) <= " <<
-                     tolerance << " (tolerance)" << endl;
+            else {
+                for (int i = 0; i < n; i++) {
+                    curr_variables[i] = jacobi_row(matrix, i, prev_variables.data(), knownTerm[i], inverse_diagonal[i]);
+                }
+            }
+            if (!check) {
+                continue;
+            }
+            workspace.checks++;
+            similarity = criterion_value(partial, criterion);
+            if (monitor.converged(k, similarity)) {
+                cout << k <<")Sequential Jacobi interrupted because " << similarity << " (" <<
+                     criterion_name(criterion) << ") <= " << tolerance << " (tolerance)" << endl;
                 break;
             }
-            prev_variables = curr_variables;
         }
     }
 
@@ -107,3 +128,50 @@ vector<float> sequential_jacobi(vector<vector<float>> matrix, vector<float> know
 }
 
 
+/*!
+ * The following function computes the sequential version of the Jacobi's Algorithm using the buffers of the workspace
+ * given as input, so that no vector is allocated if the workspace has already been used for a system of the same size.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param seq_time [long] := value passed by reference in which it will be stored the computation time of the sequential
+ * implementation
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param tiling [Tiling] := tiles of the cache-blocked sweep, the sweep is not tiled if tiling.columns is 0
+ * @param convergence [Convergence] := stopping criteria and cadence of its checks
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &sequential_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, double tolerance,
+                                       long &seq_time, JacobiWorkspace &workspace, const Tiling &tiling,
+                                       const Convergence &convergence){
+    return sequential_solve(matrix, knownTerm, K, tolerance, seq_time, workspace, tiling, convergence);
+}
+
+
+const vector<float> &sequential_jacobi(const PrecisionMatrix &matrix, const vector<float> &knownTerm, int K,
+                                       double tolerance, long &seq_time, JacobiWorkspace &workspace,
+                                       const Tiling &tiling, const Convergence &convergence){
+    return sequential_solve(matrix, knownTerm, K, tolerance, seq_time, workspace, tiling, convergence);
+}
+
+
+/*!
+ * The following function computes the sequential version of the Jacobi's Algorithm.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param seq_time [long] := value passed by reference in which it will be stored the computation time of the sequential
+ * implementation
+ * @return solution [vector<float>] := solution vector that best approximates the linear system Ax=b.
+ */
+vector<float> sequential_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, double tolerance,
+                                long &seq_time){
+
+    JacobiWorkspace workspace;
+    sequential_jacobi(matrix, knownTerm, K, tolerance, seq_time, workspace);
+    return std::move(workspace.curr_variables);
+}
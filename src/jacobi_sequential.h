@@ -1,10 +1,14 @@
 #include <vector>
+#include "matrix.h"
+#include "jacobi_workspace.h"
+#include "tiling.h"
+#include "convergence.h"
 using namespace std;
 
 
 /*!
  * The following function computes the sequential version of the Jacobi's Algorithm.
- * @param matrix [vector<vector<float>>] := matrix A of the linear system (Ax=b)
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
  * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
  * @param K [int] := maximum number of iterations of the Jacobi's Algorithm
  * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
@@ -13,6 +17,31 @@ using namespace std;
  * implementation
  * @return solution [vector<float>] := solution vector that best approximates the linear system Ax=b.
  */
-vector<float> sequential_jacobi(vector<vector<float>> matrix, vector<float> knownTerm, int K, double tolerance,
+vector<float> sequential_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, double tolerance,
                                 long &seq_time);
 
+
+/*!
+ * The following function computes the sequential version of the Jacobi's Algorithm using the buffers of the workspace
+ * given as input, so that no vector is allocated if the workspace has already been used for a system of the same size.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param seq_time [long] := value passed by reference in which it will be stored the computation time of the sequential
+ * implementation
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param tiling [Tiling] := tiles of the cache-blocked sweep, the sweep is not tiled if tiling.columns is 0
+ * @param convergence [Convergence] := stopping criteria and cadence of its checks, the increment at every iteration
+ * by default
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &sequential_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, double tolerance,
+                                       long &seq_time, JacobiWorkspace &workspace,
+                                       const Tiling &tiling = Tiling(),
+                                       const Convergence &convergence = Convergence());
+const vector<float> &sequential_jacobi(const PrecisionMatrix &matrix, const vector<float> &knownTerm, int K,
+                                       double tolerance, long &seq_time, JacobiWorkspace &workspace,
+                                       const Tiling &tiling = Tiling(),
+                                       const Convergence &convergence = Convergence());
@@ -0,0 +1,355 @@
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include "jacobi_solver.h"
+#include "jacobi_sequential.h"
+#include "jacobi_threads.h"
+#include "jacobi_ff.h"
+#include "jacobi_async.h"
+using namespace std;
+
+
+/*!
+ * The following constructor borrows the linear system, which must outlive the solver.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ */
+JacobiSolver::JacobiSolver(const Matrix &matrix, const vector<float> &knownTerm) : matrix(&matrix),
+                                                                                 knownTerm(&knownTerm) {
+    workspace.reset(matrix);
+}
+
+
+/*!
+ * The following constructor takes the ownership of the linear system.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ */
+JacobiSolver::JacobiSolver(Matrix &&matrix, vector<float> &&knownTerm) : owned_matrix(std::move(matrix)),
+                                                                         owned_knownTerm(std::move(knownTerm)),
+                                                                         matrix(&owned_matrix),
+                                                                         knownTerm(&owned_knownTerm) {
+    workspace.reset(owned_matrix);
+}
+
+
+/*!
+ * The following function solves the linear system with the engine given as input.
+ * @param engine [Engine] := engine used to compute the Jacobi's Algorithm
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize (ignored by the sequential engine)
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param time [long] := value passed by reference in which it will be stored the computation time
+ * @return solution [const vector<float> &] := reference to the solution vector, valid until the next solve.
+ */
+const vector<float> &JacobiSolver::solve(Engine engine, int K, int num_threads, double tolerance, long &time){
+
+    auto run = [&](const auto &matrix) -> const vector<float> & { // the same engines on both the dense formats
+        if(relaxation.method != RelaxationMethod::JACOBI){
+            switch(engine){
+                case Engine::SEQUENTIAL:
+                    return sequential_relaxation(matrix, *knownTerm, K, tolerance, time, workspace, relaxation);
+                case Engine::THREADS:
+                    reserve_threads(num_threads);
+                    return threads_relaxation(matrix, *knownTerm, K, num_threads, tolerance, time, workspace, *pool,
+                                              relaxation);
+                case Engine::FASTFLOW:
+                    return fast_flow_relaxation(matrix, *knownTerm, K, num_threads, tolerance, time, workspace,
+                                                relaxation);
+                case Engine::ASYNC: // the asynchronous engine computes only the Jacobi's Algorithm
+                    break;
+            }
+        }
+        switch(engine){
+            case Engine::SEQUENTIAL:
+                return sequential_jacobi(matrix, *knownTerm, K, tolerance, time, workspace, tiling, convergence);
+            case Engine::THREADS:
+                reserve_threads(num_threads);
+                return threads_jacobi(matrix, *knownTerm, K, num_threads, tolerance, time, workspace, *pool,
+                                      tiling, schedule, tracer.get(), convergence);
+            case Engine::FASTFLOW:
+                return fast_flow_jacobi(matrix, *knownTerm, K, num_threads, tolerance, time, workspace, tiling,
+                                        fast_flow, tracer.get(), convergence);
+            case Engine::ASYNC:
+                reserve_threads(num_threads);
+                return async_jacobi(matrix, *knownTerm, K, num_threads, tolerance, staleness, time, workspace,
+                                    *pool);
+        }
+        return workspace.curr_variables;
+    };
+    if(!counting){
+        return reduced != nullptr ? run(*reduced) : run(*matrix);
+    }
+    // the threads of FastFlow are created and joined by the engine, so the inherited counters include them, while the
+    // long-lived workers of the pool count their own events
+    PerfCounters counters(true);
+    PerfSample begin = counters.read();
+    const vector<float> &solution = reduced != nullptr ? run(*reduced) : run(*matrix);
+    events = counters.read() - begin;
+    if(pool != nullptr){
+        events += pool->take_events();
+    }
+    return solution;
+}
+
+
+/*!
+ * The following function solves the linear system AX=B for many right-hand sides at the same time with the engine
+ * given as input. Each element of the matrix is loaded once for all the columns still iterating, and each column
+ * stops independently when it meets the tolerance. The matrix is always read in single precision.
+ * @param engine [Engine] := engine used to compute the Jacobi's Algorithm
+ * @param rhs [vector<vector<float>>] := the m right-hand sides (columns of B)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize (ignored by the sequential engine)
+ * @param tolerance [double] := tolerance used to stop earlier each column and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param time [long] := value passed by reference in which it will be stored the computation time
+ * @return solutions [const vector<vector<float>> &] := reference to the solutions, valid until the next solve.
+ */
+const vector<vector<float>> &JacobiSolver::solve_batch(Engine engine, const vector<vector<float>> &rhs, int K,
+                                                       int num_threads, double tolerance, long &time){
+
+    switch(engine){
+        case Engine::SEQUENTIAL:
+            return sequential_jacobi_batch(*matrix, rhs, K, tolerance, time, batch_workspace);
+        case Engine::THREADS:
+            reserve_threads(num_threads);
+            return threads_jacobi_batch(*matrix, rhs, K, num_threads, tolerance, time, batch_workspace, *pool);
+        case Engine::FASTFLOW:
+            return fast_flow_jacobi_batch(*matrix, rhs, K, num_threads, tolerance, time, batch_workspace);
+        case Engine::ASYNC: // there is no asynchronous batched engine, the columns retire at the barrier
+            reserve_threads(num_threads);
+            return threads_jacobi_batch(*matrix, rhs, K, num_threads, tolerance, time, batch_workspace, *pool);
+    }
+    return batch_workspace.solutions;
+}
+
+
+/*!
+ * The following function makes sure that the pool of the native threads engine has at least num_threads workers,
+ * so that the threads can be created before the solves that must be timed.
+ * @param num_threads [int] := number of workers needed
+ */
+void JacobiSolver::reserve_threads(int num_threads){
+
+    if(pool == nullptr || pool->size() < num_threads){
+        pool.reset(); // the old workers are joined before the new ones are started
+        pool = make_unique<ThreadPool>(num_threads, placement_cpus(placement, detect_topology(), num_threads));
+        pool->count_events(counting);
+    }
+}
+
+
+/*!
+ * The following function sets the placement of the workers of the native threads engine. The pool is recreated,
+ * so the workers are pinned to the cores of the new layout.
+ * @param num_threads [int] := number of workers needed
+ * @param placement [Placement] := layout of the workers on the cores
+ */
+void JacobiSolver::reserve_threads(int num_threads, const Placement &placement){
+
+    this->placement = placement;
+    pool.reset();
+    reserve_threads(num_threads);
+}
+
+
+/*!
+ * The following function copies the matrix inside the solver so that the row block of each worker of the native
+ * threads engine is first touched by that worker, and so placed on its NUMA node. If the matrix is borrowed, from
+ * now on the solver uses its own copy.
+ * @param num_threads [int] := number of workers of the native threads engine
+ */
+void JacobiSolver::place_rows(int num_threads){
+
+    reserve_threads(num_threads);
+    owned_matrix = first_touch_copy(*matrix, *pool, num_threads);
+    matrix = &owned_matrix;
+    if(reduced != nullptr){ // the copy in reduced precision may point to the rows of the old matrix
+        set_precision(reduced->storage(), reduced->accumulation_type());
+    }
+}
+
+
+/*!
+ * The following function replaces the matrix with a generated one, whose row block of each worker of the native
+ * threads engine is generated, and so first touched, by that worker. From now on the solver uses its own matrix.
+ * @param generator [MatrixGenerator] := description of the matrix, whose dimension is the one of the known term
+ * @param num_threads [int] := number of workers that generate the rows
+ */
+void JacobiSolver::generate_rows(const MatrixGenerator &generator, int num_threads){
+
+    reserve_threads(num_threads);
+    owned_matrix = generate_matrix(size(), generator, *pool, num_threads);
+    matrix = &owned_matrix;
+    bool warm = workspace.warm; // the reciprocals of the diagonal are computed again even with the warm start
+    workspace.warm = false;
+    workspace.reset(owned_matrix);
+    workspace.warm = warm;
+    if(reduced != nullptr){ // the copy in reduced precision was converted from the old matrix
+        set_precision(reduced->storage(), reduced->accumulation_type());
+    }
+}
+
+
+/*!
+ * The following function prints where the workers of the native threads engine are running and where the pages of
+ * their row blocks are placed.
+ * @param num_threads [int] := number of workers of the native threads engine
+ */
+void JacobiSolver::print_placement(int num_threads){
+
+    reserve_threads(num_threads);
+    print_placement_report(*matrix, *pool, num_threads);
+}
+
+
+/*!
+ * The following function sets the format in which the engines read the matrix and the type in which they
+ * accumulate the dot products. The matrix is converted once here; FP32 storage with FLOAT accumulation restores the
+ * plain engines.
+ * @param format [StorageFormat] := format of the stored elements
+ * @param accumulation [AccumulationType] := type in which the dot products are accumulated
+ */
+void JacobiSolver::set_precision(StorageFormat format, AccumulationType accumulation){
+
+    reduced.reset();
+    if(format != StorageFormat::FP32 || accumulation != AccumulationType::FLOAT){
+        reduced = make_unique<PrecisionMatrix>(*matrix, format, accumulation);
+    }
+}
+
+
+/*!
+ * The following function enables the counting of the hardware events (cycles, instructions, LLC misses and stall
+ * cycles) of each solve: the ones of the calling thread, of the threads created by the engine and of the workers
+ * of the pool. The counters that the kernel does not allow are reported as not available.
+ * @param enabled [bool] := true if the events must be counted
+ */
+void JacobiSolver::set_counters(bool enabled){
+
+    counting = enabled;
+    events = PerfSample();
+    if(pool != nullptr){
+        pool->count_events(enabled);
+        pool->take_events();
+    }
+}
+
+
+/*!
+ * The following function makes the solver use its own copy of the matrix, which can be changed: a borrowed or
+ * memory-mapped matrix is copied once. The copy in reduced precision must be converted again by the caller.
+ */
+void JacobiSolver::own_matrix(){
+
+    if(matrix != &owned_matrix || owned_matrix.is_mapped()){ // the pages of a mapped file are read-only
+        Matrix copy(*matrix);
+        owned_matrix = std::move(copy);
+        matrix = &owned_matrix;
+    }
+}
+
+
+/*!
+ * The following function sets the solution from which the next solve starts, and enables the warm start.
+ * @param guess [vector<float>] := initial value of the variables
+ * @throw invalid_argument if the dimension of the guess is not the one of the system
+ */
+void JacobiSolver::set_initial_guess(const vector<float> &guess){
+
+    if((int) guess.size() != size()){
+        throw invalid_argument("The initial guess has " + to_string(guess.size()) + " elements instead of " +
+                               to_string(size()));
+    }
+    if((int) workspace.inverse_diagonal.size() != size()){ // the warm start reuses the reciprocals of the diagonal
+        workspace.reset(*matrix);
+    }
+    workspace.curr_variables.assign(guess.begin(), guess.end());
+    workspace.warm = true;
+}
+
+
+/*!
+ * The following function changes some elements of the vector b, b[i] += delta. From now on the solver uses its
+ * own copy of the vector.
+ * @param delta [vector<pair<int, float>>] := the pairs (i, delta) of the elements that change
+ * @throw out_of_range if an index is not a row of the system
+ */
+void JacobiSolver::update_known_term(const vector<pair<int, float>> &delta){
+
+    if(knownTerm != &owned_knownTerm){
+        owned_knownTerm = *knownTerm;
+        knownTerm = &owned_knownTerm;
+    }
+    for(const auto &[i, change] : delta){
+        owned_knownTerm.at(i) += change;
+    }
+}
+
+
+/*!
+ * The following function replaces a row of the matrix A and updates the reciprocal of its diagonal element, so the
+ * next warm solve does not recompute the diagonal. From now on the solver uses its own copy of the matrix; if the
+ * matrix is stored in reduced precision, it is converted again.
+ * @param i [int] := index of the row
+ * @param row [vector<float>] := new elements of the row
+ * @throw out_of_range if the row is not a row of the system or its dimension is not the one of the system
+ */
+void JacobiSolver::update_row(int i, const vector<float> &row){
+
+    if(i < 0 || i >= size() || (int) row.size() != size()){
+        throw out_of_range("The row " + to_string(i) + " with " + to_string(row.size()) + " elements is not a row of "
+                           "the system of dimension " + to_string(size()));
+    }
+    own_matrix();
+    copy(row.begin(), row.end(), owned_matrix[i]);
+    workspace.inverse_diagonal[i] = 1.0f / owned_matrix[i][i];
+    if(reduced != nullptr){ // the copy in reduced precision was converted from the old matrix
+        set_precision(reduced->storage(), reduced->accumulation_type());
+    }
+}
+
+
+/*!
+ * The following function computes the rank-1 update A += u v^T, where u has few non-zero elements, so only the
+ * rows of the non-zero elements of u are changed and only their diagonal elements are updated. From now on the
+ * solver uses its own copy of the matrix; if the matrix is stored in reduced precision, it is converted again.
+ * @param u [vector<pair<int, float>>] := the pairs (i, u[i]) of the non-zero elements of u
+ * @param v [vector<float>] := the vector v
+ * @throw out_of_range if an index is not a row of the system or v has not the dimension of the system
+ */
+void JacobiSolver::rank_one_update(const vector<pair<int, float>> &u, const vector<float> &v){
+
+    int n = size();
+    if((int) v.size() != n){
+        throw out_of_range("The vector v has " + to_string(v.size()) + " elements instead of " + to_string(n));
+    }
+    for(const auto &[i, factor] : u){
+        if(i < 0 || i >= n){
+            throw out_of_range("The row " + to_string(i) + " is not a row of the system of dimension " +
+                               to_string(n));
+        }
+    }
+    own_matrix();
+    for(const auto &[i, factor] : u){
+        float *row = owned_matrix[i];
+        for(int j = 0; j < n; j++){
+            row[j] += factor * v[j];
+        }
+        workspace.inverse_diagonal[i] = 1.0f / row[i];
+    }
+    if(reduced != nullptr){ // the copy in reduced precision was converted from the old matrix
+        set_precision(reduced->storage(), reduced->accumulation_type());
+    }
+}
+
+
+/*!
+ * The following function shuts down the pool of the native threads engine and releases its workers. A new pool
+ * is created by the next solve that needs it.
+ */
+void JacobiSolver::release_threads(){
+    pool.reset();
+}
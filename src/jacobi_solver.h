@@ -0,0 +1,305 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include "matrix.h"
+#include "jacobi_workspace.h"
+#include "thread_pool.h"
+#include "placement.h"
+#include "precision.h"
+#include "jacobi_batch.h"
+#include "jacobi_relaxation.h"
+#include "tiling.h"
+#include "scheduler.h"
+#include "jacobi_ff.h"
+#include "generator.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include "convergence.h"
+using namespace std;
+
+
+/*!
+ * The following enumeration lists the engines that can be used by a JacobiSolver.
+ */
+enum class Engine { SEQUENTIAL, THREADS, FASTFLOW, ASYNC };
+
+
+/*!
+ * The following class is a solver session for a linear system Ax=b. The system is given once at construction time,
+ * either borrowed (it must outlive the solver) or moved inside the solver, and the work buffers are kept between two
+ * calls of solve(), so that after the first solve no matrix is copied and no vector is allocated. The workers of the
+ * native threads engines are kept in a pool owned by the solver, so they are created once and reused by every solve.
+ * The matrix can be stored in a reduced precision format, with the dot products accumulated in float or in double,
+ * and the Jacobi's Algorithm can be replaced by Gauss-Seidel, SOR or the multicolor (red-black) ordering. The system
+ * can be changed between two solves (elements of b, rows of A or rank-1 updates of A), and with the warm start each
+ * solve continues from the solution of the previous one.
+ */
+class JacobiSolver {
+
+private:
+    Matrix owned_matrix; // used only when the system is moved inside the solver (or its rows are placed)
+    vector<float> owned_knownTerm; // used only when the system is moved inside the solver
+    const Matrix *matrix;
+    const vector<float> *knownTerm;
+    JacobiWorkspace workspace;
+    unique_ptr<ThreadPool> pool; // workers of the native threads engine, created at the first use
+    Placement placement; // placement of the workers of the pool
+    unique_ptr<PrecisionMatrix> reduced; // copy of the matrix in reduced precision, used by solve() if it is set
+    BatchWorkspace batch_workspace; // buffers of the solves with many right-hand sides
+    Relaxation relaxation; // method used by solve(), Jacobi by default
+    int staleness = -1; // maximum lead of a worker of the asynchronous engine over the slowest one, unbounded if < 0
+    Tiling tiling; // tiles of the cache-blocked sweep of the dense Jacobi engines, not tiled by default
+    Schedule schedule; // assignment of the rows to the workers of the native threads Jacobi engine, static by default
+    FastFlowOptions fast_flow; // grain and waiting policy of the FastFlow Jacobi engine
+    bool counting = false; // if true solve() counts the hardware events of the engine
+    PerfSample events; // hardware events of the last solve, if they are counted
+    unique_ptr<Tracer> tracer; // timeline of the workers of the thr and ff Jacobi engines, nullptr if not recorded
+    Convergence convergence; // stopping criteria of the seq, thr and ff Jacobi engines and cadence of its checks
+
+    /*!
+     * The following function makes the solver use its own copy of the matrix, which can be changed: a borrowed or
+     * memory-mapped matrix is copied once. The copy in reduced precision must be converted again by the caller.
+     */
+    void own_matrix();
+
+public:
+
+    /*!
+     * The following constructor borrows the linear system, which must outlive the solver.
+     * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+     * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+     */
+    JacobiSolver(const Matrix &matrix, const vector<float> &knownTerm);
+
+    /*!
+     * The following constructor takes the ownership of the linear system.
+     * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+     * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+     */
+    JacobiSolver(Matrix &&matrix, vector<float> &&knownTerm);
+
+    JacobiSolver(const JacobiSolver &) = delete;
+    JacobiSolver &operator=(const JacobiSolver &) = delete;
+
+    /*!
+     * The following function solves the linear system with the engine given as input.
+     * @param engine [Engine] := engine used to compute the Jacobi's Algorithm
+     * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+     * @param num_threads [int] := number of threads used to parallelize (ignored by the sequential engine)
+     * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+     * stopping criteria ||(current - previous)|| / ||current||
+     * @param time [long] := value passed by reference in which it will be stored the computation time
+     * @return solution [const vector<float> &] := reference to the solution vector, valid until the next solve.
+     */
+    const vector<float> &solve(Engine engine, int K, int num_threads, double tolerance, long &time);
+
+    /*!
+     * The following function solves the linear system AX=B for many right-hand sides at the same time with the engine
+     * given as input. Each element of the matrix is loaded once for all the columns still iterating, and each column
+     * stops independently when it meets the tolerance. The matrix is always read in single precision.
+     * @param engine [Engine] := engine used to compute the Jacobi's Algorithm
+     * @param rhs [vector<vector<float>>] := the m right-hand sides (columns of B)
+     * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+     * @param num_threads [int] := number of threads used to parallelize (ignored by the sequential engine)
+     * @param tolerance [double] := tolerance used to stop earlier each column and it uses the following
+     * stopping criteria ||(current - previous)|| / ||current||
+     * @param time [long] := value passed by reference in which it will be stored the computation time
+     * @return solutions [const vector<vector<float>> &] := reference to the solutions, valid until the next solve.
+     */
+    const vector<vector<float>> &solve_batch(Engine engine, const vector<vector<float>> &rhs, int K, int num_threads,
+                                             double tolerance, long &time);
+
+    /*!
+     * @return iterations [const vector<int> &] := number of iterations computed by each column of the last batch
+     */
+    const vector<int> &batch_iterations() const { return batch_workspace.iterations; }
+
+    /*!
+     * The following function makes sure that the pool of the native threads engine has at least num_threads workers,
+     * so that the threads can be created before the solves that must be timed.
+     * @param num_threads [int] := number of workers needed
+     */
+    void reserve_threads(int num_threads);
+
+    /*!
+     * The following function sets the placement of the workers of the native threads engine. The pool is recreated,
+     * so the workers are pinned to the cores of the new layout.
+     * @param num_threads [int] := number of workers needed
+     * @param placement [Placement] := layout of the workers on the cores
+     */
+    void reserve_threads(int num_threads, const Placement &placement);
+
+    /*!
+     * The following function copies the matrix inside the solver so that the row block of each worker of the native
+     * threads engine is first touched by that worker, and so placed on its NUMA node. If the matrix is borrowed, from
+     * now on the solver uses its own copy.
+     * @param num_threads [int] := number of workers of the native threads engine
+     */
+    void place_rows(int num_threads);
+
+    /*!
+     * The following function replaces the matrix with a generated one, whose row block of each worker of the native
+     * threads engine is generated, and so first touched, by that worker. From now on the solver uses its own matrix.
+     * @param generator [MatrixGenerator] := description of the matrix, whose dimension is the one of the known term
+     * @param num_threads [int] := number of workers that generate the rows
+     */
+    void generate_rows(const MatrixGenerator &generator, int num_threads);
+
+    /*!
+     * The following function prints where the workers of the native threads engine are running and where the pages of
+     * their row blocks are placed.
+     * @param num_threads [int] := number of workers of the native threads engine
+     */
+    void print_placement(int num_threads);
+
+    /*!
+     * The following function sets the format in which the engines read the matrix and the type in which they
+     * accumulate the dot products. The matrix is converted once here; FP32 storage with FLOAT accumulation restores the
+     * plain engines.
+     * @param format [StorageFormat] := format of the stored elements
+     * @param accumulation [AccumulationType] := type in which the dot products are accumulated
+     */
+    void set_precision(StorageFormat format, AccumulationType accumulation);
+
+    /*!
+     * The following function sets the method used by solve(). The parallel engines compute Gauss-Seidel and SOR with
+     * the multicolor ordering, since the natural ordering is sequential.
+     * @param relaxation [Relaxation] := method and its parameters
+     */
+    void set_relaxation(const Relaxation &relaxation) { this->relaxation = relaxation; }
+
+    /*!
+     * The following function bounds the number of sweeps that a worker of the asynchronous engine can compute ahead
+     * of the slowest one.
+     * @param staleness [int] := maximum lead in sweeps, if smaller than 0 the workers are never bounded
+     */
+    void set_staleness(int staleness) { this->staleness = staleness; }
+
+    /*!
+     * The following function sets the cache blocking of the sweep of the sequential, native threads and FastFlow
+     * Jacobi engines: the rows are computed in blocks that reuse each tile of the variables while it is in cache.
+     * @param tiling [Tiling] := tiles of the sweep, tiling.columns = 0 restores the plain sweep
+     */
+    void set_tiling(const Tiling &tiling) { this->tiling = tiling; }
+
+    /*!
+     * The following function sets how the rows are assigned to the workers of the native threads Jacobi engine.
+     * @param schedule [Schedule] := static chunks, or blocks of the chunks that the workers steal from each other
+     */
+    void set_schedule(const Schedule &schedule) { this->schedule = schedule; }
+
+    /*!
+     * The following function sets the grain of the chunks and the waiting policy of the FastFlow Jacobi engine.
+     * @param options [FastFlowOptions] := fixed or tuned grain, sleeping or spinning workers
+     */
+    void set_fast_flow(const FastFlowOptions &options) { this->fast_flow = options; }
+
+    /*!
+     * The following function enables the counting of the hardware events (cycles, instructions, LLC misses and stall
+     * cycles) of each solve: the ones of the calling thread, of the threads created by the engine and of the workers
+     * of the pool. The counters that the kernel does not allow are reported as not available.
+     * @param enabled [bool] := true if the events must be counted
+     */
+    void set_counters(bool enabled);
+
+    /*!
+     * @return events [const PerfSample &] := hardware events of the last solve, not available if they are not counted
+     */
+    const PerfSample &counters() const { return events; }
+
+    /*!
+     * The following function enables the tracing of the native threads and FastFlow Jacobi engines: each solve records
+     * when each worker computes its rows, waits at the barrier and when the serial part of each iteration runs.
+     * @param enabled [bool] := true if the timeline must be recorded
+     */
+    void set_tracing(bool enabled) { tracer = enabled ? make_unique<Tracer>() : nullptr; }
+
+    /*!
+     * @return tracer [const Tracer *] := timeline of the last traced solve, nullptr if the tracing is disabled
+     */
+    const Tracer *trace() const { return tracer.get(); }
+
+    /*!
+     * The following function sets the stopping criteria of the sequential, native threads and FastFlow Jacobi engines
+     * and how often it is checked.
+     * @param convergence [Convergence] := criterion (increment, residual or max-norm) and cadence of the checks
+     */
+    void set_convergence(const Convergence &convergence) { this->convergence = convergence; }
+
+    /*!
+     * The following function enables the warm start: each solve of the Jacobi's Algorithm starts from the solution of
+     * the previous one (or from the initial guess) instead of zero, and reuses the reciprocals of the diagonal. When
+     * consecutive systems differ slightly, the solution of the previous one is close to the new one and fewer sweeps
+     * reach the tolerance.
+     * @param enabled [bool] := true if the solves must start from the last solution, false to start from zero
+     */
+    void set_warm_start(bool enabled) { workspace.warm = enabled; }
+
+    /*!
+     * The following function sets the solution from which the next solve starts, and enables the warm start.
+     * @param guess [vector<float>] := initial value of the variables
+     * @throw invalid_argument if the dimension of the guess is not the one of the system
+     */
+    void set_initial_guess(const vector<float> &guess);
+
+    /*!
+     * The following function changes some elements of the vector b, b[i] += delta. From now on the solver uses its
+     * own copy of the vector.
+     * @param delta [vector<pair<int, float>>] := the pairs (i, delta) of the elements that change
+     * @throw out_of_range if an index is not a row of the system
+     */
+    void update_known_term(const vector<pair<int, float>> &delta);
+
+    /*!
+     * The following function replaces a row of the matrix A and updates the reciprocal of its diagonal element, so the
+     * next warm solve does not recompute the diagonal. From now on the solver uses its own copy of the matrix; if the
+     * matrix is stored in reduced precision, it is converted again.
+     * @param i [int] := index of the row
+     * @param row [vector<float>] := new elements of the row
+     * @throw out_of_range if the row is not a row of the system or its dimension is not the one of the system
+     */
+    void update_row(int i, const vector<float> &row);
+
+    /*!
+     * The following function computes the rank-1 update A += u v^T, where u has few non-zero elements, so only the
+     * rows of the non-zero elements of u are changed and only their diagonal elements are updated. From now on the
+     * solver uses its own copy of the matrix; if the matrix is stored in reduced precision, it is converted again.
+     * @param u [vector<pair<int, float>>] := the pairs (i, u[i]) of the non-zero elements of u
+     * @param v [vector<float>] := the vector v
+     * @throw out_of_range if an index is not a row of the system or v has not the dimension of the system
+     */
+    void rank_one_update(const vector<pair<int, float>> &u, const vector<float> &v);
+
+    /*!
+     * The following function shuts down the pool of the native threads engine and releases its workers. A new pool
+     * is created by the next solve that needs it.
+     */
+    void release_threads();
+
+    /*!
+     * @return size [int] := dimension of the linear system
+     */
+    int size() const { return knownTerm->size(); }
+
+    /*!
+     * @return iterations [int] := sweeps computed by the last solve of the Jacobi's Algorithm (seq, thr, ff and async
+     * engines, the sweeps of the slowest thread for async)
+     */
+    int iterations() const { return workspace.iterations; }
+
+    /*!
+     * @return checks [int] := iterations whose stopping criteria was checked by the last solve of the Jacobi's
+     * Algorithm (seq, thr and ff engines)
+     */
+    int checks() const { return workspace.checks; }
+
+    /*!
+     * @return matrix [const Matrix &] := matrix A of the linear system, in single precision
+     */
+    const Matrix &system_matrix() const { return *matrix; }
+
+    /*!
+     * @return knownTerm [const vector<float> &] := vector b of the linear system
+     */
+    const vector<float> &known_term() const { return *knownTerm; }
+};
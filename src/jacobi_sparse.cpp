@@ -0,0 +1,194 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <barrier>
+#include <memory>
+#include "utimer.cpp"
+#include "jacobi_sparse.h"
+#include "convergence.h"
+using namespace std;
+
+
+/*!
+ * The following function computes the sequential version of the Jacobi's Algorithm on a sparse matrix. Differently
+ * from the dense engine there is no separate function for the disabled tolerance: the stopping criteria is
+ * accumulated by the sweep anyway and the only comparison is done once per iteration, outside of the rows.
+ * @param matrix [SparseMatrix] := sparse matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm (disabled if smaller than 0)
+ * @param seq_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+template <typename SparseMatrix>
+static const vector<float> &seq_sparse_jacobi(const SparseMatrix &matrix, const vector<float> &knownTerm, int K,
+                                              double tolerance, long &seq_time, JacobiWorkspace &workspace){
+
+    workspace.reset(matrix.diagonal);
+    vector<float> &curr_variables = workspace.curr_variables;
+    vector<float> &prev_variables = workspace.prev_variables;
+    const vector<float> &inverse_diagonal = workspace.inverse_diagonal;
+    int units = sparse_units(matrix);
+    long double similarity;
+
+    {
+        utimer seq = utimer("Sequential sparse Jacobi", &seq_time);
+        for(int k = 0; k < K; k++){
+            swap(prev_variables, curr_variables); // the last solution becomes the previous one without copying it
+            ConvergencePartial partial;
+            sparse_sweep(matrix, 0, units, prev_variables.data(), curr_variables.data(), knownTerm.data(),
+                         inverse_diagonal.data(), &partial);
+            if(tolerance >= 0){
+                similarity = sqrt(partial.difference) / sqrt(partial.norm);
+                if(similarity <= tolerance){
+                    cout << k <<")Sequential Jacobi interrupted because " << similarity << " (" <<
+                         criterion_name(StoppingCriterion::INCREMENT) << ") <= " << tolerance << " (tolerance)" << endl;
+                    break;
+                }
+            }
+        }
+    }
+    return curr_variables;
+}
+
+
+/*!
+ * The following function computes the parallel version of the Jacobi's Algorithm on a sparse matrix using the native
+ * threads implementation.
+ * @param matrix [SparseMatrix] := sparse matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm (disabled if smaller than 0)
+ * @param thr_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
+ * @param schedule [Schedule] := assignment of the work units to the threads
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+template <typename SparseMatrix>
+static const vector<float> &thr_sparse_jacobi(const SparseMatrix &matrix, const vector<float> &knownTerm, int K,
+                                              int num_threads, double tolerance, long &thr_time,
+                                              JacobiWorkspace &workspace, ThreadPool &pool, const Schedule &schedule){
+
+    workspace.reset(matrix.diagonal);
+    vector<float> &curr_variables = workspace.curr_variables;
+    vector<float> &prev_variables = workspace.prev_variables;
+    const vector<float> &inverse_diagonal = workspace.inverse_diagonal;
+    vector<ConvergencePartial> &partials = workspace.partials;
+    vector<int> bounds = sparse_split(matrix, num_threads);
+    bool check = tolerance >= 0;
+    int iterations = K;
+    long double similarity;
+
+    partials.resize(num_threads);
+    bool steal = schedule.policy == SchedulePolicy::STEAL;
+    unique_ptr<StealQueues> queues = steal ? make_unique<StealQueues>(bounds, schedule.block_rows) : nullptr;
+
+    auto on_completion = [&]() noexcept { // function called by the barrier each time the threads synchronize
+        iterations--;
+        if (steal) { // each thread gets back its blocks, so the stolen blocks return to their owner
+            queues->refill();
+        }
+        if (check) {
+            similarity = combine_partials(partials, num_threads);
+            if (similarity <= tolerance) {
+                cout << (K-iterations-1) <<")Parallel Jacobi interrupted because " << similarity <<
+                     " (" << criterion_name(StoppingCriterion::INCREMENT) << ") <= " << tolerance << " (tolerance)" <<
+                     endl;
+                iterations = 0;
+            }
+        }
+        if (iterations > 0) { // the last solution becomes the previous one without copying it
+            swap(prev_variables, curr_variables);
+        }
+    };
+
+    std::barrier ba(num_threads, on_completion);
+
+    auto body = [&](int tid) { // function executed by a single thread
+        while (iterations > 0) {
+            partials[tid] = ConvergencePartial();
+            if (steal) { // the sums of the stolen units are added to the partial of the thread that computed them
+                int first, last;
+                while (queues->next(tid, first, last)) {
+                    sparse_sweep(matrix, first, last, prev_variables.data(), curr_variables.data(), knownTerm.data(),
+                                 inverse_diagonal.data(), &partials[tid]);
+                }
+            }
+            else {
+                sparse_sweep(matrix, bounds[tid], bounds[tid + 1], prev_variables.data(), curr_variables.data(),
+                             knownTerm.data(), inverse_diagonal.data(), &partials[tid]);
+            }
+            ba.arrive_and_wait();
+        }
+    };
+
+    string timer = "PARALLEL " + to_string(num_threads) + " threads ";
+    {
+        utimer thr = utimer(timer, &thr_time);
+        pool.run(num_threads, body);
+    }
+    if(steal){
+        cout << "STOLEN BLOCKS: " << queues->stolen_blocks() << " (" << queues->blocks() << " blocks per iteration)"
+             << endl;
+    }
+    return curr_variables;
+}
+
+
+/*!
+ * The following function computes the sequential version of the Jacobi's Algorithm on a sparse matrix using the
+ * buffers of the workspace given as input.
+ * @param matrix [CSRMatrix or SellMatrix] := sparse matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param seq_time [long] := value passed by reference in which it will be stored the computation time of the sequential
+ * implementation
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &sequential_sparse_jacobi(const CSRMatrix &matrix, const vector<float> &knownTerm, int K,
+                                              double tolerance, long &seq_time, JacobiWorkspace &workspace){
+    return seq_sparse_jacobi(matrix, knownTerm, K, tolerance, seq_time, workspace);
+}
+
+
+const vector<float> &sequential_sparse_jacobi(const SellMatrix &matrix, const vector<float> &knownTerm, int K,
+                                              double tolerance, long &seq_time, JacobiWorkspace &workspace){
+    return seq_sparse_jacobi(matrix, knownTerm, K, tolerance, seq_time, workspace);
+}
+
+
+/*!
+ * The following function computes the parallel version of the Jacobi's Algorithm on a sparse matrix using the native
+ * threads implementation. The work units are split among the threads so that each thread receives about the same
+ * number of non-zero elements.
+ * @param matrix [CSRMatrix or SellMatrix] := sparse matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param thr_time [long] := value passed by reference in which it will be stored the computation time of the native
+ * threads implementation
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
+ * @param schedule [Schedule] := assignment of the work units to the threads, the balanced chunks by default
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &threads_sparse_jacobi(const CSRMatrix &matrix, const vector<float> &knownTerm, int K,
+                                           int num_threads, double tolerance, long &thr_time,
+                                           JacobiWorkspace &workspace, ThreadPool &pool, const Schedule &schedule){
+    return thr_sparse_jacobi(matrix, knownTerm, K, num_threads, tolerance, thr_time, workspace, pool, schedule);
+}
+
+
+const vector<float> &threads_sparse_jacobi(const SellMatrix &matrix, const vector<float> &knownTerm, int K,
+                                           int num_threads, double tolerance, long &thr_time,
+                                           JacobiWorkspace &workspace, ThreadPool &pool, const Schedule &schedule){
+    return thr_sparse_jacobi(matrix, knownTerm, K, num_threads, tolerance, thr_time, workspace, pool, schedule);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <vector>
+#include "sparse_matrix.h"
+#include "jacobi_workspace.h"
+#include "thread_pool.h"
+#include "scheduler.h"
+using namespace std;
+
+
+/*!
+ * The following function computes the sequential version of the Jacobi's Algorithm on a sparse matrix using the
+ * buffers of the workspace given as input.
+ * @param matrix [CSRMatrix or SellMatrix] := sparse matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param seq_time [long] := value passed by reference in which it will be stored the computation time of the sequential
+ * implementation
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &sequential_sparse_jacobi(const CSRMatrix &matrix, const vector<float> &knownTerm, int K,
+                                              double tolerance, long &seq_time, JacobiWorkspace &workspace);
+const vector<float> &sequential_sparse_jacobi(const SellMatrix &matrix, const vector<float> &knownTerm, int K,
+                                              double tolerance, long &seq_time, JacobiWorkspace &workspace);
+
+
+/*!
+ * The following function computes the parallel version of the Jacobi's Algorithm on a sparse matrix using the native
+ * threads implementation. The work units are split among the threads so that each thread receives about the same
+ * number of non-zero elements.
+ * @param matrix [CSRMatrix or SellMatrix] := sparse matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param thr_time [long] := value passed by reference in which it will be stored the computation time of the native
+ * threads implementation
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
+ * @param schedule [Schedule] := assignment of the work units to the threads: the balanced chunks by default, or blocks
+ * of the chunks that the threads steal from each other when they finish their own
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &threads_sparse_jacobi(const CSRMatrix &matrix, const vector<float> &knownTerm, int K,
+                                           int num_threads, double tolerance, long &thr_time,
+                                           JacobiWorkspace &workspace, ThreadPool &pool,
+                                           const Schedule &schedule = Schedule());
+const vector<float> &threads_sparse_jacobi(const SellMatrix &matrix, const vector<float> &knownTerm, int K,
+                                           int num_threads, double tolerance, long &thr_time,
+                                           JacobiWorkspace &workspace, ThreadPool &pool,
+                                           const Schedule &schedule = Schedule());
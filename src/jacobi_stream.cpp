@@ -0,0 +1,232 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <semaphore>
+#include <stdexcept>
+#include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "utimer.cpp"
+#include "row_kernel.h"
+#include "binary_format.h"
+#include "jacobi_stream.h"
+#include "convergence.h"
+using namespace std;
+
+
+/*!
+ * The following function reads a range of a file, retrying the partial reads.
+ * @param fd [int] := descriptor of the file
+ * @param buffer [char *] := buffer where the bytes are stored
+ * @param bytes [size_t] := number of bytes to read
+ * @param position [off_t] := offset of the first byte in the file
+ * @return read [bool] := true if all the bytes have been read, false on error or at the end of the file
+ */
+static bool read_fully(int fd, char *buffer, size_t bytes, off_t position){
+
+    while(bytes > 0){
+        ssize_t count = pread(fd, buffer, bytes, position);
+        if(count <= 0){
+            return false;
+        }
+        buffer += count;
+        bytes -= count;
+        position += count;
+    }
+    return true;
+}
+
+
+/*!
+ * The following function returns the dimension of a matrix streamed from a file: the binary format stores it in the
+ * header, a raw file (n*n floats in row-major order without padding) must have the size given as input.
+ * @param filename [string] := file where the matrix is stored
+ * @param n [int] := dimension of the matrix of a raw file, ignored (it can be 0) for the binary format
+ * @return n [int] := dimension of the matrix
+ * @throw runtime_error if the file cannot be opened or its size does not match the dimension
+ */
+int streamed_size(const string &filename, int n){
+
+    if(is_binary_file(filename)){
+        return read_binary_header(filename, BinaryKind::MATRIX).n;
+    }
+    struct stat status;
+    if(stat(filename.c_str(), &status) != 0){
+        throw runtime_error("Could not open the file '" + filename + "'");
+    }
+    if(n < 1 || (uint64_t) status.st_size != (uint64_t) n * n * sizeof(float)){
+        throw runtime_error("The raw file '" + filename + "' must contain exactly SIZE*SIZE floats");
+    }
+    return n;
+}
+
+
+/*!
+ * The following function computes the Jacobi's Algorithm out of core, reading the matrix in panels of rows with a
+ * prefetch thread and two buffers.
+ * @param filename [string] := file where the matrix A is stored, in the binary format or raw
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm (disabled if smaller than 0)
+ * @param panel_rows [int] := number of rows of each panel, if smaller than 1 the panels are about STREAM_PANEL_BYTES
+ * @param stream_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param report [StreamReport] := value passed by reference in which it will be stored the time of the reads
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ * @throw runtime_error if the file cannot be read
+ */
+const vector<float> &streaming_jacobi(const string &filename, const vector<float> &knownTerm, int K, double tolerance,
+                                      int panel_rows, long &stream_time, JacobiWorkspace &workspace,
+                                      StreamReport &report){
+
+    int n = knownTerm.size();
+    if(streamed_size(filename, n) != n){
+        throw runtime_error("The matrix in '" + filename + "' and the known term have different sizes");
+    }
+    bool binary = is_binary_file(filename);
+    off_t offset = binary ? read_binary_header(filename, BinaryKind::MATRIX).payload_offset : 0;
+    int stride = binary ? read_binary_header(filename, BinaryKind::MATRIX).stride : n;
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0){
+        throw runtime_error("Could not open the file '" + filename + "'");
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    if(K <= 0){
+        K = n;
+        cout << "K set to n because it was <= 0" << endl;
+    }
+    if(panel_rows < 1){
+        panel_rows = (int) max(1L, STREAM_PANEL_BYTES / ((long) stride * (long) sizeof(float)));
+    }
+    panel_rows = min(panel_rows, n);
+    int panels = (n + panel_rows - 1) / panel_rows;
+
+    vector<float> &curr_variables = workspace.curr_variables;
+    vector<float> &prev_variables = workspace.prev_variables;
+    curr_variables.assign(n, 0.0);
+    prev_variables.assign(n, 0.0);
+    vector<float> buffers[2] = {vector<float>((size_t) panel_rows * stride),
+                                vector<float>((size_t) panel_rows * stride)};
+    // empty[b] is released when the buffer b can be overwritten, full[b] when the next panel has been read into it
+    counting_semaphore<2> empty[2] = {counting_semaphore<2>(1), counting_semaphore<2>(1)};
+    counting_semaphore<2> full[2] = {counting_semaphore<2>(0), counting_semaphore<2>(0)};
+    atomic<bool> stop{false};
+    // written by the prefetch thread before releasing full, so the computation reads it only right after acquiring full
+    // (and keeps the outcome in failed) or after the join
+    string error;
+    bool failed = false;
+    report = StreamReport();
+
+    // the prefetch thread reads the panels of all the iterations in order, one buffer ahead of the computation
+    thread prefetch([&]() {
+        long sequence = 0;
+        for(int k = 0; k < K; k++){
+            for(int p = 0; p < panels; p++, sequence++){
+                int b = sequence % 2;
+                empty[b].acquire();
+                if(stop.load(memory_order_relaxed)){
+                    return;
+                }
+                int first = p * panel_rows;
+                size_t bytes = (size_t) min(panel_rows, n - first) * stride * sizeof(float);
+                off_t position = offset + (off_t) first * stride * sizeof(float);
+                START(read_start);
+                bool read = read_fully(fd, reinterpret_cast<char *>(buffers[b].data()), bytes, position);
+                STOP(read_start, read_elapsed);
+                report.read_time += read_elapsed;
+                report.read_bytes += bytes;
+                if(!read){
+                    error = "Could not read the rows from " + to_string(first) + " of the file '" + filename + "'";
+                    full[b].release();
+                    return;
+                }
+                posix_fadvise(fd, position, bytes, POSIX_FADV_DONTNEED); // the panel is copied, the pages can go
+                full[b].release();
+            }
+        }
+    });
+
+    long double similarity;
+    long sequence = 0;
+    {
+        utimer stream = utimer("Streaming Jacobi", &stream_time);
+        for(int k = 0; k < K && !failed; k++){
+            swap(prev_variables, curr_variables); // the last solution becomes the previous one without copying it
+            double difference = 0;
+            double norm = 0;
+            for(int p = 0; p < panels; p++, sequence++){
+                int b = sequence % 2;
+                START(wait_start);
+                full[b].acquire();
+                STOP(wait_start, wait_elapsed);
+                report.stall_time += wait_elapsed;
+                failed = !error.empty();
+                if(failed){
+                    break;
+                }
+                int first = p * panel_rows;
+                int last = min(first + panel_rows, n);
+                START(compute_start);
+                for(int i = first; i < last; i++){ // the diagonal is read from the panel, so it is never resident
+                    const float *row = buffers[b].data() + (size_t) (i - first) * stride;
+                    float variable = jacobi_row(row, prev_variables.data(), knownTerm[i], 1.0f / row[i], i, n);
+                    float delta = variable - prev_variables[i];
+                    difference += delta * delta;
+                    norm += variable * variable;
+                    curr_variables[i] = variable;
+                }
+                STOP(compute_start, compute_elapsed);
+                report.compute_time += compute_elapsed;
+                report.bytes += (long long) (last - first) * stride * sizeof(float);
+                report.panels++;
+                empty[b].release();
+            }
+            similarity = sqrt(difference) / sqrt(norm);
+            if(!failed && tolerance >= 0 && similarity <= tolerance){
+                cout << k << ")Streaming Jacobi interrupted because " << similarity << " (" <<
+                     criterion_name(StoppingCriterion::INCREMENT) << ") <= " << tolerance << " (tolerance)" << endl;
+                break;
+            }
+        }
+        // the prefetch thread may be waiting for a buffer of a panel that will never be computed
+        stop.store(true, memory_order_relaxed);
+        empty[0].release();
+        empty[1].release();
+        prefetch.join();
+    }
+    close(fd);
+    if(!error.empty()){
+        throw runtime_error(error);
+    }
+    return curr_variables;
+}
+
+
+/*!
+ * The following function prints the bandwidth of the reads and of the computation of an out-of-core solve.
+ * @param report [StreamReport] := time of the reads of the solve
+ */
+void print_stream_report(const StreamReport &report){
+
+    // bytes per microsecond are MB/s
+    // the reads are measured on all the bytes read, the panel read ahead of an early stop included
+    double disk_bandwidth = report.read_time > 0 ? (double) report.read_bytes / report.read_time : INFINITY;
+    double compute_bandwidth = report.compute_time > 0 ? (double) report.bytes / report.compute_time : INFINITY;
+    cout << "PANELS COMPUTED: " << report.panels << " (" << report.bytes / 1e6 << " MB)" << endl;
+    cout << "DISK BANDWIDTH: " << disk_bandwidth << " MB/s (" << report.read_bytes / 1e6 << " MB in " <<
+         report.read_time << " usec)" << endl;
+    cout << "COMPUTE BANDWIDTH: " << compute_bandwidth << " MB/s (" << report.compute_time << " usec)" << endl;
+    cout << "STALL TIME: " << report.stall_time << " usec" << endl;
+    if(disk_bandwidth < compute_bandwidth){
+        cout << "The solve is bound by the disk: the reads cannot be hidden with any panel size" << endl;
+    }
+    else if(report.stall_time > report.compute_time / 10){
+        cout << "The disk is faster than the computation but the reads are not hidden: use larger panels" << endl;
+    }
+    else{
+        cout << "The reads are hidden by the computation" << endl;
+    }
+}
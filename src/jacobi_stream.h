@@ -0,0 +1,62 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "jacobi_workspace.h"
+using namespace std;
+
+
+#define STREAM_PANEL_BYTES (64L << 20) // default size of a panel of rows read from the file
+
+
+/*!
+ * The following structure stores where the time of an out-of-core solve has been spent, so that the panels can be
+ * sized to hide the reads: the I/O is hidden when the read time is not larger than the compute time.
+ */
+struct StreamReport {
+    long long read_bytes = 0; // bytes of the matrix read from the file, with the panel read ahead of an early stop
+    long long bytes = 0; // bytes of the panels computed
+    long panels = 0; // number of panels computed
+    long read_time = 0; // usec spent by the prefetch thread reading the panels
+    long compute_time = 0; // usec spent computing the rows of the panels
+    long stall_time = 0; // usec spent by the computing thread waiting for a panel not read yet
+};
+
+
+/*!
+ * The following function returns the dimension of a matrix streamed from a file: the binary format stores it in the
+ * header, a raw file (n*n floats in row-major order without padding) must have the size given as input.
+ * @param filename [string] := file where the matrix is stored
+ * @param n [int] := dimension of the matrix of a raw file, ignored (it can be 0) for the binary format
+ * @return n [int] := dimension of the matrix
+ * @throw runtime_error if the file cannot be opened or its size does not match the dimension
+ */
+int streamed_size(const string &filename, int n);
+
+
+/*!
+ * The following function computes the Jacobi's Algorithm out of core: the matrix is never resident, its rows are read
+ * from the file in panels of panel_rows rows at each iteration. A prefetch thread reads the next panel into one of two
+ * buffers while the rows of the current panel are computed from the other one (double buffering), and the pages read
+ * are dropped from the page cache, so the memory used is two panels whatever the size of the matrix.
+ * @param filename [string] := file where the matrix A is stored, in the binary format or raw
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param panel_rows [int] := number of rows of each panel, if smaller than 1 the panels are about STREAM_PANEL_BYTES
+ * @param stream_time [long] := value passed by reference in which it will be stored the computation time
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param report [StreamReport] := value passed by reference in which it will be stored the time of the reads
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ * @throw runtime_error if the file cannot be read
+ */
+const vector<float> &streaming_jacobi(const string &filename, const vector<float> &knownTerm, int K, double tolerance,
+                                      int panel_rows, long &stream_time, JacobiWorkspace &workspace,
+                                      StreamReport &report);
+
+
+/*!
+ * The following function prints the bandwidth of the reads and of the computation of an out-of-core solve.
+ * @param report [StreamReport] := time of the reads of the solve
+ */
+void print_stream_report(const StreamReport &report);
@@ -1,37 +1,114 @@
 #include "jacobi_threads.h"
 #include <vector>
 #include <thread>
+#include "thread_pool.h"
 #include <barrier>
+#include <memory>
 #include "utility.h"
+#include "row_kernel.h"
+#include "scheduler.h"
+#include "trace.h"
+#include "convergence.h"
 #include "utimer.cpp"
 #include <iostream>
 using namespace std;
 
 
+/*!
+ * The following function prepares a replica of the variables for each NUMA node spanned by the workers. Each replica
+ * is first touched by a worker of its node, so that it is placed in the memory of that node.
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
+ * @param num_threads [int] := number of threads used to parallelize
+ * @return replicate [bool] := true if the workers span more than one node and so the replicas must be used
+ */
+static bool prepare_replicas(JacobiWorkspace &workspace, ThreadPool &pool, int num_threads){
+
+    int nodes = pool.numa_nodes(num_threads);
+    if(nodes == 1){
+        return false;
+    }
+    workspace.replicas.resize(nodes);
+    auto body = [&](int tid) {
+        int node = pool.node(tid);
+        for(int t = 0; t < tid; t++){ // only the first worker of each node initializes the replica
+            if(pool.node(t) == node){
+                return;
+            }
+        }
+        NodeReplica &replica = workspace.replicas[node];
+        replica.prev_variables.assign(workspace.prev_variables.begin(), workspace.prev_variables.end());
+        replica.curr_variables.assign(workspace.curr_variables.begin(), workspace.curr_variables.end());
+    };
+    pool.run(num_threads, body);
+    return true;
+}
+
+
+/*!
+ * The following function stores the new value of a variable in every replica of the variables.
+ * @param replicas [vector<NodeReplica>] := replicas of the variables
+ * @param i [int] := index of the variable
+ * @param variable [float] := new value of the variable
+ */
+static inline void store_in_replicas(vector<NodeReplica> &replicas, int i, float variable){
+
+    for(NodeReplica &replica : replicas){
+        if(!replica.curr_variables.empty()){ // the nodes without workers have no replica
+            replica.curr_variables[i] = variable;
+        }
+    }
+}
+
+
+/*!
+ * The following function makes the last solution the previous one, both in the workspace and in the replicas,
+ * without copying it.
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param replicate [bool] := true if the replicas are used
+ */
+static inline void swap_variables(JacobiWorkspace &workspace, bool replicate){
+
+    swap(workspace.prev_variables, workspace.curr_variables);
+    if(replicate){
+        for(NodeReplica &replica : workspace.replicas){
+            swap(replica.prev_variables, replica.curr_variables);
+        }
+    }
+}
+
+
 /*!
  * The following function is called from threads_jacobi and it is called only if the tolerance input in
  * threads_jacobi is disabled (smaller than 0). Even if it is redundant I adopted this choice in order to avoid
  * at each step the comparison
- * @param matrix [vector<vector<float>>] := matrix A of the linear system (Ax=b)
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
  * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
  * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
  * @param num_threads [int] := number of threads used to parallelize
  * @param ff_time [long] := value passed by reference in which it will be stored the computation time of the native
  * threads implementation
- * @return solution [vector<float>] := solution vector that best approximates the linear system Ax=b.
+ * @param workspace [JacobiWorkspace] := buffers used during the computation, the solution is stored in curr_variables
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
  */
-vector<float> thr_jacobi(vector<vector<float>> matrix, vector<float> knownTerm, int K, int num_threads, long &thr_time){
+template <typename DenseMatrix>
+static void thr_jacobi(const DenseMatrix &matrix, const vector<float> &knownTerm, int K, int num_threads,
+                       long &thr_time, JacobiWorkspace &workspace, ThreadPool &pool){
 
     int n = knownTerm.size();
-    vector<float> curr_variables(n, 0.0);
-    vector<float> prev_variables(n, 0.0);
-    vector<thread> threads(num_threads);
+    vector<float> &curr_variables = workspace.curr_variables;
+    vector<float> &prev_variables = workspace.prev_variables;
+    const vector<float> &inverse_diagonal = workspace.inverse_diagonal;
     int chunk = n / num_threads;
     int iterations = K;
+    bool replicate = prepare_replicas(workspace, pool, num_threads);
 
     auto on_completion = [&]() noexcept { // function called by the barrier each time the threads synchronize
         iterations--;
-        prev_variables = curr_variables;
+        workspace.iterations++;
+        if (iterations > 0) { // the last solution becomes the previous one without copying it
+            swap_variables(workspace, replicate);
+        }
     };
 
     std::barrier ba(num_threads, on_completion);
@@ -40,15 +117,15 @@ vector<float> thr_jacobi(vector<vector<float>> matrix, vector<float> knownTerm,
 
         int start = tid * chunk;
         int end = (tid != num_threads - 1 ? start + chunk : n) - 1;
+        NodeReplica *replica = replicate ? &workspace.replicas[pool.node(tid)] : nullptr;
         while (iterations > 0) {
+            // with the replicas, the variables are read from the copy placed on the node of the thread
+            const float *variables = replica != nullptr ? replica->prev_variables.data() : prev_variables.data();
             for (int i = start; i <= end; i++) {
-                float sum = 0;
-                for (int j = 0; j < n; j++) {
-                    if (i != j) {
-                        sum += matrix[i][j] * prev_variables[j];
-                    }
+                curr_variables[i] = jacobi_row(matrix, i, variables, knownTerm[i], inverse_diagonal[i]);
+                if (replicate) {
+                    store_in_replicas(workspace.replicas, i, curr_variables[i]);
                 }
-                curr_variables[i] = (knownTerm[i] - sum) / matrix[i][i];
             }
             ba.arrive_and_wait();
         }
@@ -57,21 +134,15 @@ vector<float> thr_jacobi(vector<vector<float>> matrix, vector<float> knownTerm,
     string timer = "PARALLEL " + to_string(num_threads) + " threads ";
     {
         utimer thr = utimer(timer, &thr_time);
-        for (int i = 0; i < num_threads; i++) {
-            threads[i] = thread(body, i);
-        }
-        for (int i = 0; i < num_threads; i++) {
-            threads[i].join();
-        }
+        pool.run(num_threads, body);
     }
-    return curr_variables;
 }
 
 
 /*!
  * The following function computes the parallel version of the Jacobi's Algorithm using the native threads
  * implementation.
- * @param matrix [vector<vector<float>>] := matrix A of the linear system (Ax=b)
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
  * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
  * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
  * @param num_threads [int] := number of threads used to parallelize
@@ -79,64 +150,203 @@ vector<float> thr_jacobi(vector<vector<float>> matrix, vector<float> knownTerm,
  * stopping criteria ||(current - previous)|| / ||current||
  * @param thr_time [long] := value passed by reference in which it will be stored the computation time of the native
  * threads implementation
- * @return solution [vector<float>] := solution vector that best approximates the linear system Ax=b.
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
+ * @param tiling [Tiling] := tiles of the cache-blocked sweep, the sweep is not tiled if tiling.columns is 0
+ * @param schedule [Schedule] := assignment of the rows to the threads
+ * @param tracer [Tracer *] := timeline of the workers, nullptr if it is not recorded
+ * @param convergence [Convergence] := stopping criteria and cadence of its checks
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
  */
-vector<float> threads_jacobi(vector<vector<float>> matrix, vector<float> knownTerm, int K, int num_threads,
-                            double tolerance, long &thr_time){
+template <typename DenseMatrix>
+static const vector<float> &threads_solve(const DenseMatrix &matrix, const vector<float> &knownTerm, int K,
+                                          int num_threads, double tolerance, long &thr_time, JacobiWorkspace &workspace,
+                                          ThreadPool &pool, const Tiling &tiling, const Schedule &schedule,
+                                          Tracer *tracer, const Convergence &convergence){
 
-    if (tolerance < 0){ // it avoids to check the if statement when the tolerance is not used
-        return thr_jacobi(matrix, knownTerm, K, num_threads, thr_time);
+    int n = knownTerm.size();
+    workspace.reset(matrix);
+    bool steal = schedule.policy == SchedulePolicy::STEAL;
+
+    // it avoids to check the if statement when the tolerance is not used
+    if(tolerance < 0 && tiling.columns == 0 && !steal && tracer == nullptr){
+        thr_jacobi(matrix, knownTerm, K, num_threads, thr_time, workspace, pool);
+        return workspace.curr_variables;
     }
 
-    int n = knownTerm.size();
-    vector<float> curr_variables(n, 0.0);
-    vector<float> prev_variables(n, 0.0);
-    vector<thread> threads(num_threads);
+    vector<float> &curr_variables = workspace.curr_variables;
+    vector<float> &prev_variables = workspace.prev_variables;
+    const vector<float> &inverse_diagonal = workspace.inverse_diagonal;
     int chunk = n / num_threads;
     int iterations = K;
+    vector<ConvergencePartial> &partials = workspace.partials;
+    StoppingCriterion criterion = convergence.criterion;
+    ConvergenceMonitor monitor(convergence, tolerance); // it is updated only by the completion function
     long double similarity;
+    bool replicate = prepare_replicas(workspace, pool, num_threads);
 
-    auto on_completion = [&]() noexcept { // function called by the barrier each time the threads synchronize
+    partials.resize(num_threads);
+    vector<int> bounds(num_threads + 1); // the static chunks, which are also the blocks owned by each thread
+    for(int t = 0; t < num_threads; t++){
+        bounds[t] = t * chunk;
+    }
+    bounds[num_threads] = n;
+    unique_ptr<StealQueues> queues = steal ? make_unique<StealQueues>(bounds, schedule.block_rows) : nullptr;
+
+    // function called by the barrier each time the threads synchronize: it only combines the partial sums of the
+    // threads, so the serial part of each iteration is O(num_threads) instead of O(n)
+    auto on_completion = [&]() noexcept {
+        long completion_start = tracer != nullptr ? tracer->now() : 0;
+        int iteration = workspace.iterations;
         iterations--;
-        similarity = stopping_criteria(curr_variables, prev_variables);
-        if (similarity <= tolerance) {
-            cout << (K-iterations-1) <<")Parallel Jacobi interrupted because " << similarity << " (similarity) <= " <<
-                 tolerance << " (tolerance)" << endl;
-            iterations = 0;
+        workspace.iterations++;
+        if (steal) { // each thread gets back its blocks, so the stolen blocks return to their owner
+            queues->refill();
+        }
+        if (monitor.due(iteration)) {
+            workspace.checks++;
+            similarity = combine_partials(partials, num_threads, criterion);
+            if (monitor.converged(iteration, similarity)) {
+                cout << (K-iterations-1) <<")Parallel Jacobi interrupted because " << similarity << " (" <<
+                     criterion_name(criterion) << ") <= " << tolerance << " (tolerance)" << endl;
+                iterations = 0;
+            }
+        }
+        if (iterations > 0) { // the last solution becomes the previous one without copying it
+            swap_variables(workspace, replicate);
+        }
+        if (tracer != nullptr) { // the completion has its own track, since it runs on the last thread that arrives
+            tracer->record(num_threads, TracePhase::COMPLETION, iteration, completion_start, tracer->now());
         }
-        prev_variables = curr_variables;
     };
 
     std::barrier ba(num_threads, on_completion);
 
+    // function that computes the rows in [first, last) reading the given variables, the stopping criteria is
+    // accumulated in the partial sums only if the iteration is checked
+    auto sweep = [&](int first, int last, const float *variables, ConvergencePartial &partial, bool check) {
+        if (tiling.columns > 0) { // the rows are computed in blocks that reuse each tile of the variables in cache
+            tiled_sweep(matrix, first, last, variables, curr_variables.data(), knownTerm.data(),
+                        inverse_diagonal.data(), tiling, partial, criterion);
+            for (int i = first; i < last && replicate; i++) {
+                store_in_replicas(workspace.replicas, i, curr_variables[i]);
+            }
+        }
+        else {
+            for (int i = first; i < last; i++) { // the stopping criteria is accumulated while the rows are computed
+                float variable = jacobi_row(matrix, i, variables, knownTerm[i], inverse_diagonal[i]);
+                if (check) {
+                    accumulate_row(partial, criterion, variable, variables[i], knownTerm[i], inverse_diagonal[i]);
+                }
+                curr_variables[i] = variable;
+                if (replicate) {
+                    store_in_replicas(workspace.replicas, i, variable);
+                }
+            }
+        }
+    };
+
     auto body = [&](int tid) { // function executed by a single thread
 
-        int start = tid * chunk;
-        int end = (tid != num_threads - 1 ? start + chunk : n) - 1;
-        while (iterations > 0) {
-            for (int i = start; i <= end; i++) {
-                float sum = 0;
-                for (int j = 0; j < n; j++) {
-                    if (i != j) {
-                        sum += matrix[i][j] * prev_variables[j];
-                    }
+        NodeReplica *replica = replicate ? &workspace.replicas[pool.node(tid)] : nullptr;
+        for (int k = 0; iterations > 0; k++) {
+            long compute_start = tracer != nullptr ? tracer->now() : 0;
+            // with the replicas, the variables are read from the copy placed on the node of the thread
+            const float *variables = replica != nullptr ? replica->prev_variables.data() : prev_variables.data();
+            bool check = monitor.due(k); // the monitor is changed only by the completion, before the barrier opens
+            ConvergencePartial partial;
+            if (steal) { // the sums of the stolen rows are added to the partial of the thread that computed them
+                int first, last;
+                while (queues->next(tid, first, last)) {
+                    sweep(first, last, variables, partial, check);
                 }
-                curr_variables[i] = (knownTerm[i] - sum) / matrix[i][i];
             }
+            else {
+                sweep(bounds[tid], bounds[tid + 1], variables, partial, check);
+            }
+            partials[tid] = partial;
+            long compute_end = tracer != nullptr ? tracer->now() : 0;
             ba.arrive_and_wait();
+            if (tracer != nullptr) {
+                tracer->record(tid, TracePhase::COMPUTE, k, compute_start, compute_end);
+                tracer->record(tid, TracePhase::BARRIER, k, compute_end, tracer->now());
+            }
         }
     };
 
     string timer = "PARALLEL " + to_string(num_threads) + " threads ";
+    if (tracer != nullptr) {
+        tracer->start(timer, num_threads);
+    }
     {
         utimer seq = utimer(timer, &thr_time);
-        for (int i = 0; i < num_threads; i++) {
-            threads[i] = thread(body, i);
-        }
-        for (int i = 0; i < num_threads; i++) {
-            threads[i].join();
-        }
+        pool.run(num_threads, body);
+    }
+    if(steal){
+        cout << "STOLEN BLOCKS: " << queues->stolen_blocks() << " (" << queues->blocks() << " blocks per iteration)"
+             << endl;
     }
 
     return curr_variables;
 }
+
+
+/*!
+ * The following function computes the parallel version of the Jacobi's Algorithm using the native threads
+ * implementation.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param thr_time [long] := value passed by reference in which it will be stored the computation time of the native
+ * threads implementation
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
+ * @param tiling [Tiling] := tiles of the cache-blocked sweep, the sweep is not tiled if tiling.columns is 0
+ * @param schedule [Schedule] := assignment of the rows to the threads, static chunks by default
+ * @param tracer [Tracer *] := timeline of the workers, nullptr (default) if it is not recorded
+ * @param convergence [Convergence] := stopping criteria and cadence of its checks, the increment at every iteration
+ * by default
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &threads_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, int num_threads,
+                                    double tolerance, long &thr_time, JacobiWorkspace &workspace, ThreadPool &pool,
+                                    const Tiling &tiling, const Schedule &schedule, Tracer *tracer,
+                                    const Convergence &convergence){
+    return threads_solve(matrix, knownTerm, K, num_threads, tolerance, thr_time, workspace, pool, tiling, schedule,
+                         tracer, convergence);
+}
+
+
+const vector<float> &threads_jacobi(const PrecisionMatrix &matrix, const vector<float> &knownTerm, int K,
+                                    int num_threads, double tolerance, long &thr_time, JacobiWorkspace &workspace,
+                                    ThreadPool &pool, const Tiling &tiling, const Schedule &schedule, Tracer *tracer,
+                                    const Convergence &convergence){
+    return threads_solve(matrix, knownTerm, K, num_threads, tolerance, thr_time, workspace, pool, tiling, schedule,
+                         tracer, convergence);
+}
+
+
+/*!
+ * The following function computes the parallel version of the Jacobi's Algorithm using the native threads
+ * implementation.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param thr_time [long] := value passed by reference in which it will be stored the computation time of the native
+ * threads implementation
+ * @return solution [vector<float>] := solution vector that best approximates the linear system Ax=b.
+ */
+vector<float> threads_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, int num_threads,
+                             double tolerance, long &thr_time){
+
+    JacobiWorkspace workspace;
+    ThreadPool pool(num_threads);
+    threads_jacobi(matrix, knownTerm, K, num_threads, tolerance, thr_time, workspace, pool);
+    return std::move(workspace.curr_variables);
+}
@@ -1,11 +1,18 @@
 #include <vector>
+#include "matrix.h"
+#include "jacobi_workspace.h"
+#include "tiling.h"
+#include "scheduler.h"
+#include "trace.h"
+#include "convergence.h"
+#include "thread_pool.h"
 using namespace std;
 
 
 /*!
  * The following function computes the parallel version of the Jacobi's Algorithm using the native threads
  * implementation.
- * @param matrix [vector<vector<float>>] := matrix A of the linear system (Ax=b)
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
  * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
  * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
  * @param num_threads [int] := number of threads used to parallelize
@@ -15,7 +22,39 @@ using namespace std;
  * threads implementation
  * @return solution [vector<float>] := solution vector that best approximates the linear system Ax=b.
  */
-vector<float> threads_jacobi(vector<vector<float>> matrix, vector<float> knownTerm, int K, int num_threads,
-                            double tolerance, long &thr_time);
+vector<float> threads_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, int num_threads,
+                             double tolerance, long &thr_time);
 
 
+/*!
+ * The following function computes the parallel version of the Jacobi's Algorithm using the native threads
+ * implementation, the buffers of the workspace given as input and the workers of the pool given as input, so that no
+ * vector is allocated if the workspace has already been used for a system of the same size and no thread is created.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm allowed
+ * @param num_threads [int] := number of threads used to parallelize
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm and it uses the following
+ * stopping criteria ||(current - previous)|| / ||current||
+ * @param thr_time [long] := value passed by reference in which it will be stored the computation time of the native
+ * threads implementation
+ * @param workspace [JacobiWorkspace] := buffers used during the computation
+ * @param pool [ThreadPool] := pool of at least num_threads workers that compute the rows
+ * @param tiling [Tiling] := tiles of the cache-blocked sweep, the sweep is not tiled if tiling.columns is 0
+ * @param schedule [Schedule] := assignment of the rows to the threads: static chunks by default, or blocks of the
+ * chunks that the threads steal from each other when they finish their own
+ * @param tracer [Tracer *] := timeline of the compute, barrier and completion phases of the workers, nullptr
+ * (default) if it is not recorded
+ * @param convergence [Convergence] := stopping criteria and cadence of its checks, the increment at every iteration
+ * by default
+ * @return solution [const vector<float> &] := reference to the solution vector stored in the workspace.
+ */
+const vector<float> &threads_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, int num_threads,
+                                    double tolerance, long &thr_time, JacobiWorkspace &workspace, ThreadPool &pool,
+                                    const Tiling &tiling = Tiling(), const Schedule &schedule = Schedule(),
+                                    Tracer *tracer = nullptr, const Convergence &convergence = Convergence());
+const vector<float> &threads_jacobi(const PrecisionMatrix &matrix, const vector<float> &knownTerm, int K,
+                                    int num_threads, double tolerance, long &thr_time, JacobiWorkspace &workspace,
+                                    ThreadPool &pool, const Tiling &tiling = Tiling(),
+                                    const Schedule &schedule = Schedule(), Tracer *tracer = nullptr,
+                                    const Convergence &convergence = Convergence());
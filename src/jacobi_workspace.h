@@ -0,0 +1,112 @@
+#pragma once
+#include <vector>
+#include "matrix.h"
+#include "precision.h"
+using namespace std;
+
+
+/*!
+ * The following structure stores the partial sums of the stopping criteria computed by a single worker on its rows.
+ * It is aligned to the cache line, so that two workers never write on the same line.
+ */
+struct alignas(CACHE_LINE) ConvergencePartial {
+    double difference = 0; // sum of (current[i] - previous[i])^2 over the rows of the worker
+    double norm = 0; // sum of current[i]^2 over the rows of the worker
+};
+
+
+/*!
+ * The following structure stores a copy of the variables that is placed on a single NUMA node, so that the workers
+ * of that node read the variables from their local memory.
+ */
+struct NodeReplica {
+    vector<float> curr_variables;
+    vector<float> prev_variables;
+};
+
+
+/*!
+ * The following structure groups the work buffers used by the Jacobi's engines. It can be kept alive between two
+ * solves of systems with the same dimension, so that the vectors are allocated only once.
+ */
+struct JacobiWorkspace {
+
+    vector<float> curr_variables; // solution computed at the current iteration
+    vector<float> prev_variables; // solution computed at the previous iteration
+    vector<float> inverse_diagonal; // reciprocals of the elements on the diagonal of the matrix
+    vector<ConvergencePartial> partials; // partial sums of the stopping criteria, one for each worker
+    vector<NodeReplica> replicas; // copies of the variables for each NUMA node, used only by pools spanning many nodes
+    vector<vector<float>> snapshots; // private copies of the variables of each worker of the asynchronous engine
+    int iterations = 0; // sweeps computed by the last solve of the dense Jacobi engines (seq, thr, ff and async, whose
+                        // count is the one of the slowest thread)
+    int checks = 0; // iterations whose stopping criteria was checked by the last solve of the same engines
+    bool warm = false; // if true, reset keeps the variables and the reciprocals of the diagonal (warm start)
+
+    /*!
+     * The following function prepares the buffers for a warm start: the next solve starts from the solution stored in
+     * curr_variables and reuses the reciprocals of the diagonal, which must be kept up to date by whoever changes the
+     * matrix.
+     * @param n [int] := dimension of the linear system
+     * @return kept [bool] := true if the buffers are kept, false if the warm start is disabled or the buffers do not
+     * have the dimension of the system
+     */
+    bool keep_warm(int n){
+        if(!warm || (int) curr_variables.size() != n || (int) inverse_diagonal.size() != n){
+            return false;
+        }
+        prev_variables.assign(curr_variables.begin(), curr_variables.end()); // some engines read it first
+        iterations = 0;
+        checks = 0;
+        return true;
+    }
+
+    /*!
+     * The following function prepares the buffers for a new solve of the system with the matrix given as input: they
+     * are resized (without reallocating if they are already large enough), the variables are zeroed and the
+     * reciprocals of the diagonal are computed. With the warm start the variables and the reciprocals are kept.
+     * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+     */
+    void reset(const Matrix &matrix){
+        int n = matrix.size();
+        if(keep_warm(n)){
+            return;
+        }
+        curr_variables.assign(n, 0.0);
+        prev_variables.assign(n, 0.0);
+        iterations = 0;
+        checks = 0;
+        inverse_diagonal.resize(n);
+        for(int i = 0; i < n; i++){
+            inverse_diagonal[i] = 1.0f / matrix[i][i];
+        }
+    }
+
+    /*!
+     * The following function prepares the buffers for a new solve of a system whose matrix is stored in a sparse
+     * format, given its diagonal.
+     * @param diagonal [vector<float>] := elements on the diagonal of the matrix A of the linear system (Ax=b)
+     */
+    void reset(const vector<float> &diagonal){
+        int n = diagonal.size();
+        if(keep_warm(n)){
+            return;
+        }
+        curr_variables.assign(n, 0.0);
+        prev_variables.assign(n, 0.0);
+        iterations = 0;
+        checks = 0;
+        inverse_diagonal.resize(n);
+        for(int i = 0; i < n; i++){
+            inverse_diagonal[i] = 1.0f / diagonal[i];
+        }
+    }
+
+    /*!
+     * The following function prepares the buffers for a new solve of a system whose matrix is stored in a reduced
+     * precision format (the reciprocals are computed from its single precision diagonal).
+     * @param matrix [PrecisionMatrix] := matrix A of the linear system (Ax=b)
+     */
+    void reset(const PrecisionMatrix &matrix){
+        reset(matrix.diagonal());
+    }
+};
@@ -2,10 +2,21 @@
 #include <cstdlib>
 #include <vector>
 #include <fstream>
+#include <stdexcept>
+#include <memory>
+#include <map>
+#include <thread>
 #include "utility.h"
-#include "jacobi_sequential.h"
-#include "jacobi_threads.h"
+#include "jacobi_solver.h"
+#include "jacobi_sparse.h"
 #include "jacobi_ff.h"
+#include "placement.h"
+#include "precision.h"
+#include "binary_format.h"
+#include "generator.h"
+#include "jacobi_stream.h"
+#include "autotune.h"
+#include "jacobi_generic.h"
 using namespace std;
 
 
@@ -15,47 +26,159 @@ using namespace std;
 #define MIN_VECTOR 0 // minimum value of the vector
 #define MAX_VECTOR 20 // maximum value of the vector
 #define SEED 14 // seed to generate random numbers
+#define NONZEROS_PER_ROW 8 // average number of off-diagonal non-zero elements of each row of the sparse matrices
 
 
 int main(int argc, char *argv[]) {
 
+    // the optional settings are given as KEY=VALUE after the positional parameters
+    vector<string> parameters;
+    map<string, string> options;
+    for(int a = 0; a < argc; a++){
+        string argument = argv[a];
+        size_t separator = argument.find('=');
+        if(a > 0 && separator != string::npos){
+            options[argument.substr(0, separator)] = argument.substr(separator + 1);
+        }
+        else{
+            parameters.push_back(argument);
+        }
+    }
+    int args = parameters.size();
+
     // Check on the input values
-    if(argc < 6){
-        cerr << "The parameters must be 6 or 7" << endl;
-        cerr << "Parameters: [MODE] [SIZE] [ITERATIONS] [TOLERANCE] [OUTPUT_FILENAME] [NUM_THREADS]" << endl;
+    if(args < 6){
+        cerr << "The parameters must be 6, 7 or 8" << endl;
+        cerr << "Parameters: [MODE] [SIZE] [ITERATIONS] [TOLERANCE] [OUTPUT_FILENAME] [NUM_THREADS] [PLACEMENT] [KEY=VALUE ...]" << endl;
         exit(-1);
     }
-    string mode = argv[1];
+    string mode = parameters[1];
+    // the modes are [ENGINE] for the dense matrix or [ENGINE]_[FORMAT] for a sparse matrix (e.g. thr_csr)
+    string engine_mode = mode.substr(0, mode.find('_'));
+    string format = mode.find('_') != string::npos ? mode.substr(mode.find('_') + 1) : "dense";
 
-    if(mode != "seq" && mode != "thr" && mode != "ff"){
-        cerr << "The MODE parameter is wrong. It must be one of the following: - seq \n - thr \n - ff " << endl;
+    if((engine_mode != "seq" && engine_mode != "thr" && engine_mode != "ff" && mode != "async" &&
+        mode != "stream" && mode != "auto") || (format != "dense" && format != "csr" && format != "sell")){
+        cerr << "The MODE parameter is wrong. It must be one of the following: - seq \n - thr \n - ff \n - async \n"
+                " - stream \n - auto \n - seq_csr \n - thr_csr \n - ff_csr \n - seq_sell \n - thr_sell \n - ff_sell "
+             << endl;
         exit(-2);
     }
-    if(argc == 7 && mode == "seq"){
+    if(mode == "stream"){ // the out-of-core mode computes the rows in the main thread, as the sequential one
+        engine_mode = "seq";
+    }
+    if(args == 7 && engine_mode == "seq"){
         cerr << "You passed too many arguments for sequential mode!" << endl;
         cerr << "Parameters: [MODE] [SIZE] [ITERATIONS] [TOLERANCE] [OUTPUT_FILENAME] [NUM_THREADS]" << endl;
         exit(-3);
     }
-    if(argc == 6 && mode == "thr"){
+    if(args == 6 && engine_mode != "seq"){
         cerr << "You passed few arguments for threads mode!" << endl;
         cerr << "Parameters: [MODE] [SIZE] [ITERATIONS] [TOLERANCE] [OUTPUT_FILENAME] [NUM_THREADS]" << endl;
         exit(-4);
     }
+    if(args == 8 && mode != "thr" && mode != "async"){
+        cerr << "The placement of the threads is available only for threads and async modes!" << endl;
+        cerr << "Parameters: [MODE] [SIZE] [ITERATIONS] [TOLERANCE] [OUTPUT_FILENAME] [NUM_THREADS] [PLACEMENT]" << endl;
+        exit(-9);
+    }
+    for(auto &[key, value] : options){
+        if(key != "storage" && key != "accumulation" && key != "accuracy" && key != "rhs" && key != "method" &&
+           key != "omega" && key != "colors" && key != "staleness" && key != "tile" && key != "matrix" &&
+           key != "vector" && key != "family" && key != "bandwidth" && key != "dominance" && key != "panel" &&
+           key != "schedule" && key != "grain" && key != "wait" && key != "counters" &&
+           key != "trace" && key != "cache" && key != "scalar" && key != "criterion" && key != "check" &&
+           key != "updates"){
+            cerr << "The option '" << key << "' is not valid. The options are: storage=[fp32|fp16|bf16], "
+                    "accumulation=[float|double], accuracy=[on|off], rhs=[M], method=[jacobi|gs|sor|rb], "
+                    "omega=[W], colors=[C], staleness=[S], tile=[auto|off|RxC], matrix=[FILE], vector=[FILE], "
+                    "family=[dense|banded], bandwidth=[W], dominance=[D], panel=[ROWS], schedule=[static|steal|steal:B], "
+                    "grain=[auto|G], wait=[sleep|spin], counters=[on|off], trace=[FILE], "
+                    "cache=[FILE], scalar=[float|double], criterion=[increment|residual|max], "
+                    "check=[auto|M], updates=[U]" << endl;
+            exit(-11);
+        }
+    }
+    if(format != "dense" && !(options.empty() || (options.size() == 1 && options.count("schedule")))){
+        cerr << "The options are available only for the dense modes (the sparse modes accept only schedule)!" << endl;
+        exit(-13);
+    }
+    for(auto &[key, value] : options){
+        if(mode == "stream" ? key != "matrix" && key != "vector" && key != "panel" : key == "panel"){
+            cerr << "The stream mode needs the matrix option and accepts only the vector and panel options, the "
+                    "panel option is available only for the stream mode!" << endl;
+            exit(-25);
+        }
+    }
+    for(auto &[key, value] : options){
+        // the autotuner chooses the engine and its settings, so only the system and the cache can be given
+        if(mode == "auto" ? key != "matrix" && key != "vector" && key != "family" && key != "bandwidth" &&
+                            key != "dominance" && key != "counters" && key != "cache" : key == "cache"){
+            cerr << "The auto mode accepts only the matrix, vector, family, bandwidth, dominance, counters and cache "
+                    "options, the cache option is available only for the auto mode!" << endl;
+            exit(-30);
+        }
+    }
+    for(auto &[key, value] : options){
+        // the generic engine is sequential and reads the matrix as it is, so only the system can be given
+        if(options.count("scalar") && (mode != "seq" || (key != "scalar" && key != "matrix" && key != "vector" &&
+                                                         key != "family" && key != "bandwidth" && key != "dominance"))){
+            cerr << "The scalar option is available only for the seq mode and with only the matrix, vector, family, "
+                    "bandwidth and dominance options!" << endl;
+            exit(-31);
+        }
+    }
+    if(options.count("scalar") && options["scalar"] != "float" && options["scalar"] != "double"){
+        cerr << "The scalar option must be float or double!" << endl;
+        exit(-12);
+    }
+    if(mode == "stream" && !options.count("matrix")){
+        cerr << "The stream mode reads the matrix from a file: the matrix option is needed!" << endl;
+        exit(-25);
+    }
 
 
-    int size = atoi(argv[2]);
+    int size = atoi(parameters[2].c_str());
+    // the system given as binary files is loaded before the checks that depend on its size; the matrix is mapped, so
+    // only the pages read by the checksum are loaded here
+    Matrix input_matrix;
+    vector<float> input_vector;
+    try{
+        if(options.count("matrix") && mode == "stream"){ // the streamed matrix is never loaded, only its size is read
+            size = streamed_size(options["matrix"], size);
+        }
+        else if(options.count("matrix")){
+            input_matrix = map_binary_matrix(options["matrix"]);
+        }
+        if(options.count("vector")){
+            input_vector = read_binary_vector(options["vector"]);
+        }
+    }
+    catch(const runtime_error &e){
+        cerr << e.what() << endl;
+        exit(-21);
+    }
+    int input_size = mode == "stream" ? size : options.count("matrix") ? input_matrix.size() : input_vector.size();
+    int matrix_size = mode == "stream" ? size : input_matrix.size();
+    if((options.count("matrix") && options.count("vector") && matrix_size != (int) input_vector.size()) ||
+       (input_size > 0 && size != 0 && size != input_size)){
+        cerr << "The sizes of the input files and the SIZE parameter do not match (SIZE can be 0 to use the size of "
+                "the files)!" << endl;
+        exit(-22);
+    }
+    size = input_size > 0 ? input_size : size;
     if(size < 1){
         cerr << "The size of the linear system must be >= 1!" << endl;
         exit(-5);
     }
-    int iterations = atoi(argv[3]);
+    int iterations = atoi(parameters[3].c_str());
     if(iterations < 1){
         cerr << "The number of iterations must be >= 1!" << endl;
         exit(-6);
     }
-    double tolerance = atof(argv[4]);
-    string output_filename = argv[5];
-    int num_threads;
+    double tolerance = atof(parameters[4].c_str());
+    string output_filename = parameters[5];
+    int num_threads = 1;
 
 
 
@@ -63,6 +186,15 @@ int main(int argc, char *argv[]) {
     cout << "\t \t ---JACOBI METHOD--- \t \t" << endl;
     cout << "MODE: " << mode << endl;
     cout << "SIZE: " << size << endl;
+    if(options.count("matrix")){
+        cout << "MATRIX: " << options["matrix"] << (mode == "stream" ? " (streamed)" : " (mapped)") << endl;
+    }
+    if(options.count("vector")){
+        cout << "VECTOR: " << options["vector"] << endl;
+    }
+    if(options.count("panel")){
+        cout << "PANEL: " << options["panel"] << " rows" << endl;
+    }
     cout << "ITERATIONS: " << iterations << endl;
     if(tolerance < 0){
         cout << "TOLERANCE: DISABLED" << endl;
@@ -70,57 +202,513 @@ int main(int argc, char *argv[]) {
     else{
         cout << "TOLERANCE: " << tolerance << endl;
     }
-    if(mode != "seq"){
-        num_threads = atoi(argv[6]);
+    if(engine_mode != "seq"){
+        num_threads = atoi(parameters[6].c_str());
         if(num_threads < 1){
             cerr << "The number of threads must be >= 1!" << endl;
             exit(-7);
         }
         cout << "NUMBER OF THREADS: " << num_threads << endl;
     }
+    Placement placement;
+    if(args == 8){
+        try{
+            placement = parse_placement(parameters[7]);
+        }
+        catch(const invalid_argument &e){
+            cerr << e.what() << endl;
+            cerr << "The PLACEMENT parameter must be one of the following: none, compact, scatter or a list of cores"
+                 << endl;
+            exit(-10);
+        }
+        cout << "PLACEMENT: " << parameters[7] << endl;
+    }
+    StorageFormat storage = StorageFormat::FP32;
+    AccumulationType accumulation = AccumulationType::FLOAT;
+    try{
+        if(options.count("storage")){
+            storage = parse_storage(options["storage"]);
+        }
+        if(options.count("accumulation")){
+            accumulation = parse_accumulation(options["accumulation"]);
+        }
+    }
+    catch(const invalid_argument &e){
+        cerr << e.what() << endl;
+        exit(-12);
+    }
+    bool reduced = storage != StorageFormat::FP32 || accumulation != AccumulationType::FLOAT;
+    int num_rhs = options.count("rhs") ? atoi(options["rhs"].c_str()) : 1;
+    if(num_rhs < 1){
+        cerr << "The number of right-hand sides must be >= 1!" << endl;
+        exit(-14);
+    }
+    Relaxation relaxation;
+    try{
+        if(options.count("method")){
+            relaxation.method = parse_relaxation(options["method"]);
+        }
+    }
+    catch(const invalid_argument &e){
+        cerr << e.what() << endl;
+        exit(-12);
+    }
+    if(options.count("omega")){
+        relaxation.omega = atof(options["omega"].c_str());
+    }
+    if(options.count("colors")){
+        relaxation.colors = atoi(options["colors"].c_str());
+    }
+    if(relaxation.omega <= 0 || relaxation.omega >= 2 || relaxation.colors < 1 || relaxation.colors > size){
+        cerr << "The relaxation factor must be in (0, 2) and the number of colors in [1, SIZE]!" << endl;
+        exit(-16);
+    }
+    if(num_rhs > 1 && relaxation.method != RelaxationMethod::JACOBI){
+        cerr << "The batched solve (rhs > 1) is available only for the Jacobi method!" << endl;
+        exit(-17);
+    }
+    int staleness = options.count("staleness") ? atoi(options["staleness"].c_str()) : -1;
+    if(mode == "async" && (num_rhs > 1 || relaxation.method != RelaxationMethod::JACOBI)){
+        cerr << "The async mode computes only the Jacobi's Algorithm with one right-hand side!" << endl;
+        exit(-18);
+    }
+    if(mode != "async" && options.count("staleness")){
+        cerr << "The staleness is available only for async mode!" << endl;
+        exit(-19);
+    }
+    Tiling tiling;
+    try{
+        if(options.count("tile")){
+            tiling = parse_tiling(options["tile"], size);
+        }
+    }
+    catch(const invalid_argument &e){
+        cerr << e.what() << endl;
+        exit(-12);
+    }
+    if(tiling.columns > 0 && (mode == "async" || num_rhs > 1 || relaxation.method != RelaxationMethod::JACOBI)){
+        cerr << "The tiled sweep is available only for the Jacobi's Algorithm of the seq, thr and ff modes with one "
+                "right-hand side!" << endl;
+        exit(-20);
+    }
+    Schedule schedule;
+    try{
+        if(options.count("schedule")){
+            schedule = parse_schedule(options["schedule"]);
+        }
+    }
+    catch(const invalid_argument &e){
+        cerr << e.what() << endl;
+        exit(-12);
+    }
+    if(schedule.policy != SchedulePolicy::STATIC &&
+       (engine_mode != "thr" || num_rhs > 1 || relaxation.method != RelaxationMethod::JACOBI)){
+        cerr << "The work-stealing schedule is available only for the Jacobi's Algorithm of the thr, thr_csr and "
+                "thr_sell modes with one right-hand side!" << endl;
+        exit(-26);
+    }
+    FastFlowOptions fast_flow;
+    try{
+        if(options.count("grain")){
+            fast_flow.grain = parse_grain(options["grain"]);
+        }
+    }
+    catch(const invalid_argument &e){
+        cerr << e.what() << endl;
+        exit(-12);
+    }
+    if(options.count("wait") && options["wait"] != "sleep" && options["wait"] != "spin"){
+        cerr << "The wait option must be sleep or spin!" << endl;
+        exit(-12);
+    }
+    fast_flow.spin = options.count("wait") && options["wait"] == "spin";
+    if((options.count("grain") || options.count("wait")) &&
+       (mode != "ff" || num_rhs > 1 || relaxation.method != RelaxationMethod::JACOBI)){
+        cerr << "The grain and wait options are available only for the Jacobi's Algorithm of the ff mode with one "
+                "right-hand side!" << endl;
+        exit(-27);
+    }
+    if(options.count("counters") && options["counters"] != "on" && options["counters"] != "off"){
+        cerr << "The counters option must be on or off!" << endl;
+        exit(-12);
+    }
+    bool counting = options.count("counters") && options["counters"] == "on";
+    if(counting && num_rhs > 1){
+        cerr << "The hardware counters are available only for the solves with one right-hand side!" << endl;
+        exit(-28);
+    }
+    if(options.count("trace") && ((mode != "thr" && mode != "ff") || num_rhs > 1 ||
+                                  relaxation.method != RelaxationMethod::JACOBI)){
+        cerr << "The trace is available only for the Jacobi's Algorithm of the thr and ff modes with one right-hand "
+                "side!" << endl;
+        exit(-29);
+    }
+    Convergence convergence;
+    try{
+        if(options.count("criterion")){
+            convergence.criterion = parse_criterion(options["criterion"]);
+        }
+        if(options.count("check")){
+            convergence.cadence = parse_cadence(options["check"]);
+        }
+    }
+    catch(const invalid_argument &e){
+        cerr << e.what() << endl;
+        exit(-12);
+    }
+    bool monitored = options.count("criterion") || options.count("check");
+    if(monitored && ((mode != "seq" && mode != "thr" && mode != "ff") || num_rhs > 1 ||
+                     relaxation.method != RelaxationMethod::JACOBI)){
+        cerr << "The criterion and check options are available only for the Jacobi's Algorithm of the seq, thr and ff "
+                "modes with one right-hand side!" << endl;
+        exit(-32);
+    }
+    int updates = options.count("updates") ? atoi(options["updates"].c_str()) : 0;
+    if(options.count("updates") && (updates < 1 || updates > size || tolerance < 0 ||
+                                    (mode != "seq" && mode != "thr" && mode != "ff") || num_rhs > 1)){
+        cerr << "The updates option must be in [1, SIZE] and it is available only for the seq, thr and ff modes with "
+                "one right-hand side and a tolerance >= 0!" << endl;
+        exit(-33);
+    }
+    MatrixGenerator generator;
+    generator.min_value = MIN_MATRIX;
+    generator.max_value = MAX_MATRIX;
+    generator.seed = SEED;
+    try{
+        if(options.count("family")){
+            generator.family = parse_family(options["family"]);
+        }
+    }
+    catch(const invalid_argument &e){
+        cerr << e.what() << endl;
+        exit(-12);
+    }
+    bool custom_matrix = options.count("family") || options.count("bandwidth") || options.count("dominance");
+    generator.bandwidth = options.count("bandwidth") ? atoi(options["bandwidth"].c_str()) : 8;
+    generator.dominance = options.count("dominance") ? atof(options["dominance"].c_str()) : 2;
+    if(custom_matrix && options.count("matrix")){
+        cerr << "The family, the bandwidth and the dominance are available only for the generated matrix!" << endl;
+        exit(-23);
+    }
+    if(generator.bandwidth < 1 || generator.dominance <= 0 ||
+       (options.count("bandwidth") && generator.family != MatrixFamily::BANDED)){
+        cerr << "The bandwidth must be >= 1 (banded family only) and the dominance > 0!" << endl;
+        exit(-24);
+    }
+    // the accuracy is reported by default when the precision is changed, since it is the price of the speedup
+    bool accuracy = options.count("accuracy") ? options["accuracy"] == "on" : reduced;
+    if(num_rhs > 1 && (reduced || accuracy)){
+        cerr << "The batched solve (rhs > 1) reads the matrix in single precision and has no accuracy report!" << endl;
+        exit(-15);
+    }
+    if(reduced){
+        cout << "STORAGE: " << storage_name(storage) << endl;
+        cout << "ACCUMULATION: " << accumulation_name(accumulation) << endl;
+    }
+    if(num_rhs > 1){
+        cout << "RIGHT-HAND SIDES: " << num_rhs << endl;
+    }
+    if(mode == "async"){
+        cout << "STALENESS: " << (staleness < 0 ? "UNBOUNDED" : to_string(staleness)) << endl;
+    }
+    if(options.count("tile")){
+        cout << "TILING: " << (tiling.columns > 0 ? to_string(tiling.rows) + "x" + to_string(tiling.columns) : "OFF")
+             << endl;
+    }
+    if(options.count("schedule")){
+        cout << "SCHEDULE: " << schedule_name(schedule) << endl;
+    }
+    if(options.count("grain")){
+        cout << "GRAIN: " << (fast_flow.grain == FF_GRAIN_AUTO ? "AUTO" : to_string(fast_flow.grain)) << endl;
+    }
+    if(options.count("wait")){
+        cout << "WAIT: " << options["wait"] << endl;
+    }
+    if(monitored){
+        cout << "CRITERION: " << criterion_name(convergence.criterion) << endl;
+        cout << "CHECK: " << (convergence.cadence == CHECK_PREDICTED ? "AUTO" : "EVERY " +
+                              to_string(convergence.cadence) + " ITERATIONS") << endl;
+    }
+    if(options.count("scalar")){
+        cout << "SCALAR: " << options["scalar"] << (size <= FIXED_MAX_EXTENT ? " (unrolled)" : "") << endl;
+    }
+    if(custom_matrix){
+        cout << "FAMILY: " << family_name(generator.family) << endl;
+        if(generator.family == MatrixFamily::BANDED){
+            cout << "BANDWIDTH: " << generator.bandwidth << endl;
+        }
+        cout << "DOMINANCE: " << generator.dominance << endl;
+    }
+    bool relaxed = relaxation.method != RelaxationMethod::JACOBI;
+    if(relaxed){
+        cout << "METHOD: " << relaxation_name(relaxation.method) << endl;
+        cout << "OMEGA: " << (relaxation.method == RelaxationMethod::GAUSS_SEIDEL ? 1.0 : relaxation.omega) << endl;
+        if(engine_mode != "seq" || relaxation.method == RelaxationMethod::RED_BLACK){
+            // the natural ordering is sequential, so the parallel engines always use the multicolor one
+            cout << "COLORS: " << relaxation.colors << endl;
+        }
+    }
     cout << endl;
 
 
-    vector<vector<float>> matrix = generate_matrix(size, MIN_MATRIX, MAX_MATRIX, SEED);
-    vector<float> knownTerm = generate_vector(size, MIN_VECTOR, MAX_VECTOR, SEED);
     long time;
     long double avg_time = 0;
+    string engine_name;
 
-
-    if(mode == "seq"){
+    if(mode == "stream"){
+        vector<float> knownTerm = options.count("vector") ? std::move(input_vector)
+                                                          : generate_vector(size, MIN_VECTOR, MAX_VECTOR, SEED);
+        int panel_rows = options.count("panel") ? atoi(options["panel"].c_str()) : 0;
+        JacobiWorkspace workspace;
+        StreamReport report;
+        engine_name = "STREAMING";
         for(int i = 0; i < TRIALS; i++){
-            vector<float> var = sequential_jacobi(matrix, knownTerm, iterations, tolerance, time);
+            try{
+                streaming_jacobi(options["matrix"], knownTerm, iterations, tolerance, panel_rows, time, workspace,
+                                 report);
+            }
+            catch(const runtime_error &e){
+                cerr << e.what() << endl;
+                exit(-21);
+            }
             avg_time += time;
         }
-        avg_time /= TRIALS;
-        cout << "SEQUENTIAL AVG_TIME: " << avg_time << " with " << TRIALS << " trials" << endl;
+        print_stream_report(report); // the reads of the last trial
     }
-    else if(mode == "thr"){
-        for(int i = 0; i < TRIALS; i++){
-            vector<float> var = threads_jacobi(matrix, knownTerm, iterations, num_threads, tolerance, time);
+    else if(format == "dense"){
+        // the system is built (or loaded) once and moved inside the solver, so that the trials do not copy it; the
+        // generated matrix is filled in parallel by generate_rows below
+        JacobiSolver solver(options.count("matrix") ? std::move(input_matrix) : Matrix(),
+                            options.count("vector") ? std::move(input_vector)
+                                                    : generate_vector(size, MIN_VECTOR, MAX_VECTOR, SEED));
+        bool generated = !options.count("matrix");
+        Engine engine;
+
+        if(mode == "seq"){
+            engine = Engine::SEQUENTIAL;
+            engine_name = "SEQUENTIAL";
+        }
+        else if(mode == "thr" || mode == "async"){
+            engine = mode == "thr" ? Engine::THREADS : Engine::ASYNC;
+            engine_name = mode == "thr" ? "THREADS" : "ASYNCHRONOUS";
+            solver.set_staleness(staleness);
+            solver.reserve_threads(num_threads, placement); // the workers are created once, outside of the trials
+            if(generated){
+                solver.generate_rows(generator, num_threads); // each row block is generated by the thread computing it
+            }
+            else if(placement.layout != PlacementLayout::NONE){
+                solver.place_rows(num_threads); // each row block is first touched by the thread that computes it
+            }
+            if(placement.layout != PlacementLayout::NONE){
+                solver.print_placement(num_threads);
+            }
+        }
+        else if(mode == "auto"){ // the engine is chosen by the autotuner once the system is ready
+            engine = Engine::SEQUENTIAL;
+            engine_name = "AUTO";
+        }
+        else{
+            engine = Engine::FASTFLOW;
+            engine_name = "FAST FLOW";
+        }
+        if(generated && engine != Engine::THREADS && engine != Engine::ASYNC){
+            // the other engines do not own their workers, so the rows are generated by all the cores and released
+            solver.generate_rows(generator, max(1, (int) thread::hardware_concurrency()));
+            solver.release_threads();
+        }
+
+        solver.set_precision(storage, accumulation); // the matrix is converted once, outside of the trials
+        solver.set_relaxation(relaxation);
+        solver.set_tiling(tiling);
+        solver.set_schedule(schedule);
+        solver.set_fast_flow(fast_flow);
+        solver.set_counters(counting);
+        solver.set_tracing(options.count("trace"));
+        solver.set_convergence(convergence);
+        if(mode == "auto"){ // NUM_THREADS is the largest number of threads that the autotuner can choose
+            bool cached;
+            TunedConfig config = autotune(solver, num_threads, options.count("cache") ? options["cache"] : TUNING_CACHE,
+                                          cached);
+            engine = config.engine;
+            num_threads = config.threads;
+            engine_name += " " + tuned_engine_name(config.engine);
+            cout << "AUTO: " << tuned_engine_name(config.engine) << " with " << config.threads << " threads" <<
+                 (config.grain > 0 ? " and grain " + to_string(config.grain) : "") << " (" <<
+                 (cached ? "cached" : "calibrated") << ", " << config.iteration_time << " usec per iteration, " <<
+                 "predicted " << config.iteration_time * iterations << " usec)" << endl;
+        }
+
+        if(num_rhs > 1){
+            // the first right-hand side is the known term of the solver, the others are generated with the next seeds
+            vector<vector<float>> rhs(num_rhs);
+            rhs[0] = solver.known_term();
+            for(int c = 1; c < num_rhs; c++){
+                rhs[c] = generate_vector(size, MIN_VECTOR, MAX_VECTOR, SEED + c);
+            }
+            for(int i = 0; i < TRIALS; i++){
+                solver.solve_batch(engine, rhs, iterations, num_threads, tolerance, time);
+                avg_time += time;
+            }
+            engine_name += " BATCHED";
+        }
+
+        if(options.count("scalar")){ // the templated engine, with the fixed extent if the system is small enough
+            int computed = 0;
+            for(int i = 0; i < TRIALS; i++){
+                if(options["scalar"] == "double"){
+                    sequential_jacobi_as<double>(solver.system_matrix(), solver.known_term(), iterations, tolerance,
+                                                 time, computed);
+                }
+                else{
+                    sequential_jacobi_as<float>(solver.system_matrix(), solver.known_term(), iterations, tolerance,
+                                                time, computed);
+                }
+                avg_time += time;
+            }
+            engine_name += " " + options["scalar"];
+            cout << "ITERATIONS COMPUTED: " << computed << endl;
+        }
+
+        const vector<float> *solution = nullptr;
+        for(int i = 0; i < TRIALS && num_rhs == 1 && !options.count("scalar"); i++){
+            solution = &solver.solve(engine, iterations, num_threads, tolerance, time);
             avg_time += time;
         }
-        avg_time /= TRIALS;
-        cout << "THREADS AVG_TIME: " << avg_time << " with " << TRIALS << " trials" << endl;
+        if(monitored){ // the checks of the last trial
+            cout << "CONVERGENCE CHECKS: " << solver.checks() << " over " << solver.iterations() << " iterations"
+                 << endl;
+        }
+        if(counting){ // the events of all the threads of the last trial
+            cout << "COUNTERS: " << solver.counters().describe() << endl;
+        }
+        if(solver.trace() != nullptr){ // the timeline of the last trial
+            solver.trace()->print_summary();
+            try{
+                solver.trace()->write_chrome(options["trace"]);
+            }
+            catch(const runtime_error &e){
+                cerr << e.what() << endl;
+                exit(-8);
+            }
+            cout << "TRACE: " << options["trace"] << endl;
+        }
+        if(updates > 0){
+            // U elements of b change by 1%, then the system is solved again from the last solution and from zero
+            vector<pair<int, float>> delta;
+            for(int u = 0; u < updates; u++){
+                int i = (int) ((long) u * size / updates);
+                delta.emplace_back(i, (u % 2 == 0 ? 0.01f : -0.01f) * solver.known_term()[i]);
+            }
+            solver.update_known_term(delta);
+            solver.set_warm_start(true);
+            solution = &solver.solve(engine, iterations, num_threads, tolerance, time);
+            cout << "WARM START: " << solver.iterations() << " iterations in " << time << " usec after " << updates <<
+                 " changes of b" << endl;
+            solver.set_warm_start(false);
+            solution = &solver.solve(engine, iterations, num_threads, tolerance, time);
+            cout << "COLD START: " << solver.iterations() << " iterations in " << time << " usec" << endl;
+        }
+        if(accuracy){
+            int reference_iterations;
+            vector<double> reference = reference_jacobi(solver.system_matrix(), solver.known_term(), iterations,
+                                                        tolerance, reference_iterations);
+            print_accuracy(solver.system_matrix(), solver.known_term(), *solution, reference);
+            // the asynchronous solve stops on the votes of the threads, so its residual is checked against the reference
+            if(mode == "async" && residual_regressed(solver.system_matrix(), solver.known_term(), *solution, reference,
+                                                     tolerance)){
+                cerr << "The residual of the asynchronous solution regressed with respect to the reference!" << endl;
+                exit(-34);
+            }
+            // with more threads than cores the threads are preempted for whole sweeps, but the solve must still stop
+            // early when the reference stops within half of the sweeps allowed
+            if(mode == "async" && tolerance >= 0 && reference_iterations <= iterations / 2 &&
+               solver.iterations() >= iterations){
+                cerr << "The asynchronous solve did all the " << iterations << " sweeps while the reference stopped "
+                        "after " << reference_iterations << " iterations!" << endl;
+                exit(-35);
+            }
+        }
     }
-    else if(mode == "ff"){
+    else{
+        // the workers are created once, outside of the trials; the other engines do not own their workers, so the rows
+        // are generated by all the cores and the workers are released
+        JacobiWorkspace workspace;
+        int generation_threads = engine_mode == "thr" ? num_threads : max(1, (int) thread::hardware_concurrency());
+        unique_ptr<ThreadPool> pool = make_unique<ThreadPool>(generation_threads);
+        CSRMatrix csr = generate_sparse_matrix(size, NONZEROS_PER_ROW, MIN_MATRIX, MAX_MATRIX, SEED, *pool,
+                                               generation_threads);
+        if(engine_mode != "thr"){
+            pool.reset();
+        }
+        vector<float> knownTerm = generate_vector(size, MIN_VECTOR, MAX_VECTOR, SEED);
+        SellMatrix sell;
+        if(format == "sell"){
+            sell = csr_to_sell(csr);
+            csr = CSRMatrix(); // only the SELL-C-sigma copy is kept
+        }
+        cout << "NON-ZEROS PER ROW: " << NONZEROS_PER_ROW << " (average)" << endl << endl;
+
+        if(engine_mode == "seq"){
+            engine_name = "SEQUENTIAL";
+        }
+        else if(engine_mode == "thr"){
+            engine_name = "THREADS";
+        }
+        else{
+            engine_name = "FAST FLOW";
+        }
+
         for(int i = 0; i < TRIALS; i++){
-            vector<float> var = fast_flow_jacobi(matrix, knownTerm, iterations, num_threads, tolerance, time);
+            if(engine_mode == "seq" && format == "csr"){
+                sequential_sparse_jacobi(csr, knownTerm, iterations, tolerance, time, workspace);
+            }
+            else if(engine_mode == "seq"){
+                sequential_sparse_jacobi(sell, knownTerm, iterations, tolerance, time, workspace);
+            }
+            else if(engine_mode == "thr" && format == "csr"){
+                threads_sparse_jacobi(csr, knownTerm, iterations, num_threads, tolerance, time, workspace, *pool,
+                                      schedule);
+            }
+            else if(engine_mode == "thr"){
+                threads_sparse_jacobi(sell, knownTerm, iterations, num_threads, tolerance, time, workspace, *pool,
+                                      schedule);
+            }
+            else if(format == "csr"){
+                fast_flow_sparse_jacobi(csr, knownTerm, iterations, num_threads, tolerance, time, workspace);
+            }
+            else{
+                fast_flow_sparse_jacobi(sell, knownTerm, iterations, num_threads, tolerance, time, workspace);
+            }
             avg_time += time;
         }
-        avg_time /= TRIALS;
-        cout << "FAST FLOW AVG_TIME: " << avg_time << " with " << TRIALS << " trials" << endl;
+        engine_name += " " + format;
     }
+    avg_time /= TRIALS;
+    cout << engine_name << " AVG_TIME: " << avg_time << " with " << TRIALS << " trials" << endl;
 
 
     ofstream output_file;
-    string filename = output_filename + to_string(size) + mode + ".csv";
+    string filename = output_filename + to_string(size) + mode +
+                      (reduced ? "_" + storage_name(storage) + "_" + accumulation_name(accumulation) : "") +
+                      (num_rhs > 1 ? "_rhs" + to_string(num_rhs) : "") +
+                      (relaxed ? "_" + relaxation_name(relaxation.method) : "") +
+                      (tiling.columns > 0 ? "_tile" + to_string(tiling.rows) + "x" + to_string(tiling.columns) : "") +
+                      (schedule.policy == SchedulePolicy::STEAL ?
+                       "_steal" + (schedule.block_rows > 0 ? to_string(schedule.block_rows) : "") : "") +
+                      (options.count("grain") ? "_grain" + options["grain"] : "") +
+                      (fast_flow.spin ? "_spin" : "") +
+                      (options.count("scalar") ? "_" + options["scalar"] : "") +
+                      (options.count("criterion") ? "_" + criterion_name(convergence.criterion) : "") +
+                      (options.count("check") ? "_check" + cadence_name(convergence.cadence) : "") +
+                      (custom_matrix ? "_" + family_name(generator.family) + "_dom" +
+                                     (options.count("dominance") ? options["dominance"] : "2") : "") +
+                      ".csv";
     output_file.open(filename, std::ios::app);
     if(!output_file.is_open()){
         cerr << "Could not open the file '" << filename << "'" << endl;
         exit(-8);
     }
-    if(mode != "seq"){
+    if(engine_mode != "seq"){
         output_file << num_threads << "\t" << avg_time << endl;
     }
     else{
@@ -0,0 +1,121 @@
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <sys/mman.h>
+#include "matrix.h"
+using namespace std;
+
+
+/*!
+ * The following function allocates a buffer of rows*stride floats aligned to CACHE_LINE bytes.
+ * @param rows [int] := number of rows to allocate
+ * @param stride [int] := number of floats of each (padded) row
+ * @param zero [bool] := true if the buffer must be zeroed, false if its pages must be left untouched
+ * @return buffer [float *] := pointer to the allocated buffer, nullptr if the size is 0
+ */
+static float *allocate_buffer(int rows, int stride, bool zero = true){
+
+    size_t bytes = (size_t) rows * stride * sizeof(float);
+    if(bytes == 0){
+        return nullptr;
+    }
+    // bytes is a multiple of CACHE_LINE because stride is rounded up to the cache line
+    auto *buffer = static_cast<float *>(aligned_alloc(CACHE_LINE, bytes));
+    if(buffer == nullptr){
+        throw bad_alloc();
+    }
+    if(zero){
+        memset(buffer, 0, bytes);
+    }
+    return buffer;
+}
+
+
+/*!
+ * The following function rounds up the length of a row to a multiple of CACHE_LINE bytes.
+ * @param n [int] := number of elements of the row
+ * @return stride [int] := number of floats of the padded row
+ */
+static int padded_stride(int n){
+
+    int floats_per_line = CACHE_LINE / sizeof(float);
+    return (n + floats_per_line - 1) / floats_per_line * floats_per_line;
+}
+
+
+Matrix::Matrix() : buffer(nullptr), n(0), stride(0) {}
+
+
+Matrix::Matrix(int n) : Matrix(n, true) {}
+
+
+Matrix::Matrix(int n, bool zero) : n(n), stride(padded_stride(n)) {
+    buffer = allocate_buffer(n, stride, zero);
+}
+
+
+Matrix Matrix::uninitialized(int n){
+    return Matrix(n, false);
+}
+
+
+Matrix Matrix::adopt_mapping(void *mapping, size_t bytes, size_t offset, int n){
+
+    Matrix matrix;
+    matrix.buffer = reinterpret_cast<float *>(static_cast<char *>(mapping) + offset);
+    matrix.n = n;
+    matrix.stride = padded_stride(n);
+    matrix.mapping = mapping;
+    matrix.mapping_bytes = bytes;
+    return matrix;
+}
+
+
+Matrix::Matrix(const Matrix &other) : n(other.n), stride(other.stride) {
+    buffer = allocate_buffer(n, stride, false);
+    if(buffer != nullptr){
+        memcpy(buffer, other.buffer, (size_t) n * stride * sizeof(float));
+    }
+}
+
+
+Matrix::Matrix(Matrix &&other) noexcept : buffer(other.buffer), n(other.n), stride(other.stride),
+                                           mapping(other.mapping), mapping_bytes(other.mapping_bytes) {
+    other.buffer = nullptr;
+    other.n = 0;
+    other.stride = 0;
+    other.mapping = nullptr;
+    other.mapping_bytes = 0;
+}
+
+
+Matrix &Matrix::operator=(const Matrix &other){
+
+    if(this != &other){
+        Matrix copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+
+Matrix &Matrix::operator=(Matrix &&other) noexcept {
+
+    swap(buffer, other.buffer);
+    swap(n, other.n);
+    swap(stride, other.stride);
+    swap(mapping, other.mapping);
+    swap(mapping_bytes, other.mapping_bytes);
+    return *this;
+}
+
+
+Matrix::~Matrix(){
+    if(mapping != nullptr){
+        munmap(mapping, mapping_bytes);
+    }
+    else{
+        free(buffer);
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <span>
+using namespace std;
+
+
+#define CACHE_LINE 64 // alignment (in bytes) of the buffer and of the beginning of each row of the matrix
+
+
+/*!
+ * The following class stores a dense square matrix in a single contiguous row-major buffer. The buffer is aligned to
+ * CACHE_LINE bytes and each row is padded with zeros up to a multiple of CACHE_LINE bytes, so that every row starts
+ * on a cache line boundary. The element (i, j) can be accessed as matrix[i][j] exactly as with vector<vector<float>>,
+ * but walking the rows streams one linear block of memory.
+ */
+class Matrix {
+
+private:
+    float *buffer;
+    int n;
+    int stride; // number of floats between the beginnings of two consecutive rows (n rounded up to the cache line)
+    void *mapping = nullptr; // memory-mapped file that contains the buffer, nullptr if the buffer is allocated
+    size_t mapping_bytes = 0; // length of the mapping
+
+    Matrix(int n, bool zero);
+
+public:
+
+    /*!
+     * The following constructor builds an empty matrix of dimension 0.
+     */
+    Matrix();
+
+    /*!
+     * The following constructor allocates a matrix of dimension n with all the elements (padding included) set to 0.
+     * @param n [int] := dimension of the matrix
+     */
+    explicit Matrix(int n);
+
+    /*!
+     * The following function allocates a matrix of dimension n without writing its elements. Its pages are not
+     * touched, so each page is placed on the NUMA node of the first thread that writes it (first-touch policy).
+     * @param n [int] := dimension of the matrix
+     * @return matrix [Matrix] := matrix whose elements (padding included) must be written before being read
+     */
+    static Matrix uninitialized(int n);
+
+    /*!
+     * The following function builds a matrix on the pages of a memory-mapped file, without copying them. The matrix
+     * takes the ownership of the mapping and unmaps it when it is destroyed; its copies are allocated normally.
+     * @param mapping [void *] := address returned by mmap, aligned to the page
+     * @param bytes [size_t] := length of the mapping
+     * @param offset [size_t] := offset of the first element from the mapping, multiple of CACHE_LINE
+     * @param n [int] := dimension of the matrix, whose rows are padded as in the allocated matrices
+     * @return matrix [Matrix] := matrix that reads its elements from the mapping
+     */
+    static Matrix adopt_mapping(void *mapping, size_t bytes, size_t offset, int n);
+
+    /*!
+     * @return mapped [bool] := true if the elements are read from a memory-mapped file
+     */
+    bool is_mapped() const { return mapping != nullptr; }
+
+    Matrix(const Matrix &other);
+    Matrix(Matrix &&other) noexcept;
+    Matrix &operator=(const Matrix &other);
+    Matrix &operator=(Matrix &&other) noexcept;
+    ~Matrix();
+
+    /*!
+     * @return n [int] := dimension of the matrix
+     */
+    int size() const { return n; }
+
+    /*!
+     * @return stride [int] := number of floats between the beginnings of two consecutive rows
+     */
+    int row_stride() const { return stride; }
+
+    /*!
+     * @return buffer [float *] := pointer to the first element of the matrix, aligned to CACHE_LINE bytes
+     */
+    float *data() { return buffer; }
+    const float *data() const { return buffer; }
+
+    /*!
+     * The following operator returns a pointer to the i-th row, so that matrix[i][j] is the element (i, j).
+     * @param i [int] := index of the row
+     * @return row [float *] := pointer to the first element of the row, aligned to CACHE_LINE bytes
+     */
+    float *operator[](int i) { return buffer + (size_t) i * stride; }
+    const float *operator[](int i) const { return buffer + (size_t) i * stride; }
+
+    /*!
+     * The following function returns a view of the i-th row (padding excluded).
+     * @param i [int] := index of the row
+     * @return row [span<float>] := view of the n elements of the row
+     */
+    span<float> row(int i) { return {(*this)[i], (size_t) n}; }
+    span<const float> row(int i) const { return {(*this)[i], (size_t) n}; }
+};
@@ -0,0 +1,223 @@
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <cmath>
+#include <ctime>
+#include <thread>
+#include <unistd.h>
+#include <sys/utsname.h>
+#include "tiling.h"
+#include "row_kernel.h"
+#include "measurement.h"
+using namespace std;
+
+
+/*!
+ * The following function collects the description of the machine.
+ * @return machine [MachineInfo] := description of the machine
+ */
+MachineInfo machine_info(){
+
+    MachineInfo machine;
+    char hostname[256] = "";
+    gethostname(hostname, sizeof(hostname) - 1);
+    machine.hostname = hostname;
+    ifstream cpuinfo("/proc/cpuinfo");
+    string line;
+    while(getline(cpuinfo, line)){
+        if(line.rfind("model name", 0) == 0 && line.find(':') != string::npos){
+            machine.cpu = line.substr(line.find(':') + 2);
+            break;
+        }
+    }
+    machine.cores = thread::hardware_concurrency();
+    CacheSizes caches = detect_caches();
+    machine.l1 = caches.l1;
+    machine.l2 = caches.l2;
+    machine.l3 = caches.l3;
+    struct utsname system;
+    if(uname(&system) == 0){
+        machine.kernel = string(system.sysname) + " " + system.release;
+    }
+#ifdef __clang__
+    machine.compiler = "clang " __clang_version__;
+#else
+    machine.compiler = "gcc " __VERSION__;
+#endif
+    machine.row_kernel = row_kernel_name();
+    time_t now = time(nullptr);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    machine.date = date;
+    return machine;
+}
+
+
+/*!
+ * The following function computes the statistics of the runs of a configuration, and its throughput from the
+ * operations of the dense Jacobi's Algorithm: 2n^2 floating point operations and n^2 + 3n floats moved per sweep.
+ * @param measurement [Measurement] := configuration of the runs, its statistics are filled
+ * @param times [vector<long>] := usec of each measured run
+ * @param events [vector<PerfSample>] := hardware events of each measured run, empty if they are not counted
+ */
+void summarize(Measurement &measurement, vector<long> times, const vector<PerfSample> &events){
+
+    int count = times.size();
+    measurement.trials = count;
+    if(count == 0){
+        return;
+    }
+    sort(times.begin(), times.end());
+    measurement.median = count % 2 == 1 ? times[count / 2] : (times[count / 2 - 1] + times[count / 2]) / 2.0;
+    measurement.min = times[0];
+    measurement.mean = accumulate(times.begin(), times.end(), 0.0) / count;
+    double squares = 0;
+    for(long time : times){
+        squares += (time - measurement.mean) * (time - measurement.mean);
+    }
+    measurement.stddev = count > 1 ? sqrt(squares / (count - 1)) : 0;
+    double n = measurement.size;
+    double sweeps = measurement.iterations;
+    if(measurement.median > 0){ // operations per usec are millions per second
+        measurement.gflops = 2 * n * n * sweeps / measurement.median / 1e3;
+        measurement.gbps = (n * n + 3 * n) * sizeof(float) * sweeps / measurement.median / 1e3;
+    }
+    measurement.events = PerfSample();
+    for(const PerfSample &sample : events){
+        measurement.events += sample;
+    }
+    for(long long *counter : {&measurement.events.cycles, &measurement.events.instructions,
+                              &measurement.events.llc_misses, &measurement.events.stall_cycles}){
+        if(*counter > 0 && !events.empty()){
+            *counter /= (long long) events.size();
+        }
+    }
+}
+
+
+/*!
+ * @param counter [long long] := value of a hardware counter, -1 if it is not available
+ * @param missing [string] := text written for a counter that is not available
+ * @return text [string] := value of the counter or missing
+ */
+static string counter_text(long long counter, const string &missing){
+
+    return counter < 0 ? missing : to_string(counter);
+}
+
+
+/*!
+ * @param text [string] := text to write in a JSON string
+ * @return escaped [string] := text with the quotes, the backslashes and the control characters escaped
+ */
+static string escape_json(const string &text){
+
+    string escaped;
+    for(char c : text){
+        if(c == '"' || c == '\\'){
+            escaped += '\\';
+            escaped += c;
+        }
+        else if((unsigned char) c < 0x20){
+            escaped += ' ';
+        }
+        else{
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+
+/*!
+ * The following function writes the measurements in the JSON format, with the description of the machine. The
+ * hardware counters that are not available are null.
+ * @param filename [string] := file to write
+ * @param machine [MachineInfo] := description of the machine
+ * @param measurements [vector<Measurement>] := measurements to write
+ * @throw runtime_error if the file cannot be written
+ */
+void write_json(const string &filename, const MachineInfo &machine, const vector<Measurement> &measurements){
+
+    ofstream output_file(filename, ios::trunc);
+    if(!output_file.is_open()){
+        throw runtime_error("Could not open the file '" + filename + "'");
+    }
+    output_file << "{\n  \"machine\": {\n";
+    output_file << "    \"hostname\": \"" << escape_json(machine.hostname) << "\",\n";
+    output_file << "    \"cpu\": \"" << escape_json(machine.cpu) << "\",\n";
+    output_file << "    \"cores\": " << machine.cores << ",\n";
+    output_file << "    \"l1_bytes\": " << machine.l1 << ",\n";
+    output_file << "    \"l2_bytes\": " << machine.l2 << ",\n";
+    output_file << "    \"l3_bytes\": " << machine.l3 << ",\n";
+    output_file << "    \"kernel\": \"" << escape_json(machine.kernel) << "\",\n";
+    output_file << "    \"compiler\": \"" << escape_json(machine.compiler) << "\",\n";
+    output_file << "    \"row_kernel\": \"" << escape_json(machine.row_kernel) << "\",\n";
+    output_file << "    \"date\": \"" << machine.date << "\"\n  },\n";
+    output_file << "  \"results\": [";
+    for(size_t m = 0; m < measurements.size(); m++){
+        const Measurement &measurement = measurements[m];
+        output_file << (m > 0 ? ",\n" : "\n") << "    {\"engine\": \"" << measurement.engine << "\", \"size\": " <<
+                    measurement.size << ", \"threads\": " << measurement.threads << ", \"tolerance\": " <<
+                    measurement.tolerance << ", \"iterations\": " << measurement.iterations << ", \"warmup\": " <<
+                    measurement.warmup << ", \"trials\": " << measurement.trials << ", \"median_us\": " <<
+                    measurement.median << ", \"min_us\": " << measurement.min << ", \"mean_us\": " <<
+                    measurement.mean << ", \"stddev_us\": " << measurement.stddev << ", \"gflops\": " <<
+                    measurement.gflops << ", \"gbps\": " << measurement.gbps << ", \"cycles\": " <<
+                    counter_text(measurement.events.cycles, "null") << ", \"instructions\": " <<
+                    counter_text(measurement.events.instructions, "null") << ", \"ipc\": ";
+        if(measurement.events.ipc() < 0){
+            output_file << "null";
+        }
+        else{
+            output_file << measurement.events.ipc();
+        }
+        output_file << ", \"llc_misses\": " << counter_text(measurement.events.llc_misses, "null") <<
+                    ", \"stall_cycles\": " << counter_text(measurement.events.stall_cycles, "null") << "}";
+    }
+    output_file << "\n  ]\n}\n";
+    if(!output_file){
+        throw runtime_error("Could not write the file '" + filename + "'");
+    }
+}
+
+
+/*!
+ * The following function writes the measurements in the CSV format, one row for each configuration, with the
+ * description of the machine in the comment lines (starting with #) before the header. The hardware counters that
+ * are not available are empty.
+ * @param filename [string] := file to write
+ * @param machine [MachineInfo] := description of the machine
+ * @param measurements [vector<Measurement>] := measurements to write
+ * @throw runtime_error if the file cannot be written
+ */
+void write_csv(const string &filename, const MachineInfo &machine, const vector<Measurement> &measurements){
+
+    ofstream output_file(filename, ios::trunc);
+    if(!output_file.is_open()){
+        throw runtime_error("Could not open the file '" + filename + "'");
+    }
+    output_file << "# hostname: " << machine.hostname << "\n# cpu: " << machine.cpu << "\n# cores: " <<
+                machine.cores << "\n# caches: " << machine.l1 << " " << machine.l2 << " " << machine.l3 <<
+                "\n# kernel: " << machine.kernel << "\n# compiler: " << machine.compiler << "\n# row_kernel: " <<
+                machine.row_kernel << "\n# date: " << machine.date << "\n";
+    output_file << "engine,size,threads,tolerance,iterations,warmup,trials,median_us,min_us,mean_us,stddev_us,gflops,"
+                   "gbps,cycles,instructions,ipc,llc_misses,stall_cycles\n";
+    for(const Measurement &measurement : measurements){
+        output_file << measurement.engine << "," << measurement.size << "," << measurement.threads << "," <<
+                    measurement.tolerance << "," << measurement.iterations << "," << measurement.warmup << "," <<
+                    measurement.trials << "," << measurement.median << "," << measurement.min << "," <<
+                    measurement.mean << "," << measurement.stddev << "," << measurement.gflops << "," <<
+                    measurement.gbps << "," << counter_text(measurement.events.cycles, "") << "," <<
+                    counter_text(measurement.events.instructions, "") << ",";
+        if(measurement.events.ipc() >= 0){
+            output_file << measurement.events.ipc();
+        }
+        output_file << "," << counter_text(measurement.events.llc_misses, "") << "," <<
+                    counter_text(measurement.events.stall_cycles, "") << "\n";
+    }
+    if(!output_file){
+        throw runtime_error("Could not write the file '" + filename + "'");
+    }
+}
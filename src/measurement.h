@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "perf_counters.h"
+using namespace std;
+
+
+/*!
+ * The following structure describes the machine on which a benchmark runs, so that its results can be compared with
+ * the ones of other machines and reproduced.
+ */
+struct MachineInfo {
+    string hostname;
+    string cpu; // model name of the first processor in /proc/cpuinfo
+    int cores = 0; // logical cores available to the process
+    long l1 = 0; // bytes of the L1 data cache
+    long l2 = 0; // bytes of the L2 cache
+    long l3 = 0; // bytes of the L3 cache
+    string kernel; // release of the operating system
+    string compiler; // compiler and version used to build the benchmark
+    string row_kernel; // variant of the row kernel selected on this CPU
+    string date; // UTC time at which the benchmark started, in ISO 8601
+};
+
+
+/*!
+ * The following structure stores the statistics of the repeated runs of a configuration.
+ */
+struct Measurement {
+    string engine; // seq, thr or ff
+    int size = 0; // dimension of the linear system
+    int threads = 1; // number of threads used to parallelize
+    double tolerance = -1; // tolerance of the stopping criteria, disabled if smaller than 0
+    int iterations = 0; // sweeps computed by each run
+    int warmup = 0; // runs not measured
+    int trials = 0; // runs measured
+    double median = 0; // usec
+    double min = 0; // usec
+    double mean = 0; // usec
+    double stddev = 0; // sample standard deviation of the runs in usec
+    double gflops = 0; // GFLOP/s of the median run
+    double gbps = 0; // GB/s of the median run, counting the matrix and the vectors read and written by each sweep
+    PerfSample events; // mean hardware events of the runs measured, the counters not available are -1
+};
+
+
+/*!
+ * The following function collects the description of the machine.
+ * @return machine [MachineInfo] := description of the machine
+ */
+MachineInfo machine_info();
+
+
+/*!
+ * The following function computes the statistics of the runs of a configuration, and its throughput from the
+ * operations of the dense Jacobi's Algorithm: 2n^2 floating point operations and n^2 + 3n floats moved per sweep.
+ * @param measurement [Measurement] := configuration of the runs, its statistics are filled
+ * @param times [vector<long>] := usec of each measured run
+ * @param events [vector<PerfSample>] := hardware events of each measured run, empty if they are not counted
+ */
+void summarize(Measurement &measurement, vector<long> times, const vector<PerfSample> &events = {});
+
+
+/*!
+ * The following function writes the measurements in the JSON format, with the description of the machine. The
+ * hardware counters that are not available are null.
+ * @param filename [string] := file to write
+ * @param machine [MachineInfo] := description of the machine
+ * @param measurements [vector<Measurement>] := measurements to write
+ * @throw runtime_error if the file cannot be written
+ */
+void write_json(const string &filename, const MachineInfo &machine, const vector<Measurement> &measurements);
+
+
+/*!
+ * The following function writes the measurements in the CSV format, one row for each configuration, with the
+ * description of the machine in the comment lines (starting with #) before the header. The hardware counters that
+ * are not available are empty.
+ * @param filename [string] := file to write
+ * @param machine [MachineInfo] := description of the machine
+ * @param measurements [vector<Measurement>] := measurements to write
+ * @throw runtime_error if the file cannot be written
+ */
+void write_csv(const string &filename, const MachineInfo &machine, const vector<Measurement> &measurements);
@@ -19,7 +19,7 @@ int main(){
     int size = 5000;
     int iterations = 100;
 
-    vector<vector<float>> matrix = generate_matrix(size, MIN_MATRIX, MAX_MATRIX, SEED);
+    Matrix matrix = generate_matrix(size, MIN_MATRIX, MAX_MATRIX, SEED);
     vector<float> knownTerm = generate_vector(size, MIN_VECTOR, MAX_VECTOR, SEED);
     long time;
     long double avg_time = 0;
@@ -45,6 +45,25 @@ int main(){
 
     output_file << avg_time << "\t" << "no" << endl;
 
+    // the same checks with each stopping criteria, computed only at the iterations predicted from the contraction rate
+    JacobiWorkspace workspace;
+    for(StoppingCriterion criterion : {StoppingCriterion::INCREMENT, StoppingCriterion::RESIDUAL,
+                                       StoppingCriterion::MAX_NORM}){
+        Convergence convergence;
+        convergence.criterion = criterion;
+        convergence.cadence = CHECK_PREDICTED;
+        avg_time = 0;
+        for(int i = 0; i < TRIALS; i++){
+            sequential_jacobi(matrix, knownTerm, iterations, 0, time, workspace, Tiling(), convergence);
+            avg_time += time;
+        }
+        avg_time /= TRIALS;
+        cout << "SEQUENTIAL AVG_TIME: " << avg_time << " (" << criterion_name(criterion) << ", " << workspace.checks <<
+             " checks)" << endl;
+
+        output_file << avg_time << "\t" << criterion_name(criterion) << "_auto" << endl;
+    }
+
     output_file.close();
     return 0;
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <fstream>
 #include "utimer.cpp"
+#include "thread_pool.h"
 using namespace std;
 
 #define TRIALS 5
@@ -47,6 +48,31 @@ int main(){
         output_file << nw << "\t" << avg_time << endl;
     }
 
+    output_file.close();
+
+    // same measure, but the threads are taken from a pool that is created once, as the native threads engine does
+    output_file.open("overhead_pool.csv", std::ios::app);
+    for(int nw = 2; nw <= 32; nw +=2){
+        long avg_time = 0;
+        ThreadPool pool(nw);
+        for(int trial = 0; trial < TRIALS; trial++) {
+            barrier ba(nw, updating);
+
+            auto body = [&](int tid) {
+                tid++;
+                ba.arrive_and_wait();
+            };
+            {
+                utimer thr = utimer("POOL OVERHEAD " + to_string(nw) + " threads", &thr_time);
+                pool.run(nw, body);
+            }
+            avg_time += thr_time;
+        }
+        avg_time = avg_time / TRIALS;
+        cout << "POOL AVG_TIME " << avg_time << " with " << nw << " threads" << endl;
+        output_file << nw << "\t" << avg_time << endl;
+    }
+
     output_file.close();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,166 @@
+#pragma once
+#include <string>
+#include <sstream>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+using namespace std;
+
+
+/*!
+ * The following structure stores the hardware events counted during a region of code. A counter that is not available
+ * (e.g. perf_event_paranoid, containers, virtual machines or a CPU without the event) is -1.
+ */
+struct PerfSample {
+    long long cycles = -1;
+    long long instructions = -1;
+    long long llc_misses = -1; // read misses of the last level cache
+    long long stall_cycles = -1; // cycles stalled in the backend, mostly waiting for the memory
+
+    /*!
+     * @return available [bool] := true if at least one of the counters is available
+     */
+    bool available() const {
+        return cycles >= 0 || instructions >= 0 || llc_misses >= 0 || stall_cycles >= 0;
+    }
+
+    /*!
+     * @return ipc [double] := instructions per cycle, -1 if they are not available
+     */
+    double ipc() const {
+        return cycles > 0 && instructions >= 0 ? (double) instructions / cycles : -1;
+    }
+
+    /*!
+     * The following function adds the events of another region, a counter stays not available only if it is not
+     * available in both of them.
+     * @param other [PerfSample] := events to add
+     * @return sample [PerfSample &] := this sample
+     */
+    PerfSample &operator+=(const PerfSample &other){
+        auto add = [](long long &total, long long value){
+            if(value >= 0){
+                total = (total < 0 ? 0 : total) + value;
+            }
+        };
+        add(cycles, other.cycles);
+        add(instructions, other.instructions);
+        add(llc_misses, other.llc_misses);
+        add(stall_cycles, other.stall_cycles);
+        return *this;
+    }
+
+    /*!
+     * @param before [PerfSample] := events counted at the beginning of the region
+     * @return sample [PerfSample] := events counted since before, a counter is not available if it is not available
+     * in both of them
+     */
+    PerfSample operator-(const PerfSample &before) const {
+        auto sub = [](long long after, long long value){ return after < 0 || value < 0 ? -1 : after - value; };
+        PerfSample sample;
+        sample.cycles = sub(cycles, before.cycles);
+        sample.instructions = sub(instructions, before.instructions);
+        sample.llc_misses = sub(llc_misses, before.llc_misses);
+        sample.stall_cycles = sub(stall_cycles, before.stall_cycles);
+        return sample;
+    }
+
+    /*!
+     * @return text [string] := the counters in a single line, n/a for the ones that are not available
+     */
+    string describe() const {
+        auto value = [](long long counter){ return counter < 0 ? string("n/a") : to_string(counter); };
+        ostringstream text;
+        text << "CYCLES: " << value(cycles) << "\tINSTRUCTIONS: " << value(instructions) << "\tIPC: ";
+        if(ipc() < 0){
+            text << "n/a";
+        }
+        else{
+            text << ipc();
+        }
+        text << "\tLLC MISSES: " << value(llc_misses) << "\tSTALL CYCLES: " << value(stall_cycles);
+        return text.str();
+    }
+};
+
+
+/*!
+ * The following class counts the hardware events of the calling thread with perf_event_open. The counters start when
+ * they are opened and they are never reset, so a region is measured by the difference of two reads. With inherit the
+ * counters also count the threads created by the calling thread after the construction, once they have been joined
+ * (e.g. the workers of FastFlow). Each event is opened on its own, so a missing event does not disable the others.
+ */
+class PerfCounters {
+
+private:
+    int fds[4] = {-1, -1, -1, -1}; // cycles, instructions, LLC misses and stall cycles
+
+    static int open_event(unsigned type, unsigned long long config, bool inherit){
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.inherit = inherit ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    long long read_event(int e) const {
+        long long value;
+        if(fds[e] < 0 || ::read(fds[e], &value, sizeof(value)) != sizeof(value)){
+            return -1;
+        }
+        return value;
+    }
+
+public:
+
+    /*!
+     * @param inherit [bool] := if true the threads created by the calling thread are counted too
+     */
+    explicit PerfCounters(bool inherit = false){
+        fds[0] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, inherit);
+        fds[1] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, inherit);
+        fds[2] = open_event(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), inherit);
+        fds[3] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND, inherit);
+    }
+
+    ~PerfCounters(){
+        for(int fd : fds){
+            if(fd >= 0){
+                close(fd);
+            }
+        }
+    }
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    /*!
+     * @return sample [PerfSample] := events counted since the construction
+     */
+    PerfSample read() const {
+        PerfSample sample;
+        sample.cycles = read_event(0);
+        sample.instructions = read_event(1);
+        sample.llc_misses = read_event(2);
+        sample.stall_cycles = read_event(3);
+        return sample;
+    }
+};
+
+
+/*!
+ * The following function reads the counters of the calling thread, which are opened at its first call and closed
+ * when the thread exits, so that the long-lived workers of a pool open them only once.
+ * @return sample [PerfSample] := events counted by the calling thread since its first call
+ */
+inline PerfSample thread_events(){
+    thread_local PerfCounters counters;
+    return counters.read();
+}
@@ -0,0 +1,275 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <map>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "placement.h"
+#include "thread_pool.h"
+using namespace std;
+
+
+/*!
+ * The following function parses a list of cores in the format used by /sys and by taskset (e.g. "0-3,8,10-11").
+ * @param text [string] := list of cores
+ * @return cpus [vector<int>] := indices of the cores
+ * @throw invalid_argument if the text is not a valid list
+ */
+static vector<int> parse_cpu_list(const string &text){
+
+    vector<int> cpus;
+    stringstream stream(text);
+    string range;
+    while(getline(stream, range, ',')){
+        if(range.empty() || range == "\n"){
+            continue;
+        }
+        size_t dash = range.find('-');
+        try{
+            int first = stoi(range.substr(0, dash));
+            int last = dash == string::npos ? first : stoi(range.substr(dash + 1));
+            for(int cpu = first; cpu <= last; cpu++){
+                cpus.push_back(cpu);
+            }
+        }
+        catch(const logic_error &){
+            throw invalid_argument("The list of cores '" + text + "' is not valid");
+        }
+    }
+    return cpus;
+}
+
+
+/*!
+ * The following function parses a placement given on the command line.
+ * @param text [string] := "compact", "scatter", "none" or a comma separated list of cores (e.g. "0,2,4,6")
+ * @return placement [Placement] := parsed placement
+ * @throw invalid_argument if the text is not a valid placement
+ */
+Placement parse_placement(const string &text){
+
+    Placement placement;
+    if(text == "none"){
+        placement.layout = PlacementLayout::NONE;
+    }
+    else if(text == "compact"){
+        placement.layout = PlacementLayout::COMPACT;
+    }
+    else if(text == "scatter"){
+        placement.layout = PlacementLayout::SCATTER;
+    }
+    else{
+        placement.layout = PlacementLayout::LIST;
+        placement.cpus = parse_cpu_list(text);
+        if(placement.cpus.empty()){
+            throw invalid_argument("The list of cores '" + text + "' is empty");
+        }
+    }
+    return placement;
+}
+
+
+/*!
+ * The following function reads the NUMA topology from /sys. If it is not available, all the cores are assigned to
+ * a single node.
+ * @return topology [Topology] := NUMA topology of the cores available to the process
+ */
+Topology detect_topology(){
+
+    Topology topology;
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    int max_cpu = CPU_SETSIZE;
+    topology.cpu_node.assign(max_cpu, -1);
+
+    for(int node = 0; ; node++){
+        ifstream input_file("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+        if(!input_file.is_open()){
+            break;
+        }
+        string list;
+        getline(input_file, list);
+        vector<int> cpus;
+        for(int cpu : parse_cpu_list(list)){
+            if(cpu < max_cpu && CPU_ISSET(cpu, &allowed)){
+                cpus.push_back(cpu);
+                topology.cpu_node[cpu] = node;
+            }
+        }
+        topology.node_cpus.push_back(cpus);
+    }
+
+    if(topology.node_cpus.empty()){ // no NUMA information: a single node with all the available cores
+        topology.node_cpus.emplace_back();
+        for(int cpu = 0; cpu < max_cpu; cpu++){
+            if(CPU_ISSET(cpu, &allowed)){
+                topology.node_cpus[0].push_back(cpu);
+                topology.cpu_node[cpu] = 0;
+            }
+        }
+    }
+    return topology;
+}
+
+
+/*!
+ * The following function computes the core of each worker.
+ * @param placement [Placement] := layout of the workers
+ * @param topology [Topology] := NUMA topology of the machine
+ * @param num_threads [int] := number of workers
+ * @return cpus [vector<int>] := core of each worker, empty if the layout is NONE
+ */
+vector<int> placement_cpus(const Placement &placement, const Topology &topology, int num_threads){
+
+    vector<int> order; // cores in the order in which they are given to the workers
+    if(placement.layout == PlacementLayout::NONE){
+        return order;
+    }
+    if(placement.layout == PlacementLayout::LIST){
+        order = placement.cpus;
+    }
+    else if(placement.layout == PlacementLayout::COMPACT){
+        for(const vector<int> &cpus : topology.node_cpus){
+            order.insert(order.end(), cpus.begin(), cpus.end());
+        }
+    }
+    else{ // SCATTER: the i-th core of every node before the (i+1)-th core of any node
+        size_t longest = 0;
+        for(const vector<int> &cpus : topology.node_cpus){
+            longest = max(longest, cpus.size());
+        }
+        for(size_t i = 0; i < longest; i++){
+            for(const vector<int> &cpus : topology.node_cpus){
+                if(i < cpus.size()){
+                    order.push_back(cpus[i]);
+                }
+            }
+        }
+    }
+    if(order.empty()){
+        throw invalid_argument("There are no cores available for the placement");
+    }
+
+    vector<int> cpus(num_threads);
+    for(int tid = 0; tid < num_threads; tid++){
+        cpus[tid] = order[tid % order.size()];
+    }
+    return cpus;
+}
+
+
+/*!
+ * The following function pins the calling thread to a core.
+ * @param cpu [int] := index of the core
+ * @return pinned [bool] := true if the thread has been pinned
+ */
+bool pin_current_thread(int cpu){
+
+    if(cpu < 0 || cpu >= CPU_SETSIZE){
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+
+/*!
+ * The following function returns the NUMA node of the page containing the given address.
+ * @param address [const void *] := address to look up
+ * @return node [int] := NUMA node of the page, -1 if the page is not mapped yet or the information is not available
+ */
+int page_node(const void *address){
+
+#ifdef SYS_move_pages
+    long page_size = sysconf(_SC_PAGESIZE);
+    void *page = (void *) ((uintptr_t) address & ~(uintptr_t) (page_size - 1));
+    int status = -1;
+    // move_pages without target nodes does not move anything, it only reports the node of each page
+    if(syscall(SYS_move_pages, 0, 1, &page, nullptr, &status, 0) == 0 && status >= 0){
+        return status;
+    }
+#endif
+    return -1;
+}
+
+
+/*!
+ * The following function copies the matrix into a new matrix whose row blocks are first touched by the workers of
+ * the pool that will compute them, with the same partitioning of the native threads engine, so that every row block
+ * lands on the NUMA node of its worker.
+ * @param matrix [Matrix] := matrix to copy
+ * @param pool [ThreadPool] := (pinned) pool of at least num_threads workers
+ * @param num_threads [int] := number of workers of the native threads engine
+ * @return placed [Matrix] := copy of the matrix with the pages placed on the nodes of the workers
+ */
+Matrix first_touch_copy(const Matrix &matrix, ThreadPool &pool, int num_threads){
+
+    int n = matrix.size();
+    int stride = matrix.row_stride();
+    int chunk = n / num_threads;
+    Matrix placed = Matrix::uninitialized(n);
+
+    auto body = [&](int tid) { // each worker writes (and so places) the rows it will compute
+        int start = tid * chunk;
+        int end = tid != num_threads - 1 ? start + chunk : n;
+        for(int i = start; i < end; i++){
+            memcpy(placed[i], matrix[i], stride * sizeof(float));
+        }
+    };
+    pool.run(num_threads, body);
+    return placed;
+}
+
+
+/*!
+ * The following function prints the core and the NUMA node on which each worker is running and, for each worker,
+ * the NUMA nodes of the pages of its row block.
+ * @param matrix [Matrix] := matrix of the linear system
+ * @param pool [ThreadPool] := pool of at least num_threads workers
+ * @param num_threads [int] := number of workers of the native threads engine
+ */
+void print_placement_report(const Matrix &matrix, ThreadPool &pool, int num_threads){
+
+    int n = matrix.size();
+    int chunk = n / num_threads;
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t row_bytes = (size_t) matrix.row_stride() * sizeof(float);
+    Topology topology = detect_topology();
+    vector<int> running_cpu(num_threads, -1);
+    vector<map<int, long>> pages(num_threads); // for each worker, number of pages of its rows on each node
+
+    auto body = [&](int tid) {
+        running_cpu[tid] = sched_getcpu();
+        int start = tid * chunk;
+        int end = tid != num_threads - 1 ? start + chunk : n;
+        if(start >= end){
+            return;
+        }
+        const char *first = (const char *) matrix[start];
+        const char *last = (const char *) matrix[end - 1] + row_bytes;
+        for(const char *address = first; address < last; address += page_size){
+            pages[tid][page_node(address)]++;
+        }
+    };
+    pool.run(num_threads, body);
+
+    cout << "PLACEMENT REPORT (" << topology.node_cpus.size() << " NUMA nodes)" << endl;
+    for(int tid = 0; tid < num_threads; tid++){
+        int cpu = running_cpu[tid];
+        int node = cpu >= 0 && cpu < (int) topology.cpu_node.size() ? topology.cpu_node[cpu] : -1;
+        cout << "THREAD " << tid << ": pinned to " << pool.cpu(tid) << ", running on cpu " << cpu << " (node " <<
+             node << "), pages of its rows:";
+        for(auto &[page_node_id, count] : pages[tid]){
+            cout << " node " << (page_node_id >= 0 ? to_string(page_node_id) : "unknown") << " = " << count;
+        }
+        cout << endl;
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "matrix.h"
+using namespace std;
+
+class ThreadPool;
+
+
+/*!
+ * The following enumeration lists the ways in which the workers can be pinned to the cores.
+ */
+enum class PlacementLayout {
+    NONE, // the workers are not pinned
+    COMPACT, // the workers fill all the cores of a NUMA node before moving to the next node
+    SCATTER, // the workers are distributed round-robin over the NUMA nodes
+    LIST // the workers are pinned to an explicit list of cores
+};
+
+
+/*!
+ * The following structure describes where the workers must be placed.
+ */
+struct Placement {
+    PlacementLayout layout = PlacementLayout::NONE;
+    vector<int> cpus; // cores used by the LIST layout, the worker tid is pinned to cpus[tid % cpus.size()]
+};
+
+
+/*!
+ * The following structure describes the NUMA topology of the machine, restricted to the cores the process can use.
+ */
+struct Topology {
+    vector<vector<int>> node_cpus; // cores of each NUMA node
+    vector<int> cpu_node; // NUMA node of each core, -1 if the core is not available
+};
+
+
+/*!
+ * The following function parses a placement given on the command line.
+ * @param text [string] := "compact", "scatter", "none" or a comma separated list of cores (e.g. "0,2,4,6")
+ * @return placement [Placement] := parsed placement
+ * @throw invalid_argument if the text is not a valid placement
+ */
+Placement parse_placement(const string &text);
+
+
+/*!
+ * The following function reads the NUMA topology from /sys. If it is not available, all the cores are assigned to
+ * a single node.
+ * @return topology [Topology] := NUMA topology of the cores available to the process
+ */
+Topology detect_topology();
+
+
+/*!
+ * The following function computes the core of each worker.
+ * @param placement [Placement] := layout of the workers
+ * @param topology [Topology] := NUMA topology of the machine
+ * @param num_threads [int] := number of workers
+ * @return cpus [vector<int>] := core of each worker, empty if the layout is NONE
+ */
+vector<int> placement_cpus(const Placement &placement, const Topology &topology, int num_threads);
+
+
+/*!
+ * The following function pins the calling thread to a core.
+ * @param cpu [int] := index of the core
+ * @return pinned [bool] := true if the thread has been pinned
+ */
+bool pin_current_thread(int cpu);
+
+
+/*!
+ * The following function returns the NUMA node of the page containing the given address.
+ * @param address [const void *] := address to look up
+ * @return node [int] := NUMA node of the page, -1 if the page is not mapped yet or the information is not available
+ */
+int page_node(const void *address);
+
+
+/*!
+ * The following function copies the matrix into a new matrix whose row blocks are first touched by the workers of
+ * the pool that will compute them, with the same partitioning of the native threads engine, so that every row block
+ * lands on the NUMA node of its worker.
+ * @param matrix [Matrix] := matrix to copy
+ * @param pool [ThreadPool] := (pinned) pool of at least num_threads workers
+ * @param num_threads [int] := number of workers of the native threads engine
+ * @return placed [Matrix] := copy of the matrix with the pages placed on the nodes of the workers
+ */
+Matrix first_touch_copy(const Matrix &matrix, ThreadPool &pool, int num_threads);
+
+
+/*!
+ * The following function prints the core and the NUMA node on which each worker is running and, for each worker,
+ * the NUMA nodes of the pages of its row block.
+ * @param matrix [Matrix] := matrix of the linear system
+ * @param pool [ThreadPool] := pool of at least num_threads workers
+ * @param num_threads [int] := number of workers of the native threads engine
+ */
+void print_placement_report(const Matrix &matrix, ThreadPool &pool, int num_threads);
@@ -0,0 +1,514 @@
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+#include "precision.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MIXED_KERNEL_X86
+#endif
+using namespace std;
+
+
+#define MIXED_LANES 8 // number of independent partial sums of the portable variants
+#define RESIDUAL_SLACK 2 // factor of the bound of residual_regressed
+
+
+/*!
+ * Types of the elements stored in half precision. They are distinct types, so that the kernels can be written once
+ * as templates and the conversion is chosen by overloading.
+ */
+struct fp16_t { uint16_t bits; };
+struct bf16_t { uint16_t bits; };
+
+
+/*!
+ * The following function converts a float to the nearest half precision number (ties to even). The values too large
+ * for the format become infinities and the values too small become subnormals or zeros.
+ * @param value [float] := value to convert
+ * @return bits [uint16_t] := bits of the half precision number
+ */
+static uint16_t float_to_fp16(float value){
+
+    uint32_t x;
+    memcpy(&x, &value, sizeof(x));
+    uint16_t sign = (x >> 16) & 0x8000;
+    uint32_t magnitude = x & 0x7fffffff;
+
+    if(magnitude >= 0x7f800000){ // infinity or NaN
+        return sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0);
+    }
+    if(magnitude >= 0x477ff000){ // it rounds to a value larger than 65504, the largest half precision number
+        return sign | 0x7c00;
+    }
+    if(magnitude < 0x38800000){ // smaller than 2^-14: subnormal half precision number, in units of 2^-24
+        float absolute;
+        memcpy(&absolute, &magnitude, sizeof(absolute));
+        return sign | (uint16_t) nearbyintf(absolute * 16777216.0f);
+    }
+    magnitude += 0xfff + ((magnitude >> 13) & 1); // round to nearest even on the 13 discarded bits
+    return sign | (uint16_t) ((magnitude - 0x38000000) >> 13); // the exponent bias goes from 127 to 15
+}
+
+
+/*!
+ * The following function converts a half precision number to float (the conversion is exact).
+ * @param bits [uint16_t] := bits of the half precision number
+ * @return value [float] := converted value
+ */
+static inline float fp16_to_float(uint16_t bits){
+
+    uint32_t sign = (uint32_t) (bits & 0x8000) << 16;
+    uint32_t exponent = (bits >> 10) & 0x1f;
+    uint32_t mantissa = bits & 0x3ff;
+    uint32_t x;
+
+    if(exponent == 0){ // zero or subnormal
+        float value = ldexpf((float) mantissa, -24);
+        memcpy(&x, &value, sizeof(x));
+        x |= sign;
+    }
+    else if(exponent == 31){ // infinity or NaN (quiet, as the F16C conversion does)
+        x = sign | 0x7f800000 | (mantissa << 13) | (mantissa != 0 ? 0x400000 : 0);
+    }
+    else{
+        x = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    float value;
+    memcpy(&value, &x, sizeof(value));
+    return value;
+}
+
+
+/*!
+ * The following function converts a float to the nearest bfloat16 number (ties to even), keeping the NaNs quiet.
+ * @param value [float] := value to convert
+ * @return bits [uint16_t] := bits of the bfloat16 number
+ */
+static uint16_t float_to_bf16(float value){
+
+    uint32_t x;
+    memcpy(&x, &value, sizeof(x));
+    if((x & 0x7fffffff) > 0x7f800000){
+        return (x >> 16) | 0x40;
+    }
+    x += 0x7fff + ((x >> 16) & 1);
+    return x >> 16;
+}
+
+
+static inline float to_float(float value){ return value; }
+
+
+static inline float to_float(fp16_t value){ return fp16_to_float(value.bits); }
+
+
+static inline float to_float(bf16_t value){
+
+    uint32_t x = (uint32_t) value.bits << 16;
+    float converted;
+    memcpy(&converted, &x, sizeof(converted));
+    return converted;
+}
+
+
+/*!
+ * The following function computes the dot product with independent partial sums that the compiler is able to
+ * vectorize on its own (the FP16 conversion is vectorized only if the compiler targets F16C). The products are
+ * computed in float and accumulated in the type Accumulator: with double, the rounding errors of the products stay
+ * independent while the error of the long sum, which grows with n, is removed.
+ * @param row [const void *] := pointer to the first element of the row, of type Element
+ * @param variables [const float *] := pointer to the first element of the vector
+ * @param n [int] := number of elements to multiply
+ * @return sum [double] := dot product of the two arrays, accumulated in the type Accumulator
+ */
+template <typename Element, typename Accumulator>
+static double mixed_dot_portable(const void *row, const float *variables, int n){
+
+    const Element *elements = static_cast<const Element *>(row);
+    Accumulator partial[MIXED_LANES] = {0};
+    int j = 0;
+    for(; j + MIXED_LANES <= n; j += MIXED_LANES){
+        for(int l = 0; l < MIXED_LANES; l++){
+            partial[l] += (Accumulator) (to_float(elements[j + l]) * variables[j + l]);
+        }
+    }
+    Accumulator sum = 0;
+    for(int l = 0; l < MIXED_LANES; l++){
+        sum += partial[l];
+    }
+    for(; j < n; j++){
+        sum += (Accumulator) (to_float(elements[j]) * variables[j]);
+    }
+    return sum;
+}
+
+
+/*!
+ * The following function computes the dot product with the kernel selected for row_dot, so that the FP32 storage with
+ * FLOAT accumulation behaves exactly as the plain engines.
+ */
+static double mixed_dot_row_dot(const void *row, const float *variables, int n){
+    return row_dot(static_cast<const float *>(row), variables, n);
+}
+
+
+#ifdef MIXED_KERNEL_X86
+
+#define MIXED_TARGET __attribute__((target("avx2,fma,f16c")))
+
+/*!
+ * The following functions load 8 consecutive elements of a row and convert them to float.
+ */
+MIXED_TARGET static inline __m256 load8(const float *elements){
+    return _mm256_loadu_ps(elements);
+}
+
+MIXED_TARGET static inline __m256 load8(const fp16_t *elements){
+    return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *) elements));
+}
+
+MIXED_TARGET static inline __m256 load8(const bf16_t *elements){
+    __m256i widened = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) elements));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(widened, 16));
+}
+
+
+/*!
+ * The following function computes the dot product with AVX2 intrinsics, accumulating in float with two vector
+ * accumulators and FMA. It must be called only if the CPU supports AVX2, FMA and F16C.
+ * @param row [const void *] := pointer to the first element of the row, of type Element
+ * @param variables [const float *] := pointer to the first element of the vector
+ * @param n [int] := number of elements to multiply
+ * @return sum [double] := dot product of the two arrays
+ */
+template <typename Element>
+MIXED_TARGET static double mixed_dot_avx2_float(const void *row, const float *variables, int n){
+
+    const Element *elements = static_cast<const Element *>(row);
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int j = 0;
+    for(; j + 16 <= n; j += 16){
+        acc0 = _mm256_fmadd_ps(load8(elements + j), _mm256_loadu_ps(variables + j), acc0);
+        acc1 = _mm256_fmadd_ps(load8(elements + j + 8), _mm256_loadu_ps(variables + j + 8), acc1);
+    }
+    if(j + 8 <= n){
+        acc0 = _mm256_fmadd_ps(load8(elements + j), _mm256_loadu_ps(variables + j), acc0);
+        j += 8;
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+    float sum = _mm_cvtss_f32(half);
+    for(; j < n; j++){
+        sum += to_float(elements[j]) * variables[j];
+    }
+    return sum;
+}
+
+
+/*!
+ * The following function computes the dot product with AVX2 intrinsics: the products are computed in float and
+ * accumulated in double with four vector accumulators. It must be called only if the CPU supports AVX2, FMA and F16C.
+ * @param row [const void *] := pointer to the first element of the row, of type Element
+ * @param variables [const float *] := pointer to the first element of the vector
+ * @param n [int] := number of elements to multiply
+ * @return sum [double] := dot product of the two arrays
+ */
+template <typename Element>
+MIXED_TARGET static double mixed_dot_avx2_double(const void *row, const float *variables, int n){
+
+    const Element *elements = static_cast<const Element *>(row);
+    __m256d acc[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+    int j = 0;
+    for(; j + 16 <= n; j += 16){
+        __m256 product0 = _mm256_mul_ps(load8(elements + j), _mm256_loadu_ps(variables + j));
+        __m256 product1 = _mm256_mul_ps(load8(elements + j + 8), _mm256_loadu_ps(variables + j + 8));
+        acc[0] = _mm256_add_pd(acc[0], _mm256_cvtps_pd(_mm256_castps256_ps128(product0)));
+        acc[1] = _mm256_add_pd(acc[1], _mm256_cvtps_pd(_mm256_extractf128_ps(product0, 1)));
+        acc[2] = _mm256_add_pd(acc[2], _mm256_cvtps_pd(_mm256_castps256_ps128(product1)));
+        acc[3] = _mm256_add_pd(acc[3], _mm256_cvtps_pd(_mm256_extractf128_ps(product1, 1)));
+    }
+    if(j + 8 <= n){
+        __m256 product = _mm256_mul_ps(load8(elements + j), _mm256_loadu_ps(variables + j));
+        acc[0] = _mm256_add_pd(acc[0], _mm256_cvtps_pd(_mm256_castps256_ps128(product)));
+        acc[1] = _mm256_add_pd(acc[1], _mm256_cvtps_pd(_mm256_extractf128_ps(product, 1)));
+        j += 8;
+    }
+    __m256d total = _mm256_add_pd(_mm256_add_pd(acc[0], acc[1]), _mm256_add_pd(acc[2], acc[3]));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(total), _mm256_extractf128_pd(total, 1));
+    half = _mm_add_sd(half, _mm_unpackhi_pd(half, half));
+    double sum = _mm_cvtsd_f64(half);
+    for(; j < n; j++){
+        sum += (double) (to_float(elements[j]) * variables[j]);
+    }
+    return sum;
+}
+
+#endif
+
+
+/*!
+ * The following function returns the variant of the mixed precision row kernel for the given element and
+ * accumulation types, using AVX2 if the CPU supports it.
+ */
+template <typename Element>
+static mixed_dot_function select_kernel(AccumulationType accumulation){
+
+#ifdef MIXED_KERNEL_X86
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c")){
+        return accumulation == AccumulationType::FLOAT ? mixed_dot_avx2_float<Element>
+                                                       : mixed_dot_avx2_double<Element>;
+    }
+#endif
+    return accumulation == AccumulationType::FLOAT ? mixed_dot_portable<Element, float>
+                                                   : mixed_dot_portable<Element, double>;
+}
+
+
+/*!
+ * The following function returns the best variant of the mixed precision row kernel supported by the CPU. The
+ * FP32 storage with FLOAT accumulation uses the variant selected for row_dot.
+ * @param format [StorageFormat] := format of the elements of the row
+ * @param accumulation [AccumulationType] := type in which the products are accumulated
+ * @return kernel [mixed_dot_function] := pointer to the variant
+ */
+mixed_dot_function mixed_kernel(StorageFormat format, AccumulationType accumulation){
+
+    switch(format){
+        case StorageFormat::FP16:
+            return select_kernel<fp16_t>(accumulation);
+        case StorageFormat::BF16:
+            return select_kernel<bf16_t>(accumulation);
+        default:
+            return accumulation == AccumulationType::FLOAT ? mixed_dot_row_dot : select_kernel<float>(accumulation);
+    }
+}
+
+
+/*!
+ * The following function parses a storage format given on the command line.
+ * @param text [string] := "fp32", "fp16" or "bf16"
+ * @return format [StorageFormat] := parsed format
+ * @throw invalid_argument if the text is not a valid format
+ */
+StorageFormat parse_storage(const string &text){
+
+    if(text == "fp32"){
+        return StorageFormat::FP32;
+    }
+    if(text == "fp16"){
+        return StorageFormat::FP16;
+    }
+    if(text == "bf16"){
+        return StorageFormat::BF16;
+    }
+    throw invalid_argument("The storage format '" + text + "' is not valid");
+}
+
+
+/*!
+ * The following function parses an accumulation type given on the command line.
+ * @param text [string] := "float" or "double"
+ * @return accumulation [AccumulationType] := parsed type
+ * @throw invalid_argument if the text is not a valid type
+ */
+AccumulationType parse_accumulation(const string &text){
+
+    if(text == "float"){
+        return AccumulationType::FLOAT;
+    }
+    if(text == "double"){
+        return AccumulationType::DOUBLE;
+    }
+    throw invalid_argument("The accumulation type '" + text + "' is not valid");
+}
+
+
+/*!
+ * @param format [StorageFormat] := storage format
+ * @return name [string] := name of the format, as accepted by parse_storage
+ */
+string storage_name(StorageFormat format){
+
+    switch(format){
+        case StorageFormat::FP16:
+            return "fp16";
+        case StorageFormat::BF16:
+            return "bf16";
+        default:
+            return "fp32";
+    }
+}
+
+
+/*!
+ * @param accumulation [AccumulationType] := accumulation type
+ * @return name [string] := name of the type, as accepted by parse_accumulation
+ */
+string accumulation_name(AccumulationType accumulation){
+    return accumulation == AccumulationType::FLOAT ? "float" : "double";
+}
+
+
+PrecisionMatrix::PrecisionMatrix(const Matrix &matrix, StorageFormat format, AccumulationType accumulation)
+        : format(format), accumulation(accumulation), n(matrix.size()), buffer(nullptr),
+          kernel(mixed_kernel(format, accumulation)) {
+
+    diagonal_elements.resize(n);
+    for(int i = 0; i < n; i++){
+        diagonal_elements[i] = matrix[i][i];
+    }
+
+    if(format == StorageFormat::FP32){ // the rows of the matrix are used as they are
+        element_size = sizeof(float);
+        stride = matrix.row_stride();
+        rows = reinterpret_cast<const char *>(matrix.data());
+        return;
+    }
+
+    element_size = sizeof(uint16_t);
+    int elements_per_line = CACHE_LINE / sizeof(uint16_t);
+    stride = (n + elements_per_line - 1) / elements_per_line * elements_per_line;
+    size_t bytes = (size_t) n * stride * sizeof(uint16_t);
+    if(bytes > 0){
+        buffer = static_cast<uint16_t *>(aligned_alloc(CACHE_LINE, bytes));
+        if(buffer == nullptr){
+            throw bad_alloc();
+        }
+    }
+    for(int i = 0; i < n; i++){
+        uint16_t *row = buffer + (size_t) i * stride;
+        for(int j = 0; j < stride; j++){
+            float value = j < n ? matrix[i][j] : 0;
+            row[j] = format == StorageFormat::FP16 ? float_to_fp16(value) : float_to_bf16(value);
+        }
+    }
+    rows = reinterpret_cast<const char *>(buffer);
+}
+
+
+PrecisionMatrix::~PrecisionMatrix(){
+    free(buffer);
+}
+
+
+/*!
+ * The following function computes the Jacobi's Algorithm entirely in double precision, with the same stopping
+ * criteria of the engines, in order to obtain a reference solution to measure the accuracy of the other formats.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm (disabled if smaller than 0)
+ * @param computed [int] := value passed by reference in which it will be stored the number of iterations computed
+ * @return solution [vector<double>] := reference solution
+ */
+vector<double> reference_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, double tolerance,
+                                int &computed){
+
+    int n = matrix.size();
+    vector<double> curr_variables(n, 0.0);
+    vector<double> prev_variables(n, 0.0);
+
+    computed = K;
+    for(int k = 0; k < K; k++){
+        swap(prev_variables, curr_variables);
+        long double difference = 0;
+        long double norm = 0;
+        for(int i = 0; i < n; i++){
+            const float *row = matrix[i];
+            double sum = 0;
+            for(int j = 0; j < n; j++){
+                if(j != i){
+                    sum += (double) row[j] * prev_variables[j];
+                }
+            }
+            curr_variables[i] = (knownTerm[i] - sum) / row[i];
+            difference += (curr_variables[i] - prev_variables[i]) * (curr_variables[i] - prev_variables[i]);
+            norm += curr_variables[i] * curr_variables[i];
+        }
+        if(tolerance >= 0 && sqrt(difference) / sqrt(norm) <= tolerance){
+            computed = k + 1;
+            break;
+        }
+    }
+    return curr_variables;
+}
+
+
+/*!
+ * The following function computes the relative residual ||b - Ax|| / ||b|| in double precision.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param solution [vector<T>] := solution x
+ * @return residual [long double] := relative residual
+ */
+template <typename T>
+static long double relative_residual(const Matrix &matrix, const vector<float> &knownTerm, const vector<T> &solution){
+
+    int n = matrix.size();
+    long double residual = 0;
+    long double norm = 0;
+    for(int i = 0; i < n; i++){
+        const float *row = matrix[i];
+        double product = 0;
+        for(int j = 0; j < n; j++){
+            product += (double) row[j] * solution[j];
+        }
+        residual += (knownTerm[i] - product) * (knownTerm[i] - product);
+        norm += (long double) knownTerm[i] * knownTerm[i];
+    }
+    return sqrt(residual) / sqrt(norm);
+}
+
+
+/*!
+ * The following function prints the accuracy of a solution: its relative and maximum error with respect to the
+ * reference solution and the relative residuals ||b - Ax|| / ||b|| of both, computed in double precision.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param solution [vector<float>] := solution to evaluate
+ * @param reference [vector<double>] := reference solution computed by reference_jacobi
+ */
+void print_accuracy(const Matrix &matrix, const vector<float> &knownTerm, const vector<float> &solution,
+                    const vector<double> &reference){
+
+    long double difference = 0;
+    long double norm = 0;
+    double max_error = 0;
+    for(size_t i = 0; i < reference.size(); i++){
+        double error = solution[i] - reference[i];
+        difference += error * error;
+        norm += reference[i] * reference[i];
+        max_error = max(max_error, fabs(error));
+    }
+    cout << "ACCURACY WITH RESPECT TO THE DOUBLE PRECISION REFERENCE" << endl;
+    cout << "RELATIVE ERROR: " << sqrt(difference) / sqrt(norm) << endl;
+    cout << "MAX ERROR: " << max_error << endl;
+    cout << "RELATIVE RESIDUAL: " << relative_residual(matrix, knownTerm, solution) << " (reference: " <<
+         relative_residual(matrix, knownTerm, reference) << ")" << endl;
+}
+
+
+/*!
+ * The following function checks that the residual of a solution has not regressed with respect to the reference one:
+ * ||b - Ax|| / ||b|| must be at most RESIDUAL_SLACK times the largest between the tolerance and the residual of the
+ * reference rounded to single precision, that is the smallest residual that a single precision solution can reach.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param solution [vector<float>] := solution to check
+ * @param reference [vector<double>] := reference solution computed by reference_jacobi
+ * @param tolerance [double] := tolerance of the solve
+ * @return regressed [bool] := true if the residual of the solution is above the bound
+ */
+bool residual_regressed(const Matrix &matrix, const vector<float> &knownTerm, const vector<float> &solution,
+                       const vector<double> &reference, double tolerance){
+
+    vector<float> rounded(reference.begin(), reference.end());
+    long double bound = max((long double) tolerance, relative_residual(matrix, knownTerm, rounded));
+    return relative_residual(matrix, knownTerm, solution) > RESIDUAL_SLACK * bound;
+}
@@ -0,0 +1,243 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "matrix.h"
+#include "row_kernel.h"
+using namespace std;
+
+
+/*!
+ * The following enumeration lists the formats in which the elements of the matrix can be stored.
+ */
+enum class StorageFormat {
+    FP32, // IEEE single precision (the elements of Matrix)
+    FP16, // IEEE half precision: 5 bits of exponent and 10 bits of mantissa
+    BF16 // brain floating point: the 16 most significant bits of a float (8 bits of exponent, 7 bits of mantissa)
+};
+
+
+/*!
+ * The following enumeration lists the types in which the dot products of the rows are accumulated.
+ */
+enum class AccumulationType { FLOAT, DOUBLE };
+
+
+/*!
+ * Signature shared by all the variants of the mixed precision row kernel: it computes the dot product between n
+ * elements of a row stored in some format and n elements of the vector of the variables.
+ */
+typedef double (*mixed_dot_function)(const void *row, const float *variables, int n);
+
+
+/*!
+ * The following function parses a storage format given on the command line.
+ * @param text [string] := "fp32", "fp16" or "bf16"
+ * @return format [StorageFormat] := parsed format
+ * @throw invalid_argument if the text is not a valid format
+ */
+StorageFormat parse_storage(const string &text);
+
+
+/*!
+ * The following function parses an accumulation type given on the command line.
+ * @param text [string] := "float" or "double"
+ * @return accumulation [AccumulationType] := parsed type
+ * @throw invalid_argument if the text is not a valid type
+ */
+AccumulationType parse_accumulation(const string &text);
+
+
+/*!
+ * @param format [StorageFormat] := storage format
+ * @return name [string] := name of the format, as accepted by parse_storage
+ */
+string storage_name(StorageFormat format);
+
+
+/*!
+ * @param accumulation [AccumulationType] := accumulation type
+ * @return name [string] := name of the type, as accepted by parse_accumulation
+ */
+string accumulation_name(AccumulationType accumulation);
+
+
+/*!
+ * The following function returns the best variant of the mixed precision row kernel supported by the CPU. The
+ * FP32 storage with FLOAT accumulation uses the variant selected for row_dot.
+ * @param format [StorageFormat] := format of the elements of the row
+ * @param accumulation [AccumulationType] := type in which the products are accumulated
+ * @return kernel [mixed_dot_function] := pointer to the variant
+ */
+mixed_dot_function mixed_kernel(StorageFormat format, AccumulationType accumulation);
+
+
+/*!
+ * The following class stores the matrix of a linear system in a (possibly) reduced precision format, together with
+ * the kernel that reads its rows. The elements are converted to float in registers and accumulated in float or in
+ * double, so that halving the bytes read for each element does not require computing in half precision. The diagonal
+ * is always kept in single precision. With the FP32 format the rows are not copied, they are read from the matrix given
+ * to the constructor, which must outlive this object.
+ */
+class PrecisionMatrix {
+
+private:
+    StorageFormat format;
+    AccumulationType accumulation;
+    int n;
+    int stride; // number of elements of each (padded) row
+    int element_size; // number of bytes of each element
+    uint16_t *buffer; // elements in FP16 or BF16 format, nullptr with the FP32 format
+    const char *rows; // first byte of the first row
+    vector<float> diagonal_elements;
+    mixed_dot_function kernel;
+
+public:
+
+    /*!
+     * The following constructor converts the matrix given as input to the storage format.
+     * @param matrix [Matrix] := matrix to convert (borrowed with the FP32 format)
+     * @param format [StorageFormat] := format of the stored elements
+     * @param accumulation [AccumulationType] := type in which the dot products are accumulated
+     */
+    PrecisionMatrix(const Matrix &matrix, StorageFormat format, AccumulationType accumulation);
+
+    PrecisionMatrix(const PrecisionMatrix &) = delete;
+    PrecisionMatrix &operator=(const PrecisionMatrix &) = delete;
+    ~PrecisionMatrix();
+
+    /*!
+     * @return n [int] := dimension of the matrix
+     */
+    int size() const { return n; }
+
+    /*!
+     * @return diagonal [const vector<float> &] := elements on the diagonal of the matrix, in single precision
+     */
+    const vector<float> &diagonal() const { return diagonal_elements; }
+
+    /*!
+     * @return format [StorageFormat] := format of the stored elements
+     */
+    StorageFormat storage() const { return format; }
+
+    /*!
+     * @return accumulation [AccumulationType] := type in which the dot products are accumulated
+     */
+    AccumulationType accumulation_type() const { return accumulation; }
+
+    /*!
+     * @return bytes [size_t] := number of bytes read for each element of the matrix
+     */
+    size_t bytes_per_element() const { return element_size; }
+
+    /*!
+     * The following function computes the new value of the i-th variable of the Jacobi's Algorithm, skipping the
+     * diagonal element as jacobi_row does.
+     * @param i [int] := index of the row
+     * @param variables [const float *] := solution computed at the previous iteration
+     * @param knownTerm [float] := i-th element of the vector b
+     * @param inverse_diagonal [float] := reciprocal of the i-th element of the diagonal
+     * @return variable [float] := value of the i-th variable at the current iteration
+     */
+    float row_update(int i, const float *variables, float knownTerm, float inverse_diagonal) const {
+        const char *row = rows + (size_t) i * stride * element_size;
+        double sum = kernel(row, variables, i) +
+                     kernel(row + (size_t) (i + 1) * element_size, variables + i + 1, n - i - 1);
+        return (float) ((knownTerm - sum) * inverse_diagonal);
+    }
+
+    /*!
+     * The following function computes the dot product between the elements of the i-th row in [first, first + count)
+     * and the same elements of the vector of the variables.
+     * @param i [int] := index of the row
+     * @param first [int] := first element of the row to multiply
+     * @param count [int] := number of elements to multiply
+     * @param variables [const float *] := pointer to the first element of the vector
+     * @return sum [double] := dot product, accumulated in the type of the matrix
+     */
+    double row_dot(int i, int first, int count, const float *variables) const {
+        const char *row = rows + ((size_t) i * stride + first) * element_size;
+        return kernel(row, variables + first, count);
+    }
+};
+
+
+/*!
+ * The following functions compute the new value of the i-th variable of the Jacobi's Algorithm on a matrix stored in
+ * any of the dense formats, so that the dense engines can be written once for all of them.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param i [int] := index of the row
+ * @param variables [const float *] := solution computed at the previous iteration
+ * @param knownTerm [float] := i-th element of the vector b
+ * @param inverse_diagonal [float] := reciprocal of the i-th element of the diagonal
+ * @return variable [float] := value of the i-th variable at the current iteration
+ */
+inline float jacobi_row(const Matrix &matrix, int i, const float *variables, float knownTerm, float inverse_diagonal){
+    return jacobi_row(matrix[i], variables, knownTerm, inverse_diagonal, i, matrix.size());
+}
+
+inline float jacobi_row(const PrecisionMatrix &matrix, int i, const float *variables, float knownTerm,
+                        float inverse_diagonal){
+    return matrix.row_update(i, variables, knownTerm, inverse_diagonal);
+}
+
+
+/*!
+ * The following functions compute the dot product between the elements of the i-th row in [first, first + count) and
+ * the same elements of the vector of the variables, on a matrix stored in any of the dense formats.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param i [int] := index of the row
+ * @param first [int] := first element of the row to multiply
+ * @param count [int] := number of elements to multiply
+ * @param variables [const float *] := pointer to the first element of the vector
+ * @return sum [double] := dot product
+ */
+inline double range_dot(const Matrix &matrix, int i, int first, int count, const float *variables){
+    return row_dot(matrix[i] + first, variables + first, count);
+}
+
+inline double range_dot(const PrecisionMatrix &matrix, int i, int first, int count, const float *variables){
+    return matrix.row_dot(i, first, count, variables);
+}
+
+
+/*!
+ * The following function computes the Jacobi's Algorithm entirely in double precision, with the same stopping
+ * criteria of the engines, in order to obtain a reference solution to measure the accuracy of the other formats.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param K [int] := maximum number of iterations of the Jacobi's Algorithm
+ * @param tolerance [double] := tolerance used to stop earlier the algorithm (disabled if smaller than 0)
+ * @param computed [int] := value passed by reference in which it will be stored the number of iterations computed
+ * @return solution [vector<double>] := reference solution
+ */
+vector<double> reference_jacobi(const Matrix &matrix, const vector<float> &knownTerm, int K, double tolerance,
+                                int &computed);
+
+
+/*!
+ * The following function prints the accuracy of a solution: its relative and maximum error with respect to the
+ * reference solution and the relative residuals ||b - Ax|| / ||b|| of both, computed in double precision.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param solution [vector<float>] := solution to evaluate
+ * @param reference [vector<double>] := reference solution computed by reference_jacobi
+ */
+void print_accuracy(const Matrix &matrix, const vector<float> &knownTerm, const vector<float> &solution,
+                    const vector<double> &reference);
+
+
+/*!
+ * The following function checks that the residual of a solution has not regressed with respect to the reference one:
+ * ||b - Ax|| / ||b|| must be at most RESIDUAL_SLACK times the largest between the tolerance and the residual of the
+ * reference rounded to single precision, that is the smallest residual that a single precision solution can reach.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param solution [vector<float>] := solution to check
+ * @param reference [vector<double>] := reference solution computed by reference_jacobi
+ * @param tolerance [double] := tolerance of the solve
+ * @return regressed [bool] := true if the residual of the solution is above the bound
+ */
+bool residual_regressed(const Matrix &matrix, const vector<float> &knownTerm, const vector<float> &solution,
+                       const vector<double> &reference, double tolerance);
@@ -0,0 +1,249 @@
+#include <string>
+#include "row_kernel.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ROW_KERNEL_X86
+#endif
+using namespace std;
+
+
+#define AUTO_LANES 16 // number of independent partial sums of the autovectorized variant
+
+
+/*!
+ * The following function computes the dot product with a plain scalar loop (one accumulator, no vectorization).
+ * @param row [const float *] := pointer to the first element of the row
+ * @param variables [const float *] := pointer to the first element of the vector
+ * @param n [int] := number of elements to multiply
+ * @return sum [float] := dot product of the two arrays
+ */
+float row_dot_scalar(const float *row, const float *variables, int n){
+
+    float sum = 0;
+    for(int j = 0; j < n; j++){
+        sum += row[j] * variables[j];
+    }
+    return sum;
+}
+
+
+/*!
+ * The following function computes the dot product with independent partial sums that the compiler is able to
+ * vectorize on its own.
+ * @param row [const float *] := pointer to the first element of the row
+ * @param variables [const float *] := pointer to the first element of the vector
+ * @param n [int] := number of elements to multiply
+ * @return sum [float] := dot product of the two arrays
+ */
+float row_dot_auto(const float *row, const float *variables, int n){
+
+    float partial[AUTO_LANES] = {0};
+    int j = 0;
+    for(; j + AUTO_LANES <= n; j += AUTO_LANES){
+        for(int l = 0; l < AUTO_LANES; l++){
+            partial[l] += row[j + l] * variables[j + l];
+        }
+    }
+    float sum = 0;
+    for(int l = 0; l < AUTO_LANES; l++){
+        sum += partial[l];
+    }
+    for(; j < n; j++){
+        sum += row[j] * variables[j];
+    }
+    return sum;
+}
+
+
+#ifdef ROW_KERNEL_X86
+
+/*!
+ * The following function computes the dot product with AVX2 intrinsics, using four vector accumulators and FMA.
+ * It must be called only if the CPU supports AVX2 and FMA (see row_kernel_supported).
+ * @param row [const float *] := pointer to the first element of the row
+ * @param variables [const float *] := pointer to the first element of the vector
+ * @param n [int] := number of elements to multiply
+ * @return sum [float] := dot product of the two arrays
+ */
+__attribute__((target("avx2,fma")))
+float row_dot_avx2(const float *row, const float *variables, int n){
+
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+    int j = 0;
+    for(; j + 32 <= n; j += 32){
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(row + j), _mm256_loadu_ps(variables + j), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(row + j + 8), _mm256_loadu_ps(variables + j + 8), acc1);
+        acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(row + j + 16), _mm256_loadu_ps(variables + j + 16), acc2);
+        acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(row + j + 24), _mm256_loadu_ps(variables + j + 24), acc3);
+    }
+    for(; j + 8 <= n; j += 8){
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(row + j), _mm256_loadu_ps(variables + j), acc0);
+    }
+    __m256 acc = _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3));
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_movehdup_ps(half));
+    float sum = _mm_cvtss_f32(half);
+    for(; j < n; j++){
+        sum += row[j] * variables[j];
+    }
+    return sum;
+}
+
+
+/*!
+ * The following function computes the dot product with AVX-512 intrinsics, using four vector accumulators and FMA.
+ * It must be called only if the CPU supports AVX-512F (see row_kernel_supported).
+ * @param row [const float *] := pointer to the first element of the row
+ * @param variables [const float *] := pointer to the first element of the vector
+ * @param n [int] := number of elements to multiply
+ * @return sum [float] := dot product of the two arrays
+ */
+__attribute__((target("avx512f")))
+float row_dot_avx512(const float *row, const float *variables, int n){
+
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    __m512 acc2 = _mm512_setzero_ps();
+    __m512 acc3 = _mm512_setzero_ps();
+    int j = 0;
+    for(; j + 64 <= n; j += 64){
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(row + j), _mm512_loadu_ps(variables + j), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(row + j + 16), _mm512_loadu_ps(variables + j + 16), acc1);
+        acc2 = _mm512_fmadd_ps(_mm512_loadu_ps(row + j + 32), _mm512_loadu_ps(variables + j + 32), acc2);
+        acc3 = _mm512_fmadd_ps(_mm512_loadu_ps(row + j + 48), _mm512_loadu_ps(variables + j + 48), acc3);
+    }
+    for(; j + 16 <= n; j += 16){
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(row + j), _mm512_loadu_ps(variables + j), acc0);
+    }
+    if(j < n){ // the tail is handled with a masked load, so no element outside the arrays is read
+        __mmask16 mask = (__mmask16) ((1u << (n - j)) - 1);
+        acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, row + j), _mm512_maskz_loadu_ps(mask, variables + j), acc1);
+    }
+    __m512 acc = _mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3));
+    return _mm512_reduce_add_ps(acc);
+}
+
+#else
+
+float row_dot_avx2(const float *row, const float *variables, int n){
+    return row_dot_auto(row, variables, n);
+}
+
+float row_dot_avx512(const float *row, const float *variables, int n){
+    return row_dot_auto(row, variables, n);
+}
+
+#endif
+
+
+/*!
+ * The following function tells if a variant of the row kernel can be executed on the current CPU.
+ * @param name [string] := name of the variant ("scalar", "auto", "avx2" or "avx512")
+ * @return supported [bool] := true if the variant exists and the CPU supports it
+ */
+bool row_kernel_supported(const string &name){
+
+    if(name == "scalar" || name == "auto"){
+        return true;
+    }
+#ifdef ROW_KERNEL_X86
+    if(name == "avx2"){
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    }
+    if(name == "avx512"){
+        return __builtin_cpu_supports("avx512f");
+    }
+#endif
+    return false;
+}
+
+
+/*!
+ * The following function returns the variant of the row kernel with the given name.
+ * @param name [string] := name of the variant ("scalar", "auto", "avx2" or "avx512")
+ * @return kernel [row_dot_function] := pointer to the variant, nullptr if it does not exist or it is not supported
+ */
+row_dot_function row_kernel_by_name(const string &name){
+
+    if(!row_kernel_supported(name)){
+        return nullptr;
+    }
+    if(name == "scalar"){
+        return row_dot_scalar;
+    }
+    if(name == "auto"){
+        return row_dot_auto;
+    }
+    if(name == "avx2"){
+        return row_dot_avx2;
+    }
+    return row_dot_avx512;
+}
+
+
+static string selected_name; // name of the variant used by row_dot, empty until the first selection
+
+
+/*!
+ * The following function selects the best variant supported by the CPU.
+ */
+static void select_best_row_kernel(){
+
+    static bool selected = [](){ // the static initialization runs once even if several threads get here together
+        for(const string name : {"avx512", "avx2", "auto"}){
+            if(row_kernel_select(name)){
+                return true;
+            }
+        }
+        return false;
+    }();
+    (void) selected;
+}
+
+
+/*!
+ * The following function is the initial target of row_dot: at the first call it selects the best variant (so the
+ * selection does not depend on the initialization order of the static variables) and then forwards the call to it.
+ */
+static float row_dot_resolve(const float *row, const float *variables, int n){
+
+    select_best_row_kernel();
+    return row_dot(row, variables, n);
+}
+
+
+atomic<row_dot_function> row_dot_dispatch(row_dot_resolve);
+
+
+/*!
+ * The following function forces the variant used by row_dot. By default the best variant supported by the CPU is
+ * selected at the first call.
+ * @param name [string] := name of the variant ("scalar", "auto", "avx2" or "avx512")
+ * @return selected [bool] := false if the variant does not exist or it is not supported (the selection is unchanged)
+ */
+bool row_kernel_select(const string &name){
+
+    row_dot_function kernel = row_kernel_by_name(name);
+    if(kernel == nullptr){
+        return false;
+    }
+    selected_name = name;
+    row_dot_dispatch.store(kernel);
+    return true;
+}
+
+
+/*!
+ * @return name [string] := name of the variant currently used by row_dot
+ */
+string row_kernel_name(){
+
+    if(selected_name.empty()){
+        select_best_row_kernel();
+    }
+    return selected_name;
+}
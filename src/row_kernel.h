@@ -0,0 +1,119 @@
+#pragma once
+#include <string>
+#include <atomic>
+using namespace std;
+
+
+/*!
+ * Signature shared by all the variants of the row kernel: it computes the dot product between n elements of a row of
+ * the matrix and n elements of the vector of the variables.
+ */
+typedef float (*row_dot_function)(const float *row, const float *variables, int n);
+
+
+/*!
+ * The following function computes the dot product with a plain scalar loop (one accumulator, no vectorization).
+ * @param row [const float *] := pointer to the first element of the row
+ * @param variables [const float *] := pointer to the first element of the vector
+ * @param n [int] := number of elements to multiply
+ * @return sum [float] := dot product of the two arrays
+ */
+float row_dot_scalar(const float *row, const float *variables, int n);
+
+
+/*!
+ * The following function computes the dot product with independent partial sums that the compiler is able to
+ * vectorize on its own.
+ * @param row [const float *] := pointer to the first element of the row
+ * @param variables [const float *] := pointer to the first element of the vector
+ * @param n [int] := number of elements to multiply
+ * @return sum [float] := dot product of the two arrays
+ */
+float row_dot_auto(const float *row, const float *variables, int n);
+
+
+/*!
+ * The following function computes the dot product with AVX2 intrinsics, using four vector accumulators and FMA.
+ * It must be called only if the CPU supports AVX2 and FMA (see row_kernel_supported).
+ * @param row [const float *] := pointer to the first element of the row
+ * @param variables [const float *] := pointer to the first element of the vector
+ * @param n [int] := number of elements to multiply
+ * @return sum [float] := dot product of the two arrays
+ */
+float row_dot_avx2(const float *row, const float *variables, int n);
+
+
+/*!
+ * The following function computes the dot product with AVX-512 intrinsics, using four vector accumulators and FMA.
+ * It must be called only if the CPU supports AVX-512F (see row_kernel_supported).
+ * @param row [const float *] := pointer to the first element of the row
+ * @param variables [const float *] := pointer to the first element of the vector
+ * @param n [int] := number of elements to multiply
+ * @return sum [float] := dot product of the two arrays
+ */
+float row_dot_avx512(const float *row, const float *variables, int n);
+
+
+/*!
+ * The following function tells if a variant of the row kernel can be executed on the current CPU.
+ * @param name [string] := name of the variant ("scalar", "auto", "avx2" or "avx512")
+ * @return supported [bool] := true if the variant exists and the CPU supports it
+ */
+bool row_kernel_supported(const string &name);
+
+
+/*!
+ * The following function returns the variant of the row kernel with the given name.
+ * @param name [string] := name of the variant ("scalar", "auto", "avx2" or "avx512")
+ * @return kernel [row_dot_function] := pointer to the variant, nullptr if it does not exist or it is not supported
+ */
+row_dot_function row_kernel_by_name(const string &name);
+
+
+/*!
+ * The following function forces the variant used by row_dot. By default the best variant supported by the CPU is
+ * selected at the first call.
+ * @param name [string] := name of the variant ("scalar", "auto", "avx2" or "avx512")
+ * @return selected [bool] := false if the variant does not exist or it is not supported (the selection is unchanged)
+ */
+bool row_kernel_select(const string &name);
+
+
+/*!
+ * @return name [string] := name of the variant currently used by row_dot
+ */
+string row_kernel_name();
+
+
+extern atomic<row_dot_function> row_dot_dispatch; // variant used by row_dot, selected at the first call
+
+
+/*!
+ * The following function computes the dot product between a row and the vector with the selected variant.
+ * @param row [const float *] := pointer to the first element of the row
+ * @param variables [const float *] := pointer to the first element of the vector
+ * @param n [int] := number of elements to multiply
+ * @return sum [float] := dot product of the two arrays
+ */
+inline float row_dot(const float *row, const float *variables, int n){
+    return row_dot_dispatch.load(memory_order_relaxed)(row, variables, n);
+}
+
+
+/*!
+ * The following function computes the new value of the i-th variable of the Jacobi's Algorithm. The diagonal element
+ * is skipped by splitting the row in the parts before and after it, so that there is no branch inside the reduction,
+ * and the division by the diagonal is replaced by the multiplication with its precomputed reciprocal.
+ * @param row [const float *] := pointer to the first element of the i-th row of the matrix
+ * @param variables [const float *] := solution computed at the previous iteration
+ * @param knownTerm [float] := i-th element of the vector b
+ * @param inverse_diagonal [float] := reciprocal of the i-th element of the diagonal
+ * @param i [int] := index of the row
+ * @param n [int] := dimension of the linear system
+ * @return variable [float] := value of the i-th variable at the current iteration
+ */
+inline float jacobi_row(const float *row, const float *variables, float knownTerm, float inverse_diagonal, int i,
+                        int n){
+    float sum = row_dot(row, variables, i) + row_dot(row + i + 1, variables + i + 1, n - i - 1);
+    return (knownTerm - sum) * inverse_diagonal;
+}
@@ -0,0 +1,125 @@
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include "scheduler.h"
+using namespace std;
+
+
+/*!
+ * The following function parses a schedule given on the command line.
+ * @param text [string] := "static", "steal" or "steal:[ROWS]" (e.g. steal:64)
+ * @return schedule [Schedule] := parsed schedule
+ * @throw invalid_argument if the text is not a valid schedule
+ */
+Schedule parse_schedule(const string &text){
+
+    Schedule schedule;
+    if(text == "static"){
+        return schedule;
+    }
+    schedule.policy = SchedulePolicy::STEAL;
+    if(text == "steal"){
+        return schedule;
+    }
+    try{
+        if(text.rfind("steal:", 0) != 0){
+            throw invalid_argument(text);
+        }
+        size_t end;
+        schedule.block_rows = stoi(text.substr(6), &end);
+        if(end != text.size() - 6 || schedule.block_rows < 1){
+            throw invalid_argument(text);
+        }
+    }
+    catch(const exception &){
+        throw invalid_argument("The schedule '" + text + "' is not valid: it must be static, steal or steal:[ROWS] "
+                               "with ROWS >= 1");
+    }
+    return schedule;
+}
+
+
+/*!
+ * @param schedule [Schedule] := schedule of the rows
+ * @return name [string] := name of the schedule, as accepted by parse_schedule
+ */
+string schedule_name(const Schedule &schedule){
+
+    if(schedule.policy == SchedulePolicy::STATIC){
+        return "static";
+    }
+    return schedule.block_rows > 0 ? "steal:" + to_string(schedule.block_rows) : "steal";
+}
+
+
+/*!
+ * @param bounds [vector<int>] := the worker t owns the rows in [bounds[t], bounds[t + 1])
+ * @param block_rows [int] := rows of each block, if smaller than 1 each chunk is split in STEAL_BLOCKS_PER_THREAD
+ * blocks
+ */
+StealQueues::StealQueues(const vector<int> &bounds, int block_rows) : queues(bounds.size() - 1),
+                                                                        owned(bounds.size()) {
+
+    int workers = bounds.size() - 1;
+    for(int t = 0; t < workers; t++){ // the blocks never cross two chunks, so each block has a single owner
+        owned[t] = block_start.size();
+        int rows = bounds[t + 1] - bounds[t];
+        int size = block_rows > 0 ? block_rows : max(1, (rows + STEAL_BLOCKS_PER_THREAD - 1) / STEAL_BLOCKS_PER_THREAD);
+        for(int first = bounds[t]; first < bounds[t + 1]; first += size){
+            block_start.push_back(first);
+        }
+    }
+    owned[workers] = block_start.size();
+    block_start.push_back(bounds[workers]);
+    refill();
+}
+
+
+/*!
+ * The following function gives back to each worker all its blocks. It must be called when no worker is taking
+ * blocks, e.g. by the completion function of the barrier.
+ */
+void StealQueues::refill(){
+
+    for(size_t t = 0; t < queues.size(); t++){
+        queues[t].range.store((uint64_t) owned[t] << 32 | (uint32_t) owned[t + 1], memory_order_relaxed);
+    }
+}
+
+
+/*!
+ * The following function gives the next block to compute to a worker: one of its own blocks, in order, or a block
+ * stolen from another worker if it has none left.
+ * @param tid [int] := index of the worker
+ * @param first [int] := value passed by reference in which it will be stored the first row of the block
+ * @param last [int] := value passed by reference in which it will be stored the row after the last of the block
+ * @return found [bool] := false if all the blocks of the iteration have been taken
+ */
+bool StealQueues::next(int tid, int &first, int &last){
+
+    int workers = queues.size();
+    for(int v = 0; v < workers; v++){ // the own queue first, then the neighbours, which are usually on the same node
+        int victim = (tid + v) % workers;
+        atomic<uint64_t> &range = queues[victim].range;
+        uint64_t current = range.load(memory_order_relaxed);
+        while(true){
+            uint32_t head = current >> 32;
+            uint32_t tail = (uint32_t) current;
+            if(head >= tail){
+                break;
+            }
+            // the owner moves the head forward, so its blocks are computed in order; the thieves move the tail back
+            uint32_t block = v == 0 ? head : tail - 1;
+            uint64_t taken = v == 0 ? (uint64_t) (head + 1) << 32 | tail : (uint64_t) head << 32 | (tail - 1);
+            if(range.compare_exchange_weak(current, taken, memory_order_relaxed)){
+                if(v != 0){
+                    stolen.fetch_add(1, memory_order_relaxed);
+                }
+                first = block_start[block];
+                last = block_start[block + 1];
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include "matrix.h"
+using namespace std;
+
+
+#define STEAL_BLOCKS_PER_THREAD 16 // blocks of each thread when the size of the blocks is chosen automatically
+
+
+/*!
+ * The following enumeration lists how the rows are assigned to the workers of the native threads engines.
+ */
+enum class SchedulePolicy {
+    STATIC, // each worker always computes the same chunk of consecutive rows
+    STEAL // each worker starts from its chunk, split in blocks, and steals the blocks of the others when it is done
+};
+
+
+/*!
+ * The following structure describes the scheduling of the rows of the native threads engines.
+ */
+struct Schedule {
+    SchedulePolicy policy = SchedulePolicy::STATIC;
+    int block_rows = 0; // rows (work units of the sparse formats) of each block, chosen automatically if 0
+};
+
+
+/*!
+ * The following function parses a schedule given on the command line.
+ * @param text [string] := "static", "steal" or "steal:[ROWS]" (e.g. steal:64)
+ * @return schedule [Schedule] := parsed schedule
+ * @throw invalid_argument if the text is not a valid schedule
+ */
+Schedule parse_schedule(const string &text);
+
+
+/*!
+ * @param schedule [Schedule] := schedule of the rows
+ * @return name [string] := name of the schedule, as accepted by parse_schedule
+ */
+string schedule_name(const Schedule &schedule);
+
+
+/*!
+ * The following class stores a queue of blocks of rows for each worker. Each worker owns the blocks of its static
+ * chunk, so without imbalance the blocks never move and each worker reads the same rows at every iteration; a
+ * worker that has finished its blocks steals from the end of the queues of the others, starting from its neighbours.
+ * Each queue is the range [head, tail) of its blocks packed in a single atomic word: the owner takes the head and the
+ * thieves take the tail with a compare-and-swap, so no lock is ever taken.
+ */
+class StealQueues {
+
+private:
+    struct alignas(CACHE_LINE) Queue {
+        atomic<uint64_t> range{0}; // head in the high 32 bits, tail in the low 32 bits
+    };
+
+    vector<Queue> queues; // one for each worker
+    vector<int> owned; // the worker t owns the blocks in [owned[t], owned[t + 1])
+    vector<int> block_start; // the block b computes the rows in [block_start[b], block_start[b + 1])
+    atomic<long> stolen{0}; // blocks computed by a worker that does not own them
+
+public:
+
+    /*!
+     * @param bounds [vector<int>] := the worker t owns the rows in [bounds[t], bounds[t + 1])
+     * @param block_rows [int] := rows of each block, if smaller than 1 each chunk is split in STEAL_BLOCKS_PER_THREAD
+     * blocks
+     */
+    StealQueues(const vector<int> &bounds, int block_rows);
+
+    StealQueues(const StealQueues &) = delete;
+    StealQueues &operator=(const StealQueues &) = delete;
+
+    /*!
+     * The following function gives back to each worker all its blocks. It must be called when no worker is taking
+     * blocks, e.g. by the completion function of the barrier.
+     */
+    void refill();
+
+    /*!
+     * The following function gives the next block to compute to a worker: one of its own blocks, in order, or a
+     * block stolen from another worker if it has none left.
+     * @param tid [int] := index of the worker
+     * @param first [int] := value passed by reference in which it will be stored the first row of the block
+     * @param last [int] := value passed by reference in which it will be stored the row after the last of the block
+     * @return found [bool] := false if all the blocks of the iteration have been taken
+     */
+    bool next(int tid, int &first, int &last);
+
+    /*!
+     * @return blocks [int] := number of blocks of an iteration
+     */
+    int blocks() const { return (int) block_start.size() - 1; }
+
+    /*!
+     * @return stolen [long] := blocks stolen since the queues have been created
+     */
+    long stolen_blocks() const { return stolen.load(memory_order_relaxed); }
+};
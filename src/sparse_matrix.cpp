@@ -0,0 +1,309 @@
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include "sparse_matrix.h"
+#include "generator.h"
+#include "jacobi_workspace.h"
+using namespace std;
+
+
+#define MAX_SELL_C 64 // maximum number of rows of a chunk of the SELL-C-sigma format
+
+
+/*!
+ * The following function allows the generation of a sparse diagonal dominant matrix with the following parameters:
+ * @param n [int] := dimension of the matrix
+ * @param nonzeros_per_row [int] := average number of off-diagonal non-zero elements of each row (the length of each
+ * row is random in [1, 2 * nonzeros_per_row - 1], so the rows have different lengths)
+ * @param min_matrix [float] := minimum value of the matrix
+ * @param max_matrix [float] := maximum value of the matrix
+ * @param seed [int] := seed to generate the random values
+ * @param pool [ThreadPool] := pool of at least num_threads workers
+ * @param num_threads [int] := number of workers that generate the rows
+ * @return matrix [CSRMatrix] := matrix of dimension n with off-diagonal values in the range [min_matrix, max_matrix]
+ * and with the elements on the diagonal computed as the sum of the elements of the corresponding row multiplied by 2.
+ */
+CSRMatrix generate_sparse_matrix(int n, int nonzeros_per_row, float min_matrix, float max_matrix, int seed,
+                                 ThreadPool &pool, int num_threads){
+
+    if(nonzeros_per_row < 1){
+        throw invalid_argument("The number of non-zero elements of each row must be >= 1");
+    }
+
+    CSRMatrix matrix;
+    matrix.n = n;
+    matrix.diagonal.resize(n);
+    matrix.row_ptr.resize(n + 1);
+    matrix.row_ptr[0] = 0;
+    int chunk = n / num_threads;
+    float range = max_matrix - min_matrix;
+
+    // the k-th number drawn for the i-th row has the counter (i, k): the length is the first one, so the offsets of the
+    // rows are known before their elements are drawn and each worker fills its rows in place
+    auto lengths = [&](int tid) {
+        int start = tid * chunk;
+        int end = tid != num_threads - 1 ? start + chunk : n;
+        for(int i = start; i < end; i++){
+            int length = (int) (counter_uniform(seed, SPARSE_STREAM, (uint64_t) i << 32) * (2 * nonzeros_per_row - 1));
+            matrix.row_ptr[i + 1] = min(1 + length, n - 1);
+        }
+    };
+    pool.run(num_threads, lengths);
+    partial_sum(matrix.row_ptr.begin(), matrix.row_ptr.end(), matrix.row_ptr.begin());
+    matrix.col_idx.resize(matrix.row_ptr[n]);
+    matrix.values.resize(matrix.row_ptr[n]);
+
+    auto rows = [&](int tid) {
+        int start = tid * chunk;
+        int end = tid != num_threads - 1 ? start + chunk : n;
+        for(int i = start; i < end; i++){
+            int *columns = matrix.col_idx.data() + matrix.row_ptr[i];
+            int length = matrix.row_ptr[i + 1] - matrix.row_ptr[i];
+            uint64_t counter = (uint64_t) i << 32 | 1;
+            for(int count = 0; count < length; counter++){ // distinct random columns different from the diagonal
+                int j = min((int) (counter_uniform(seed, SPARSE_STREAM, counter) * n), n - 1);
+                if(j != i && find(columns, columns + count, j) == columns + count){
+                    columns[count++] = j;
+                }
+            }
+            sort(columns, columns + length);
+
+            float sum = 0;
+            for(int k = 0; k < length; k++, counter++){
+                float value = min_matrix + range * counter_uniform(seed, SPARSE_STREAM, counter);
+                matrix.values[matrix.row_ptr[i] + k] = value;
+                sum += value;
+            }
+            matrix.diagonal[i] = sum != 0 ? sum * 2 : 1; // it allows to have a diagonal dominant matrix
+        }
+    };
+    pool.run(num_threads, rows);
+    return matrix;
+}
+
+
+/*!
+ * The following function converts a matrix from the CSR format to the SELL-C-sigma format.
+ * @param matrix [CSRMatrix] := matrix to convert
+ * @param C [int] := number of rows of each chunk
+ * @param sigma [int] := number of rows of each sorting window (a multiple of C)
+ * @return matrix [SellMatrix] := converted matrix
+ */
+SellMatrix csr_to_sell(const CSRMatrix &matrix, int C, int sigma){
+
+    if(C < 1 || C > MAX_SELL_C){
+        throw invalid_argument("The number of rows of a chunk must be in [1, " + to_string(MAX_SELL_C) + "]");
+    }
+    int n = matrix.n;
+    sigma = max(C, (sigma + C - 1) / C * C);
+    auto length = [&](int i) { return matrix.row_ptr[i + 1] - matrix.row_ptr[i]; };
+
+    SellMatrix sell;
+    sell.n = n;
+    sell.C = C;
+    sell.sigma = sigma;
+    sell.diagonal = matrix.diagonal;
+    sell.permutation.resize(n);
+    iota(sell.permutation.begin(), sell.permutation.end(), 0);
+    for(int w = 0; w < n; w += sigma){ // the longest rows first inside each window
+        stable_sort(sell.permutation.begin() + w, sell.permutation.begin() + min(n, w + sigma),
+                    [&](int a, int b) { return length(a) > length(b); });
+    }
+
+    int chunks = (n + C - 1) / C;
+    sell.chunk_ptr.resize(chunks + 1);
+    sell.chunk_len.resize(chunks);
+    sell.chunk_ptr[0] = 0;
+    for(int c = 0; c < chunks; c++){
+        long longest = 0;
+        for(int r = c * C; r < min(n, (c + 1) * C); r++){
+            longest = max(longest, length(sell.permutation[r]));
+        }
+        sell.chunk_len[c] = longest;
+        sell.chunk_ptr[c + 1] = sell.chunk_ptr[c] + longest * C;
+    }
+
+    sell.col_idx.assign(sell.chunk_ptr[chunks], 0);
+    sell.values.assign(sell.chunk_ptr[chunks], 0);
+    for(int c = 0; c < chunks; c++){
+        for(int lane = 0; lane < C && c * C + lane < n; lane++){
+            int i = sell.permutation[c * C + lane];
+            for(long k = 0; k < length(i); k++){
+                long position = sell.chunk_ptr[c] + k * C + lane;
+                sell.col_idx[position] = matrix.col_idx[matrix.row_ptr[i] + k];
+                sell.values[position] = matrix.values[matrix.row_ptr[i] + k];
+            }
+        }
+    }
+    return sell;
+}
+
+
+/*!
+ * The following function splits the work units in contiguous blocks with about the same cost, where the cost of
+ * the units in [0, u) is given by the non-decreasing function cost(u).
+ * @param units [int] := number of work units
+ * @param parts [int] := number of blocks
+ * @param cost [F] := cumulative cost of the first u units
+ * @return bounds [vector<int>] := the block t contains the work units in [bounds[t], bounds[t+1])
+ */
+template <typename F>
+static vector<int> balanced_split(int units, int parts, F cost){
+
+    vector<int> bounds(parts + 1);
+    double total = cost(units);
+    bounds[0] = 0;
+    bounds[parts] = units;
+    int u = 0;
+    for(int t = 1; t < parts; t++){
+        double target = total * t / parts;
+        while(u < units && cost(u) < target){
+            u++;
+        }
+        bounds[t] = u;
+    }
+    return bounds;
+}
+
+
+/*!
+ * The following function splits the rows of the matrix in contiguous blocks with about the same number of
+ * stored elements (plus one for each row, which accounts for the update of the variable).
+ * @param matrix [CSRMatrix] := sparse matrix
+ * @param parts [int] := number of blocks
+ * @return bounds [vector<int>] := the block t contains the rows in [bounds[t], bounds[t+1])
+ */
+vector<int> sparse_split(const CSRMatrix &matrix, int parts){
+    return balanced_split(matrix.n, parts, [&](int u) { return (double) matrix.row_ptr[u] + u; });
+}
+
+
+/*!
+ * The following function splits the chunks of the matrix in contiguous blocks with about the same number of
+ * stored elements (plus C for each chunk, which accounts for the update of the variables).
+ * @param matrix [SellMatrix] := sparse matrix
+ * @param parts [int] := number of blocks
+ * @return bounds [vector<int>] := the block t contains the chunks in [bounds[t], bounds[t+1])
+ */
+vector<int> sparse_split(const SellMatrix &matrix, int parts){
+    return balanced_split(matrix.chunks(), parts, [&](int u) { return (double) matrix.chunk_ptr[u] + u * matrix.C; });
+}
+
+
+/*!
+ * The following function computes one sweep of the Jacobi's Algorithm on the rows in [first, last).
+ * @param matrix [CSRMatrix] := sparse matrix A of the linear system (Ax=b)
+ * @param first [int] := first row to compute
+ * @param last [int] := row after the last one to compute
+ * @param prev_variables [const float *] := solution computed at the previous iteration
+ * @param curr_variables [float *] := vector where the new values of the variables are stored
+ * @param knownTerm [const float *] := vector b of the linear system (Ax=b)
+ * @param inverse_diagonal [const float *] := reciprocals of the elements on the diagonal
+ * @param partial [ConvergencePartial *] := if not nullptr, the sums of the stopping criteria of the computed rows are
+ * added to it
+ */
+void sparse_sweep(const CSRMatrix &matrix, int first, int last, const float *prev_variables, float *curr_variables,
+                  const float *knownTerm, const float *inverse_diagonal, ConvergencePartial *partial){
+
+    const long *row_ptr = matrix.row_ptr.data();
+    const int *col_idx = matrix.col_idx.data();
+    const float *values = matrix.values.data();
+    double difference = 0;
+    double norm = 0;
+
+    for(int i = first; i < last; i++){
+        float sum = 0;
+        for(long k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            sum += values[k] * prev_variables[col_idx[k]];
+        }
+        float variable = (knownTerm[i] - sum) * inverse_diagonal[i];
+        float delta = variable - prev_variables[i];
+        difference += delta * delta;
+        norm += variable * variable;
+        curr_variables[i] = variable;
+    }
+    if(partial != nullptr){
+        partial->difference += difference;
+        partial->norm += norm;
+    }
+}
+
+
+/*!
+ * The following function computes one sweep of the Jacobi's Algorithm on the chunks in [first, last). When the
+ * number of rows of a chunk is known at compile time (FIXED_C > 0) the loop on the rows of the chunk is unrolled
+ * and vectorized by the compiler.
+ */
+template <int FIXED_C>
+static void sell_sweep(const SellMatrix &matrix, int first, int last, const float *prev_variables,
+                       float *curr_variables, const float *knownTerm, const float *inverse_diagonal,
+                       ConvergencePartial *partial){
+
+    const int C = FIXED_C > 0 ? FIXED_C : matrix.C;
+    const int n = matrix.n;
+    const int *col_idx = matrix.col_idx.data();
+    const float *values = matrix.values.data();
+    const int *permutation = matrix.permutation.data();
+    float sums[MAX_SELL_C];
+    double difference = 0;
+    double norm = 0;
+
+    for(int c = first; c < last; c++){
+        for(int lane = 0; lane < C; lane++){
+            sums[lane] = 0;
+        }
+        long offset = matrix.chunk_ptr[c];
+        for(int k = 0; k < matrix.chunk_len[c]; k++){ // the C rows of the chunk advance together
+            const float *v = values + offset + (long) k * C;
+            const int *col = col_idx + offset + (long) k * C;
+            for(int lane = 0; lane < C; lane++){
+                sums[lane] += v[lane] * prev_variables[col[lane]];
+            }
+        }
+        for(int lane = 0; lane < C && c * C + lane < n; lane++){
+            int i = permutation[c * C + lane];
+            float variable = (knownTerm[i] - sums[lane]) * inverse_diagonal[i];
+            float delta = variable - prev_variables[i];
+            difference += delta * delta;
+            norm += variable * variable;
+            curr_variables[i] = variable;
+        }
+    }
+    if(partial != nullptr){
+        partial->difference += difference;
+        partial->norm += norm;
+    }
+}
+
+
+/*!
+ * The following function computes one sweep of the Jacobi's Algorithm on the chunks in [first, last).
+ * @param matrix [SellMatrix] := sparse matrix A of the linear system (Ax=b)
+ * @param first [int] := first chunk to compute
+ * @param last [int] := chunk after the last one to compute
+ * @param prev_variables [const float *] := solution computed at the previous iteration
+ * @param curr_variables [float *] := vector where the new values of the variables are stored
+ * @param knownTerm [const float *] := vector b of the linear system (Ax=b)
+ * @param inverse_diagonal [const float *] := reciprocals of the elements on the diagonal
+ * @param partial [ConvergencePartial *] := if not nullptr, the sums of the stopping criteria of the computed rows are
+ * added to it
+ */
+void sparse_sweep(const SellMatrix &matrix, int first, int last, const float *prev_variables, float *curr_variables,
+                  const float *knownTerm, const float *inverse_diagonal, ConvergencePartial *partial){
+
+    switch(matrix.C){
+        case 4:
+            sell_sweep<4>(matrix, first, last, prev_variables, curr_variables, knownTerm, inverse_diagonal, partial);
+            break;
+        case 8:
+            sell_sweep<8>(matrix, first, last, prev_variables, curr_variables, knownTerm, inverse_diagonal, partial);
+            break;
+        case 16:
+            sell_sweep<16>(matrix, first, last, prev_variables, curr_variables, knownTerm, inverse_diagonal, partial);
+            break;
+        default:
+            sell_sweep<0>(matrix, first, last, prev_variables, curr_variables, knownTerm, inverse_diagonal, partial);
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <vector>
+using namespace std;
+
+struct ConvergencePartial;
+class ThreadPool;
+
+
+/*!
+ * The following structure stores a sparse square matrix in the Compressed Sparse Row format. Since the Jacobi's
+ * Algorithm splits the matrix in its diagonal and in the remaining elements, the diagonal is stored apart and the rows
+ * contain only the off-diagonal non-zero elements.
+ */
+struct CSRMatrix {
+    int n = 0; // dimension of the matrix
+    vector<float> diagonal; // elements on the diagonal
+    vector<long> row_ptr; // the off-diagonal elements of the row i are in [row_ptr[i], row_ptr[i+1])
+    vector<int> col_idx; // column of each off-diagonal element
+    vector<float> values; // value of each off-diagonal element
+};
+
+
+/*!
+ * The following structure stores a sparse square matrix in the SELL-C-sigma format: the rows are sorted by length
+ * inside windows of sigma rows, grouped in chunks of C rows and each chunk is stored column by column, padded to the
+ * length of its longest row. In this way the C rows of a chunk are computed together with SIMD instructions. As in
+ * CSRMatrix, the diagonal is stored apart.
+ */
+struct SellMatrix {
+    int n = 0; // dimension of the matrix
+    int C = 0; // number of rows of each chunk
+    int sigma = 0; // number of rows of each sorting window
+    vector<float> diagonal; // elements on the diagonal (in the original order of the rows)
+    vector<int> permutation; // original index of the row stored in the position r
+    vector<long> chunk_ptr; // the elements of the chunk c start at chunk_ptr[c]
+    vector<int> chunk_len; // length of the longest row of each chunk
+    vector<int> col_idx; // column of each element (the padding points to column 0 with value 0)
+    vector<float> values; // value of each element (0 for the padding)
+
+    /*!
+     * @return chunks [int] := number of chunks of the matrix
+     */
+    int chunks() const { return chunk_len.size(); }
+};
+
+
+/*!
+ * The following function allows the generation of a sparse diagonal dominant matrix with the following parameters:
+ * @param n [int] := dimension of the matrix
+ * @param nonzeros_per_row [int] := average number of off-diagonal non-zero elements of each row (the length of each
+ * row is random in [1, 2 * nonzeros_per_row - 1], so the rows have different lengths)
+ * @param min_matrix [float] := minimum value of the matrix
+ * @param max_matrix [float] := maximum value of the matrix
+ * @param seed [int] := seed to generate the random values
+ * @param pool [ThreadPool] := pool of at least num_threads workers
+ * @param num_threads [int] := number of workers that generate the rows
+ * @return matrix [CSRMatrix] := matrix of dimension n with off-diagonal values in the range [min_matrix, max_matrix]
+ * and with the elements on the diagonal computed as the sum of the elements of the corresponding row multiplied by 2.
+ */
+CSRMatrix generate_sparse_matrix(int n, int nonzeros_per_row, float min_matrix, float max_matrix, int seed,
+                                 ThreadPool &pool, int num_threads);
+
+
+/*!
+ * The following function converts a matrix from the CSR format to the SELL-C-sigma format.
+ * @param matrix [CSRMatrix] := matrix to convert
+ * @param C [int] := number of rows of each chunk
+ * @param sigma [int] := number of rows of each sorting window (a multiple of C)
+ * @return matrix [SellMatrix] := converted matrix
+ */
+SellMatrix csr_to_sell(const CSRMatrix &matrix, int C = 8, int sigma = 256);
+
+
+/*!
+ * @param matrix [CSRMatrix] := sparse matrix
+ * @return units [int] := number of rows, which are the work units of the sparse sweeps on a CSR matrix
+ */
+inline int sparse_units(const CSRMatrix &matrix){ return matrix.n; }
+
+
+/*!
+ * @param matrix [SellMatrix] := sparse matrix
+ * @return units [int] := number of chunks, which are the work units of the sparse sweeps on a SELL-C-sigma matrix
+ */
+inline int sparse_units(const SellMatrix &matrix){ return matrix.chunks(); }
+
+
+/*!
+ * The following function splits the work units of the matrix in contiguous blocks with about the same number of
+ * stored elements, so that the workers receive the same amount of work even if the rows have different lengths.
+ * @param matrix [CSRMatrix or SellMatrix] := sparse matrix
+ * @param parts [int] := number of blocks
+ * @return bounds [vector<int>] := the block t contains the work units in [bounds[t], bounds[t+1])
+ */
+vector<int> sparse_split(const CSRMatrix &matrix, int parts);
+vector<int> sparse_split(const SellMatrix &matrix, int parts);
+
+
+/*!
+ * The following function computes one sweep of the Jacobi's Algorithm on the work units in [first, last).
+ * @param matrix [CSRMatrix or SellMatrix] := sparse matrix A of the linear system (Ax=b)
+ * @param first [int] := first work unit to compute
+ * @param last [int] := work unit after the last one to compute
+ * @param prev_variables [const float *] := solution computed at the previous iteration
+ * @param curr_variables [float *] := vector where the new values of the variables are stored
+ * @param knownTerm [const float *] := vector b of the linear system (Ax=b)
+ * @param inverse_diagonal [const float *] := reciprocals of the elements on the diagonal
+ * @param partial [ConvergencePartial *] := if not nullptr, the sums of the stopping criteria of the computed rows are
+ * added to it
+ */
+void sparse_sweep(const CSRMatrix &matrix, int first, int last, const float *prev_variables, float *curr_variables,
+                  const float *knownTerm, const float *inverse_diagonal, ConvergencePartial *partial);
+void sparse_sweep(const SellMatrix &matrix, int first, int last, const float *prev_variables, float *curr_variables,
+                  const float *knownTerm, const float *inverse_diagonal, ConvergencePartial *partial);
@@ -0,0 +1,168 @@
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include "thread_pool.h"
+#include "placement.h"
+using namespace std;
+
+
+/*!
+ * The following constructor starts the workers of the pool.
+ * @param num_threads [int] := number of workers of the pool
+ * @param cpus [vector<int>] := core on which each worker is pinned, if empty the workers are not pinned
+ */
+ThreadPool::ThreadPool(int num_threads, const vector<int> &cpus) : cpus(cpus) {
+
+    if(num_threads < 1){
+        throw invalid_argument("The number of threads of the pool must be >= 1");
+    }
+    if(!cpus.empty()){
+        if((int) cpus.size() < num_threads){
+            throw invalid_argument("A core must be given for each thread of the pool");
+        }
+        Topology topology = detect_topology();
+        for(int cpu : cpus){
+            bool known = cpu >= 0 && cpu < (int) topology.cpu_node.size() && topology.cpu_node[cpu] >= 0;
+            nodes.push_back(known ? topology.cpu_node[cpu] : 0);
+        }
+    }
+    worker_events.resize(num_threads);
+    workers.reserve(num_threads);
+    for(int i = 0; i < num_threads; i++){
+        workers.emplace_back(&ThreadPool::worker, this, i);
+    }
+}
+
+
+/*!
+ * The destructor shuts the pool down.
+ */
+ThreadPool::~ThreadPool(){
+    shutdown();
+}
+
+
+/*!
+ * The following function wakes up the workers, waits for them to finish and joins them. It is called by the
+ * destructor, it can be called explicitly to release the threads earlier.
+ */
+void ThreadPool::shutdown(){
+
+    {
+        unique_lock<mutex> guard(lock);
+        stopping = true;
+    }
+    start.notify_all();
+    for(thread &w : workers){
+        if(w.joinable()){
+            w.join();
+        }
+    }
+    workers.clear();
+}
+
+
+/*!
+ * The following function is the loop executed by each worker: it parks until a new body is dispatched, executes it
+ * if the worker is one of the first num_threads and notifies the dispatcher when the last worker has finished.
+ * @param tid [int] := index of the worker
+ */
+void ThreadPool::worker(int tid){
+
+    if(!cpus.empty() && !pin_current_thread(cpus[tid])){
+        cerr << "Could not pin the thread " << tid << " to the cpu " << cpus[tid] << endl;
+    }
+    long seen = 0;
+    unique_lock<mutex> guard(lock);
+    while(true){
+        start.wait(guard, [&]{ return stopping || generation != seen; });
+        if(stopping){
+            return;
+        }
+        seen = generation;
+        if(tid >= active){ // the worker is not needed by this body
+            continue;
+        }
+        void (*body)(void *, int) = task;
+        void *data = task_data;
+        bool count = counting;
+        guard.unlock();
+        PerfSample before = count ? thread_events() : PerfSample();
+        body(data, tid);
+        if(count){ // each worker writes only its own slot, which is read by take_events() after the body
+            worker_events[tid] += thread_events() - before;
+        }
+        guard.lock();
+        if(--pending == 0){
+            done.notify_one();
+        }
+    }
+}
+
+
+/*!
+ * The following function dispatches a type-erased body to the first num_threads workers and waits for them.
+ * @param num_threads [int] := number of workers that execute the body
+ * @param body [void (*)(void *, int)] := function called with data and the index of the worker
+ * @param data [void *] := pointer passed to the body
+ */
+void ThreadPool::dispatch(int num_threads, void (*body)(void *, int), void *data){
+
+    if(num_threads < 1 || num_threads > size()){
+        throw invalid_argument("The number of threads must be >= 1 and <= the size of the pool");
+    }
+    unique_lock<mutex> guard(lock);
+    task = body;
+    task_data = data;
+    active = num_threads;
+    pending = num_threads;
+    generation++;
+    start.notify_all();
+    done.wait(guard, [&]{ return pending == 0; });
+}
+
+
+/*!
+ * The following function tells how many NUMA nodes are spanned by the first num_threads workers.
+ * @param num_threads [int] := number of workers to consider
+ * @return nodes [int] := 1 if the workers are not pinned or they are all on the same node, otherwise the highest
+ * node of the workers plus one (so that the nodes can be used as indices)
+ */
+int ThreadPool::numa_nodes(int num_threads) const {
+
+    if(nodes.empty()){
+        return 1;
+    }
+    int lowest = *min_element(nodes.begin(), nodes.begin() + num_threads);
+    int highest = *max_element(nodes.begin(), nodes.begin() + num_threads);
+    return lowest == highest ? 1 : highest + 1;
+}
+
+
+/*!
+ * The following function enables or disables the counting of the hardware events of the workers. The counters of
+ * each worker are opened by the first body it executes with the counting enabled and then kept open.
+ * @param enabled [bool] := true if the events of the bodies must be counted
+ */
+void ThreadPool::count_events(bool enabled){
+
+    unique_lock<mutex> guard(lock);
+    counting = enabled;
+}
+
+
+/*!
+ * The following function returns the hardware events counted by all the workers and clears them. It must not be
+ * called while a body is running.
+ * @return events [PerfSample] := events of the bodies executed since the last call
+ */
+PerfSample ThreadPool::take_events(){
+
+    unique_lock<mutex> guard(lock);
+    PerfSample events;
+    for(PerfSample &worker : worker_events){
+        events += worker;
+        worker = PerfSample();
+    }
+    return events;
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "perf_counters.h"
+using namespace std;
+
+
+/*!
+ * The following class is a pool of long-lived workers. The workers are created once by the constructor and then they
+ * are parked on a condition variable until a body is dispatched with run(), so successive solves reuse the same warm
+ * threads without paying their creation. The workers are joined by shutdown() or by the destructor. Optionally, each
+ * worker is pinned to a core when it starts.
+ */
+class ThreadPool {
+
+private:
+    vector<thread> workers;
+    vector<int> cpus; // core of each worker, empty if the workers are not pinned
+    vector<int> nodes; // NUMA node of each worker, empty if the workers are not pinned
+    mutex lock;
+    condition_variable start; // signalled when a new body is dispatched or the pool is shut down
+    condition_variable done; // signalled when the last worker of a body has finished
+    void (*task)(void *, int) = nullptr; // body dispatched to the workers (type-erased, so no allocation is needed)
+    void *task_data = nullptr;
+    long generation = 0; // incremented each time a body is dispatched
+    int active = 0; // number of workers executing the current body
+    int pending = 0; // number of workers that have not finished the current body yet
+    bool stopping = false;
+    bool counting = false; // if true each worker counts the hardware events of the bodies it executes
+    vector<PerfSample> worker_events; // events counted by each worker since the last take_events()
+
+    void worker(int tid);
+    void dispatch(int num_threads, void (*body)(void *, int), void *data);
+
+public:
+
+    /*!
+     * The following constructor starts the workers of the pool.
+     * @param num_threads [int] := number of workers of the pool
+     * @param cpus [vector<int>] := core on which each worker is pinned, if empty the workers are not pinned
+     */
+    explicit ThreadPool(int num_threads, const vector<int> &cpus = {});
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /*!
+     * The destructor shuts the pool down.
+     */
+    ~ThreadPool();
+
+    /*!
+     * The following function wakes up the workers, waits for them to finish and joins them. It is called by the
+     * destructor, it can be called explicitly to release the threads earlier.
+     */
+    void shutdown();
+
+    /*!
+     * @return size [int] := number of workers of the pool
+     */
+    int size() const { return workers.size(); }
+
+    /*!
+     * @param tid [int] := index of the worker
+     * @return cpu [int] := core on which the worker is pinned, -1 if it is not pinned
+     */
+    int cpu(int tid) const { return cpus.empty() ? -1 : cpus[tid]; }
+
+    /*!
+     * @param tid [int] := index of the worker
+     * @return node [int] := NUMA node of the core of the worker, 0 if it is not pinned
+     */
+    int node(int tid) const { return nodes.empty() ? 0 : nodes[tid]; }
+
+    /*!
+     * The following function tells how many NUMA nodes are spanned by the first num_threads workers.
+     * @param num_threads [int] := number of workers to consider
+     * @return nodes [int] := 1 if the workers are not pinned or they are all on the same node, otherwise the highest
+     * node of the workers plus one (so that the nodes can be used as indices)
+     */
+    int numa_nodes(int num_threads) const;
+
+    /*!
+     * The following function enables or disables the counting of the hardware events of the workers. The counters of
+     * each worker are opened by the first body it executes with the counting enabled and then kept open.
+     * @param enabled [bool] := true if the events of the bodies must be counted
+     */
+    void count_events(bool enabled);
+
+    /*!
+     * The following function returns the hardware events counted by all the workers and clears them. It must not be
+     * called while a body is running.
+     * @return events [PerfSample] := events of the bodies executed since the last call
+     */
+    PerfSample take_events();
+
+    /*!
+     * The following function executes body(tid) on the workers with tid in [0, num_threads) and returns when all of
+     * them have finished.
+     * @param num_threads [int] := number of workers that execute the body, it must be <= size()
+     * @param body [F] := function (or lambda) called with the index of the worker
+     */
+    template <typename F>
+    void run(int num_threads, F &body){
+        dispatch(num_threads, [](void *data, int tid){ (*static_cast<F *>(data))(tid); }, &body);
+    }
+};
@@ -0,0 +1,135 @@
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <unistd.h>
+#include "tiling.h"
+using namespace std;
+
+
+/*!
+ * The following function parses a cache size written by the kernel in sysfs (e.g. "48K" or "2048K").
+ * @param text [string] := size read from the file
+ * @return bytes [long] := size in bytes, 0 if the text is not valid
+ */
+static long parse_cache_size(const string &text){
+
+    size_t end = 0;
+    long size;
+    try{
+        size = stol(text, &end);
+    }
+    catch(const exception &){
+        return 0;
+    }
+    if(end < text.size() && text[end] == 'K'){
+        size *= 1024;
+    }
+    else if(end < text.size() && text[end] == 'M'){
+        size *= 1024 * 1024;
+    }
+    return size;
+}
+
+
+/*!
+ * The following function reads the sizes of the data caches from /sys/devices/system/cpu/cpu0/cache, or from sysconf
+ * if they are not available there. The sizes that cannot be detected are set to 32KB (L1), 1MB (L2) and 0 (L3).
+ * @return sizes [CacheSizes] := sizes of the caches
+ */
+CacheSizes detect_caches(){
+
+    CacheSizes caches;
+    for(int index = 0; index < 8; index++){
+        string directory = "/sys/devices/system/cpu/cpu0/cache/index" + to_string(index) + "/";
+        ifstream level_file(directory + "level");
+        ifstream type_file(directory + "type");
+        ifstream size_file(directory + "size");
+        int level;
+        string type, size;
+        if(!(level_file >> level) || !(type_file >> type) || !(size_file >> size) || type == "Instruction"){
+            continue;
+        }
+        long bytes = parse_cache_size(size);
+        if(level == 1){
+            caches.l1 = bytes;
+        }
+        else if(level == 2){
+            caches.l2 = bytes;
+        }
+        else if(level == 3){
+            caches.l3 = bytes;
+        }
+    }
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    if(caches.l1 <= 0){
+        caches.l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    }
+    if(caches.l2 <= 0){
+        caches.l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    }
+    if(caches.l3 <= 0){
+        caches.l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    }
+#endif
+    caches.l1 = caches.l1 > 0 ? caches.l1 : 32 * 1024;
+    caches.l2 = caches.l2 > 0 ? caches.l2 : 1024 * 1024;
+    caches.l3 = max(caches.l3, 0L);
+    return caches;
+}
+
+
+/*!
+ * The following function chooses the tiles from the cache hierarchy: a tile of the variables fills half of the L1
+ * cache and the rows of a block fill half of the L2 cache with their segments of a tile.
+ * @param n [int] := dimension of the linear system
+ * @param caches [CacheSizes] := sizes of the caches
+ * @return tiling [Tiling] := tiles of the sweep, not tiled if all the variables already fit in the tile
+ */
+Tiling auto_tiling(int n, const CacheSizes &caches){
+
+    int line = CACHE_LINE / sizeof(float);
+    Tiling tiling;
+    tiling.columns = max((int) (caches.l1 / 2 / sizeof(float)) / line * line, line);
+    if(tiling.columns >= n){ // the variables stay in L1 anyway, the blocks would only add overhead
+        return Tiling();
+    }
+    tiling.rows = (int) clamp(caches.l2 / 2 / ((long) tiling.columns * (long) sizeof(float)), 1L,
+                              (long) MAX_TILE_ROWS);
+    return tiling;
+}
+
+
+/*!
+ * The following function parses a tiling given on the command line.
+ * @param text [string] := "auto", "off" or "[ROWS]x[COLUMNS]" (e.g. 16x4096)
+ * @param n [int] := dimension of the linear system, used by "auto"
+ * @return tiling [Tiling] := parsed tiling
+ * @throw invalid_argument if the text is not a valid tiling
+ */
+Tiling parse_tiling(const string &text, int n){
+
+    if(text == "auto"){
+        return auto_tiling(n, detect_caches());
+    }
+    if(text == "off"){
+        return Tiling();
+    }
+    size_t separator = text.find('x');
+    Tiling tiling;
+    try{
+        if(separator == string::npos){
+            throw invalid_argument(text);
+        }
+        tiling.rows = stoi(text.substr(0, separator));
+        tiling.columns = stoi(text.substr(separator + 1));
+    }
+    catch(const exception &){
+        throw invalid_argument("The tiling '" + text + "' is not valid");
+    }
+    if(tiling.rows < 1 || tiling.rows > MAX_TILE_ROWS || tiling.columns < 1){
+        throw invalid_argument("The tiling '" + text + "' is not valid: the rows must be in [1, " +
+                               to_string(MAX_TILE_ROWS) + "] and the columns >= 1");
+    }
+    return tiling;
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "matrix.h"
+#include "precision.h"
+#include "jacobi_workspace.h"
+#include "convergence.h"
+using namespace std;
+
+
+#define MAX_TILE_ROWS 64 // maximum number of rows of a block of the tiled sweep
+
+
+/*!
+ * The following structure describes the tiles of the cache-blocked sweep: the rows are computed in blocks of rows
+ * consecutive rows, and each block walks the variables in tiles of columns elements, so that a tile of the variables is
+ * loaded in cache once and reused by all the rows of the block. With columns = 0 the sweep is not tiled.
+ */
+struct Tiling {
+    int rows = 0; // number of rows of each block
+    int columns = 0; // number of variables of each tile, 0 if the sweep is not tiled
+};
+
+
+/*!
+ * The following structure stores the sizes of the data caches of the first core.
+ */
+struct CacheSizes {
+    long l1 = 0; // bytes of the L1 data cache
+    long l2 = 0; // bytes of the L2 cache
+    long l3 = 0; // bytes of the L3 cache
+};
+
+
+/*!
+ * The following function reads the sizes of the data caches from /sys/devices/system/cpu/cpu0/cache, or from sysconf
+ * if they are not available there. The sizes that cannot be detected are set to 32KB (L1), 1MB (L2) and 0 (L3).
+ * @return sizes [CacheSizes] := sizes of the caches
+ */
+CacheSizes detect_caches();
+
+
+/*!
+ * The following function chooses the tiles from the cache hierarchy: a tile of the variables fills half of the L1
+ * cache and the rows of a block fill half of the L2 cache with their segments of a tile.
+ * @param n [int] := dimension of the linear system
+ * @param caches [CacheSizes] := sizes of the caches
+ * @return tiling [Tiling] := tiles of the sweep, not tiled if all the variables already fit in the tile
+ */
+Tiling auto_tiling(int n, const CacheSizes &caches);
+
+
+/*!
+ * The following function parses a tiling given on the command line.
+ * @param text [string] := "auto", "off" or "[ROWS]x[COLUMNS]" (e.g. 16x4096)
+ * @param n [int] := dimension of the linear system, used by "auto"
+ * @return tiling [Tiling] := parsed tiling
+ * @throw invalid_argument if the text is not a valid tiling
+ */
+Tiling parse_tiling(const string &text, int n);
+
+
+/*!
+ * The following function computes the rows in [first, last) of one sweep of the Jacobi's Algorithm with the cache
+ * blocking described by the tiling, and accumulates the stopping criteria of these rows. The diagonal element is
+ * skipped by splitting the tile that contains it.
+ * @param matrix [Matrix or PrecisionMatrix] := matrix A of the linear system (Ax=b)
+ * @param first [int] := first row to compute
+ * @param last [int] := row after the last one to compute
+ * @param variables [const float *] := solution computed at the previous iteration
+ * @param curr_variables [float *] := vector where the new values of the rows are stored
+ * @param knownTerm [const float *] := vector b of the linear system (Ax=b)
+ * @param inverse_diagonal [const float *] := reciprocals of the elements on the diagonal
+ * @param tiling [Tiling] := tiles of the sweep, with columns > 0 and rows in [1, MAX_TILE_ROWS]
+ * @param partial [ConvergencePartial] := partial sums of the stopping criteria, updated
+ * @param criterion [StoppingCriterion] := stopping criteria accumulated in the partial sums, the increment by default
+ */
+template <typename DenseMatrix>
+inline void tiled_sweep(const DenseMatrix &matrix, int first, int last, const float *variables,
+                        float *curr_variables, const float *knownTerm, const float *inverse_diagonal,
+                        const Tiling &tiling, ConvergencePartial &partial,
+                        StoppingCriterion criterion = StoppingCriterion::INCREMENT){
+
+    int n = matrix.size();
+    double sums[MAX_TILE_ROWS];
+    ConvergencePartial rows;
+    for(int block = first; block < last; block += tiling.rows){
+        int block_end = min(block + tiling.rows, last);
+        fill(sums, sums + (block_end - block), 0.0);
+        for(int j0 = 0; j0 < n; j0 += tiling.columns){
+            int j1 = min(j0 + tiling.columns, n);
+            for(int i = block; i < block_end; i++){
+                if(i < j0 || i >= j1){
+                    sums[i - block] += range_dot(matrix, i, j0, j1 - j0, variables);
+                }
+                else{
+                    sums[i - block] += range_dot(matrix, i, j0, i - j0, variables) +
+                                       range_dot(matrix, i, i + 1, j1 - i - 1, variables);
+                }
+            }
+        }
+        for(int i = block; i < block_end; i++){
+            float variable = (float) ((knownTerm[i] - sums[i - block]) * inverse_diagonal[i]);
+            accumulate_row(rows, criterion, variable, variables[i], knownTerm[i], inverse_diagonal[i]);
+            curr_variables[i] = variable;
+        }
+    }
+    merge_partial(partial, rows, criterion);
+}
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <algorithm>
+#include <stdexcept>
+#include "trace.h"
+using namespace std;
+
+
+/*!
+ * The following function clears the trace and starts a new one. It must be called by the engine before its
+ * workers start.
+ * @param engine_name [string] := name of the engine
+ * @param num_threads [int] := number of workers of the engine
+ */
+void Tracer::start(const string &engine_name, int num_threads){
+
+    engine = engine_name;
+    if((int) tracks.size() != num_threads + 1){
+        tracks = vector<Track>(num_threads + 1);
+    }
+    for(Track &track : tracks){ // the buffers are allocated once, so the workers never allocate while recording
+        track.events.resize(TRACE_CAPACITY);
+        track.written.store(0, memory_order_relaxed);
+    }
+    origin = chrono::steady_clock::now();
+}
+
+
+/*!
+ * @param track [int] := index of the worker, or the number of workers for the serial part
+ * @return events [vector<TraceEvent>] := events kept by the track, from the oldest one
+ */
+vector<TraceEvent> Tracer::events(int track) const {
+
+    const Track &owner = tracks[track];
+    long written = owner.written.load(memory_order_acquire);
+    vector<TraceEvent> kept;
+    for(long e = max(0L, written - TRACE_CAPACITY); e < written; e++){
+        kept.push_back(owner.events[e & (TRACE_CAPACITY - 1)]);
+    }
+    return kept;
+}
+
+
+/*!
+ * @param phase [TracePhase] := phase of an event
+ * @return name [string] := name of the phase
+ */
+static string phase_name(TracePhase phase){
+
+    switch(phase){
+        case TracePhase::COMPUTE:
+            return "compute";
+        case TracePhase::BARRIER:
+            return "barrier";
+        case TracePhase::COMPLETION:
+            return "completion";
+    }
+    return "";
+}
+
+
+/*!
+ * The following function writes the trace in the JSON format of the Chrome tracing (chrome://tracing, Perfetto).
+ * @param filename [string] := file to write
+ * @throw runtime_error if the file cannot be written
+ */
+void Tracer::write_chrome(const string &filename) const {
+
+    ofstream output_file(filename, ios::trunc);
+    if(!output_file.is_open()){
+        throw runtime_error("Could not open the file '" + filename + "'");
+    }
+    output_file << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+    output_file << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"" << engine <<
+                "\"}}";
+    output_file.precision(3);
+    output_file << fixed;
+    for(int t = 0; t <= threads(); t++){
+        string name = t < threads() ? "worker " + to_string(t) : "serial";
+        output_file << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << t <<
+                    ", \"args\": {\"name\": \"" << name << "\"}}";
+        for(const TraceEvent &event : events(t)){ // the complete events (X) have their duration, in usec
+            output_file << ",\n  {\"name\": \"" << phase_name(event.phase) << "\", \"ph\": \"X\", \"pid\": 1, "
+                        "\"tid\": " << t << ", \"ts\": " << event.begin / 1e3 << ", \"dur\": " <<
+                        (event.end - event.begin) / 1e3 << ", \"args\": {\"iteration\": " << event.iteration << "}}";
+        }
+    }
+    output_file << "\n]}\n";
+    if(!output_file){
+        throw runtime_error("Could not write the file '" + filename + "'");
+    }
+}
+
+
+/*!
+ * The following function prints, for each worker, the time spent computing and waiting, and the imbalance of the
+ * iterations: how much the slowest worker computed more than the average one.
+ */
+void Tracer::print_summary() const {
+
+    int workers = threads();
+    if(workers == 0){
+        return;
+    }
+    // compute time of each worker in each iteration, the chunks of FastFlow are summed
+    map<int, vector<long>> compute;
+    long dropped = 0;
+    for(int t = 0; t <= workers; t++){
+        long written = tracks[t].written.load(memory_order_acquire);
+        dropped += max(0L, written - TRACE_CAPACITY);
+        long busy = 0;
+        long waiting = 0;
+        bool barriers = false; // the workers of FastFlow record only their chunks
+        for(const TraceEvent &event : events(t)){
+            long duration = event.end - event.begin;
+            if(event.phase == TracePhase::COMPUTE){
+                vector<long> &iteration = compute[event.iteration];
+                iteration.resize(workers, 0);
+                iteration[t] += duration;
+                busy += duration;
+            }
+            else{
+                waiting += duration;
+                barriers = barriers || event.phase == TracePhase::BARRIER;
+            }
+        }
+        if(t < workers){
+            cout << "TRACE WORKER " << t << ": compute " << busy / 1000 << " usec";
+            if(barriers){
+                cout << ", barrier " << waiting / 1000 << " usec";
+            }
+            cout << endl;
+        }
+        else{
+            cout << "TRACE SERIAL: " << waiting / 1000 << " usec" << endl;
+        }
+    }
+    double total = 0;
+    double worst = 0;
+    int worst_iteration = -1;
+    for(auto &[iteration, times] : compute){
+        long slowest = *max_element(times.begin(), times.end());
+        double mean = 0;
+        for(long time : times){
+            mean += time;
+        }
+        mean /= workers;
+        double imbalance = mean > 0 ? slowest / mean - 1 : 0;
+        total += imbalance;
+        if(imbalance > worst){
+            worst = imbalance;
+            worst_iteration = iteration;
+        }
+    }
+    if(!compute.empty()){
+        cout << "TRACE IMBALANCE: " << 100 * total / compute.size() << "% on average over " << compute.size() <<
+             " iterations (slowest worker over the mean), worst " << 100 * worst << "% at iteration " <<
+             worst_iteration << endl;
+    }
+    if(dropped > 0){
+        cout << "TRACE: " << dropped << " events overwritten, only the last " << TRACE_CAPACITY << " of each worker "
+             "are kept" << endl;
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "matrix.h"
+using namespace std;
+
+
+#define TRACE_CAPACITY 65536 // events kept by each track (a power of 2), the oldest ones are overwritten
+
+
+/*!
+ * The following enumeration lists the phases of an iteration recorded by the tracer.
+ */
+enum class TracePhase : uint8_t {
+    COMPUTE, // a worker computes its rows (a chunk of them with FastFlow)
+    BARRIER, // a worker waits at the barrier for the others, including the completion function
+    COMPLETION // the serial part of the iteration: the stopping criteria is combined and the variables are swapped
+};
+
+
+/*!
+ * The following structure stores a single event of the trace.
+ */
+struct TraceEvent {
+    long begin = 0; // nsec since the start of the trace
+    long end = 0; // nsec since the start of the trace
+    int iteration = 0;
+    TracePhase phase = TracePhase::COMPUTE;
+};
+
+
+/*!
+ * The following class records the timeline of the workers of a parallel engine. Each worker writes its events in its
+ * own ring buffer (track), so recording takes no lock and no atomic read-modify-write: only the owner of a track
+ * writes it, and the tracks are read after the solve, once the workers have been joined by the barrier or by the
+ * pool. The serial part of each iteration has a track of its own after the ones of the workers. The engines receive
+ * a null tracer when the tracing is disabled, so the only cost is a comparison for each iteration.
+ */
+class Tracer {
+
+private:
+    struct alignas(CACHE_LINE) Track {
+        vector<TraceEvent> events; // ring buffer of TRACE_CAPACITY events
+        atomic<long> written{0}; // events recorded since the start, the last TRACE_CAPACITY are kept
+    };
+
+    vector<Track> tracks; // one for each worker, plus the serial one
+    chrono::steady_clock::time_point origin;
+    string engine; // name of the engine that recorded the trace
+
+public:
+
+    /*!
+     * The following function clears the trace and starts a new one. It must be called by the engine before its
+     * workers start.
+     * @param engine_name [string] := name of the engine
+     * @param num_threads [int] := number of workers of the engine
+     */
+    void start(const string &engine_name, int num_threads);
+
+    /*!
+     * @return now [long] := nsec since the start of the trace
+     */
+    long now() const {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - origin).count();
+    }
+
+    /*!
+     * The following function records an event on a track, it must be called only by the owner of the track.
+     * @param track [int] := index of the worker, or the number of workers for the serial part
+     * @param phase [TracePhase] := phase of the event
+     * @param iteration [int] := iteration of the Jacobi's Algorithm
+     * @param begin [long] := nsec since the start of the trace at the beginning of the event
+     * @param end [long] := nsec since the start of the trace at the end of the event
+     */
+    void record(int track, TracePhase phase, int iteration, long begin, long end) noexcept {
+        Track &owner = tracks[track];
+        long written = owner.written.load(memory_order_relaxed);
+        TraceEvent &event = owner.events[written & (TRACE_CAPACITY - 1)];
+        event.begin = begin;
+        event.end = end;
+        event.iteration = iteration;
+        event.phase = phase;
+        owner.written.store(written + 1, memory_order_release);
+    }
+
+    /*!
+     * @return threads [int] := number of workers of the last trace
+     */
+    int threads() const { return tracks.empty() ? 0 : (int) tracks.size() - 1; }
+
+    /*!
+     * @param track [int] := index of the worker, or the number of workers for the serial part
+     * @return events [vector<TraceEvent>] := events kept by the track, from the oldest one
+     */
+    vector<TraceEvent> events(int track) const;
+
+    /*!
+     * The following function writes the trace in the JSON format of the Chrome tracing (chrome://tracing, Perfetto).
+     * @param filename [string] := file to write
+     * @throw runtime_error if the file cannot be written
+     */
+    void write_chrome(const string &filename) const;
+
+    /*!
+     * The following function prints, for each worker, the time spent computing and waiting, and the imbalance of the
+     * iterations: how much the slowest worker computed more than the average one.
+     */
+    void print_summary() const;
+};
@@ -5,6 +5,7 @@
 #include <numeric>
 #include <fstream>
 #include "utility.h"
+#include "generator.h"
 using namespace std;
 
 
@@ -14,27 +15,19 @@ using namespace std;
  * @param min_matrix [float] := minimum value of the matrix
  * @param max_matrix [float] := maximum value of the matrix
  * @param seed [int] := seed to generate the random values
- * @return matrix [vector<vector<float>>]:= matrix of dimension n with values in the range [min_matrix, max_matrix]
+ * @return matrix [Matrix]:= matrix of dimension n with values in the range [min_matrix, max_matrix]
  * except for the elements on the diagonal which are higher than the maximum value because they are computed as the
- * sum of the elements of  the corresponding row multiplied by 2.
+ * sum of the other elements of the corresponding row multiplied by 2.
  */
-vector<vector<float>> generate_matrix(int n, float min_matrix, float max_matrix, int seed){
-
-    int columns = n;
-    int rows = n;
-    float sum;
-    vector<vector<float>> matrix(rows, vector<float>(columns));
-
-    // srand((unsigned int)time(NULL)); it can be substituted with the seed in order to have each time different numbers
-    srand(seed);
-
-    for(int i=0; i < n; i++){
-        sum=0;
-        for(int j=0; j < n; j++){
-            matrix[i][j] = min_matrix + static_cast <float> (rand()) /( static_cast <float> (RAND_MAX/(max_matrix-min_matrix)));
-            sum += matrix[i][j];
-        }
-        matrix[i][i] = sum * 2; // it allows to have a diagonal dominant matrix
+Matrix generate_matrix(int n, float min_matrix, float max_matrix, int seed){
+
+    MatrixGenerator generator;
+    generator.min_value = min_matrix;
+    generator.max_value = max_matrix;
+    generator.seed = seed;
+    Matrix matrix = Matrix::uninitialized(n);
+    for(int i=0; i < n; i++){ // the elements come from a counter-based generator, so they do not depend on the order
+        generator.generate_row(n, i, matrix[i], matrix.row_stride());
     }
     return matrix;
 }
@@ -52,10 +45,9 @@ vector<float> generate_vector(int n, float min_vector, float max_vector, int see
 
     vector<float> vector(n);
 
-    // srand((unsigned int)time(NULL)); it can be substituted with the seed in order to have each time different numbers
-    srand(seed);
+    // the vector uses its own stream, so it is not the first row of a matrix generated with the same seed
     for(int i=0; i < n; i++){
-        vector[i] = min_vector + static_cast <float> (rand()) /( static_cast <float> (RAND_MAX/(max_vector-min_vector)));
+        vector[i] = min_vector + (max_vector - min_vector) * counter_uniform(seed, VECTOR_STREAM, i);
     }
     return vector;
 }
@@ -63,9 +55,9 @@ vector<float> generate_vector(int n, float min_vector, float max_vector, int see
 
 /*!
  * The following function prints all the elements of the matrix given as input.
- * @param matrix [vector<vector<float>>] := matrix to print
+ * @param matrix [Matrix] := matrix to print
  */
-void print_matrix(vector<vector<float>> matrix){
+void print_matrix(const Matrix &matrix){
 
     int n = matrix.size();
 
@@ -103,15 +95,17 @@ void print_vector(vector<float> vector){
  * @param previous [vector<float>] := solution vector computed at the previous iteration
  * @return epsilon [double] := the results that comes out computing  ||(current - previous)|| / ||current||.
  */
-long double stopping_criteria(vector<float> current, vector<float> previous){
+long double stopping_criteria(const vector<float> &current, const vector<float> &previous){
 
     int n = current.size();
     long double denominator = sqrt(inner_product(current.begin(), current.end(), current.begin(), 0.0L));
+    long double numerator = 0;
 
-    for(int i = 0; i < n; i++){
-        current[i] -= previous[i];
+    for(int i = 0; i < n; i++){ // the difference is accumulated on the fly to avoid copying the vectors
+        long double difference = (long double) current[i] - previous[i];
+        numerator += difference * difference;
     }
-    long double numerator = sqrt(inner_product(current.begin(), current.end(), current.begin(), 0.0L));
+    numerator = sqrt(numerator);
 
     return  numerator/denominator;
 }
@@ -144,28 +138,28 @@ float compute_euclidean_distance(vector<float> current, vector<float> previous){
  * The following functions reads a matrix from a file
  * @param n [int] := size of the matrix to read
  * @param filename [string] := filename where the matrix is stored
- * @return matrix [vector<vector<float>>] := matrix read from the file
+ * @return matrix [Matrix] := matrix read from the file
+ * @throw runtime_error if the file cannot be opened or it contains fewer numbers than expected
  */
-vector<vector<float>> read_matrix(int n, string filename){
+Matrix read_matrix(int n, string filename){
 
-    vector<vector<float>> matrix(n, vector<float>(n));
-    float number;
+    Matrix matrix(n);
 
     ifstream input_file;
     input_file.open(filename, std::ios::in);
 
     if (!input_file.is_open()) {
-        cerr << "Could not open the file - '"
-             << filename << "'" << endl;
-        return matrix;
+        throw runtime_error("Could not open the file '" + filename + "'");
     }
 
     for(int i = 0; i < n; i++){
         for(int j = 0; j < n; j++){
-            input_file >> matrix[i][j];
+            if(!(input_file >> matrix[i][j])){
+                throw runtime_error("The file '" + filename + "' does not contain " + to_string(n) + "x" +
+                                    to_string(n) + " numbers");
+            }
         }
     }
-    cout << endl;
     input_file.close();
 
     return matrix;
@@ -177,25 +171,24 @@ vector<vector<float>> read_matrix(int n, string filename){
  * @param n [int] := size of the vector to read
  * @param filename [string] := filename where the vector is stored
  * @return vector [vector<float>] := vector read from the file
+ * @throw runtime_error if the file cannot be opened or it contains fewer numbers than expected
  */
 vector<float> read_vector(int n, string filename){
 
     vector<float> vector(n);
-    float number;
 
     ifstream input_file;
     input_file.open(filename, std::ios::in);
 
     if (!input_file.is_open()) {
-        cerr << "Could not open the file - '"
-             << filename << "'" << endl;
-        exit(1);
+        throw runtime_error("Could not open the file '" + filename + "'");
     }
 
     for(int i = 0; i < n; i++){
-        input_file >> vector[i];
+        if(!(input_file >> vector[i])){
+            throw runtime_error("The file '" + filename + "' does not contain " + to_string(n) + " numbers");
+        }
     }
-    cout << endl;
     input_file.close();
 
     return vector;
@@ -1,4 +1,6 @@
 #include <vector>
+#include <string>
+#include "matrix.h"
 using namespace std;
 
 
@@ -8,11 +10,11 @@ using namespace std;
  * @param min_matrix [float] := minimum value of the matrix
  * @param max_matrix [float] := maximum value of the matrix
  * @param seed [int] := seed to generate the random values
- * @return matrix [vector<vector<float>>]:= matrix of dimension n with values in the range [min_matrix, max_matrix]
+ * @return matrix [Matrix]:= matrix of dimension n with values in the range [min_matrix, max_matrix]
  * except for the elements on the diagonal which are higher than the maximum value because they are computed as the
- * sum of the elements of  the corresponding row multiplied by 2.
+ * sum of the other elements of the corresponding row multiplied by 2.
  */
-vector<vector<float>> generate_matrix(int n,  float min_matrix, float max_matrix, int seed);
+Matrix generate_matrix(int n,  float min_matrix, float max_matrix, int seed);
 
 
 /*!
@@ -28,9 +30,9 @@ vector<float> generate_vector(int n, float min_vector, float max_vector, int see
 
 /*!
  * The following function prints all the elements of the matrix given as input.
- * @param matrix [vector<vector<float>>] := matrix to print
+ * @param matrix [Matrix] := matrix to print
  */
-void print_matrix(vector<vector<float>> matrix);
+void print_matrix(const Matrix &matrix);
 
 
 /*!
@@ -47,7 +49,7 @@ void print_vector(vector<float> vector);
  * @param previous [vector<float>] := solution vector computed at the previous iteration
  * @return epsilon [double] := the results that comes out computing  ||(current - previous)|| / ||current||.
  */
-long double stopping_criteria(vector<float> current, vector<float> previous);
+long double stopping_criteria(const vector<float> &current, const vector<float> &previous);
 
 
 /*!
@@ -63,9 +65,10 @@ float compute_euclidean_distance(vector<float> v1, vector<float> v2);
  * The following functions reads a matrix from a file
  * @param n [int] := size of the matrix to read
  * @param filename [string] := filename where the matrix is stored
- * @return matrix [vector<vector<float>>] := matrix read from the file
+ * @return matrix [Matrix] := matrix read from the file
+ * @throw runtime_error if the file cannot be opened or it contains fewer numbers than expected
  */
-vector<vector<float>> read_matrix(int n, string filename);
+Matrix read_matrix(int n, string filename);
 
 
 /*!
@@ -73,6 +76,7 @@ vector<vector<float>> read_matrix(int n, string filename);
  * @param n [int] := size of the vector to read
  * @param filename [string] := filename where the vector is stored
  * @return vector [vector<float>] := vector read from the file
+ * @throw runtime_error if the file cannot be opened or it contains fewer numbers than expected
  */
 vector<float> read_vector(int n, string filename);
 
@@ -4,42 +4,61 @@
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <memory>
+#include "perf_counters.h"
 
 
-#define START(timename) auto timename = std::chrono::system_clock::now();
-#define STOP(timename,elapsed)  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - timename).count();
+#define START(timename) auto timename = std::chrono::steady_clock::now();
+#define STOP(timename,elapsed)  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timename).count();
 
 
 class utimer {
-    std::chrono::system_clock::time_point start;
-    std::chrono::system_clock::time_point stop;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point stop;
     std::string message;
     using usecs = std::chrono::microseconds;
     using msecs = std::chrono::milliseconds;
 
 private:
     long * us_elapsed;
+    PerfSample * events; // hardware events of the scope, NULL if they are not counted
+    std::unique_ptr<PerfCounters> counters;
+    PerfSample begin;
 
 public:
 
-    utimer(const std::string m) : message(m),us_elapsed((long *)NULL) {
-        start = std::chrono::system_clock::now();
+    utimer(const std::string m) : message(m),us_elapsed((long *)NULL),events((PerfSample *)NULL) {
+        start = std::chrono::steady_clock::now();
     }
 
-    utimer(const std::string m, long * us) : message(m),us_elapsed(us) {
-        start = std::chrono::system_clock::now();
+    utimer(const std::string m, long * us) : message(m),us_elapsed(us),events((PerfSample *)NULL) {
+        start = std::chrono::steady_clock::now();
+    }
+
+    // the scope also counts the hardware events of the calling thread and of the threads created and joined inside
+    // the scope (see PerfCounters), they are stored in *e and printed after the time; a NULL e is the plain timer
+    utimer(const std::string m, long * us, PerfSample * e) : message(m),us_elapsed(us),events(e) {
+        if(events != NULL) {
+            counters = std::make_unique<PerfCounters>(true);
+            begin = counters->read();
+        }
+        start = std::chrono::steady_clock::now();
     }
 
     ~utimer() {
         stop =
-                std::chrono::system_clock::now();
+                std::chrono::steady_clock::now();
         std::chrono::duration<double> elapsed =
                 stop - start;
         auto musec =
                 std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
 
+        if(events != NULL)
+            (*events) = counters->read() - begin;
         std::cout << message << " computed in " << musec << " usec " << std::endl;
+        if(events != NULL)
+            std::cout << "\t" << events->describe() << std::endl;
         if(us_elapsed != NULL)
             (*us_elapsed) = musec;
     }
-};
\ No newline at end of file
+};
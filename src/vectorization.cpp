@@ -1,8 +1,10 @@
 #include <iostream>
 #include <vector>
-#include <fstream>
-#include "jacobi_sequential.h"
+#include <string>
+#include <cmath>
 #include "utility.h"
+#include "row_kernel.h"
+#include "utimer.cpp"
 
 using namespace std;
 
@@ -13,22 +15,110 @@ using namespace std;
 #define MAX_VECTOR 20
 #define SEED 14
 
-int main(){
 
-    int size = 5000;
-    int iterations = 100;
+/*!
+ * The following function computes one sweep of the Jacobi's Algorithm with the original loop, which skips the
+ * diagonal with a branch inside the reduction and divides by the diagonal.
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param prev_variables [vector<float>] := solution computed at the previous iteration
+ * @param curr_variables [vector<float>] := vector where the new solution is stored
+ */
+void branch_sweep(const Matrix &matrix, const vector<float> &knownTerm, const vector<float> &prev_variables,
+                  vector<float> &curr_variables){
 
-    vector<vector<float>> matrix = generate_matrix(size, MIN_MATRIX, MAX_MATRIX, SEED);
+    int n = knownTerm.size();
+    for(int i = 0; i < n; i++){
+        float sum = 0;
+        for(int j = 0; j < n; j++){
+            if(i != j){
+                sum += matrix[i][j] * prev_variables[j];
+            }
+        }
+        curr_variables[i] = (knownTerm[i] - sum) / matrix[i][i];
+    }
+}
+
+
+/*!
+ * The following function computes one sweep of the Jacobi's Algorithm with the given variant of the row kernel.
+ * @param kernel [row_dot_function] := variant of the row kernel
+ * @param matrix [Matrix] := matrix A of the linear system (Ax=b)
+ * @param knownTerm [vector<float>] := vector b of the linear system (Ax=b)
+ * @param inverse_diagonal [vector<float>] := reciprocals of the elements on the diagonal
+ * @param prev_variables [vector<float>] := solution computed at the previous iteration
+ * @param curr_variables [vector<float>] := vector where the new solution is stored
+ */
+void kernel_sweep(row_dot_function kernel, const Matrix &matrix, const vector<float> &knownTerm,
+                  const vector<float> &inverse_diagonal, const vector<float> &prev_variables,
+                  vector<float> &curr_variables){
+
+    int n = knownTerm.size();
+    const float *x = prev_variables.data();
+    for(int i = 0; i < n; i++){
+        float sum = kernel(matrix[i], x, i) + kernel(matrix[i] + i + 1, x + i + 1, n - i - 1);
+        curr_variables[i] = (knownTerm[i] - sum) * inverse_diagonal[i];
+    }
+}
+
+
+int main(int argc, char *argv[]){
+
+    int size = argc > 1 ? atoi(argv[1]) : 5000;
+    int iterations = argc > 2 ? atoi(argv[2]) : 100;
+
+    Matrix matrix = generate_matrix(size, MIN_MATRIX, MAX_MATRIX, SEED);
     vector<float> knownTerm = generate_vector(size, MIN_VECTOR, MAX_VECTOR, SEED);
+    vector<float> inverse_diagonal(size);
+    for(int i = 0; i < size; i++){
+        inverse_diagonal[i] = 1.0f / matrix[i][i];
+    }
+    // the sweeps are applied always to the same vector, so that every variant computes the same values
+    vector<float> prev_variables = generate_vector(size, MIN_VECTOR, MAX_VECTOR, SEED + 1);
+    vector<float> reference(size);
+    vector<float> curr_variables(size);
     long time;
-    long double avg_time = 0;
+    double flops = 2.0 * size * size * iterations;
+
+    cout << "SIZE: " << size << " ITERATIONS: " << iterations << " SELECTED KERNEL: " << row_kernel_name() << endl;
 
-    for(int i = 0; i < TRIALS; i++){
-        vector<float> vector = sequential_jacobi(matrix, knownTerm, iterations, -1, time);
+    long double avg_time = 0;
+    for(int trial = 0; trial < TRIALS; trial++){
+        {
+            utimer t = utimer("branch", &time);
+            for(int k = 0; k < iterations; k++){
+                branch_sweep(matrix, knownTerm, prev_variables, reference);
+            }
+        }
         avg_time += time;
     }
     avg_time /= TRIALS;
-    cout << "SEQUENTIAL AVG_TIME: " << avg_time << endl;
+    cout << "branch\tAVG_TIME: " << avg_time << " usec\tGFLOP/s: " << flops / (avg_time * 1e3) << endl;
+
+    for(const string name : {"scalar", "auto", "avx2", "avx512"}){
+        row_dot_function kernel = row_kernel_by_name(name);
+        if(kernel == nullptr){
+            cout << name << "\tnot supported by this CPU" << endl;
+            continue;
+        }
+        avg_time = 0;
+        for(int trial = 0; trial < TRIALS; trial++){
+            {
+                utimer t = utimer(name, &time);
+                for(int k = 0; k < iterations; k++){
+                    kernel_sweep(kernel, matrix, knownTerm, inverse_diagonal, prev_variables, curr_variables);
+                }
+            }
+            avg_time += time;
+        }
+        avg_time /= TRIALS;
+        float max_error = 0;
+        for(int i = 0; i < size; i++){
+            max_error = max(max_error, fabs(curr_variables[i] - reference[i]) / fabs(reference[i]));
+        }
+        cout << name << "\tAVG_TIME: " << avg_time << " usec\tGFLOP/s: " << flops / (avg_time * 1e3) <<
+             "\tMAX RELATIVE DIFFERENCE FROM branch: " << max_error << endl;
+    }
 
     return 0;
-}
\ No newline at end of file
+}
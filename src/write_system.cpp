@@ -0,0 +1,61 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include "utility.h"
+#include "binary_format.h"
+#include "utimer.cpp"
+
+using namespace std;
+
+#define MIN_MATRIX 0
+#define MAX_MATRIX 20
+#define MIN_VECTOR 0
+#define MAX_VECTOR 20
+#define SEED 14
+
+
+/*!
+ * The following program writes a linear system in the binary format read by main.out (matrix=FILE vector=FILE). The
+ * system is generated as in main.out, or it is converted from the text files read by read_matrix and read_vector.
+ */
+int main(int argc, char *argv[]){
+
+    if(argc != 4 && argc != 6){
+        cerr << "Parameters: [SIZE] [MATRIX_FILE] [VECTOR_FILE] [TEXT_MATRIX_FILE] [TEXT_VECTOR_FILE]" << endl;
+        cerr << "Without the text files the system is generated with the seed used by main.out" << endl;
+        exit(-1);
+    }
+    int size = atoi(argv[1]);
+    if(size < 1){
+        cerr << "The size of the linear system must be >= 1!" << endl;
+        exit(-2);
+    }
+
+    long time;
+    try{
+        Matrix matrix;
+        vector<float> knownTerm;
+        {
+            utimer t = utimer(argc == 6 ? "Text read" : "Generation", &time);
+            matrix = argc == 6 ? read_matrix(size, argv[4]) : generate_matrix(size, MIN_MATRIX, MAX_MATRIX, SEED);
+            knownTerm = argc == 6 ? read_vector(size, argv[5]) : generate_vector(size, MIN_VECTOR, MAX_VECTOR, SEED);
+        }
+        {
+            utimer t = utimer("Binary write", &time);
+            write_binary_matrix(matrix, argv[2]);
+            write_binary_vector(knownTerm, argv[3]);
+        }
+        {
+            utimer t = utimer("Binary map", &time);
+            Matrix mapped = map_binary_matrix(argv[2]);
+            vector<float> loaded = read_binary_vector(argv[3]);
+        }
+    }
+    catch(const runtime_error &e){
+        cerr << e.what() << endl;
+        exit(-3);
+    }
+
+    return 0;
+}